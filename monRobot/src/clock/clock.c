@@ -0,0 +1,146 @@
+/**
+ * @file clock.c
+ *
+ * @see clock.h
+ *
+ * The offset of an exchange assumes equal delays both ways, the error is
+ * at most half the round trip. The exchange with the shortest round trip
+ * of the window is the least disturbed by queues, it gives the offset
+ * the one-way latencies are computed with.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "clock.h"
+
+/**
+ * @brief Minimum time between two measures of the drift (µs)
+ */
+#define DRIFT_PERIOD (20000000)
+
+static bool_e virtualTime = FALSE;
+static int64_t virtualNow = 0; // µs, shared by the threads
+
+extern uint32_t Clock_now()
+{
+    struct timespec time;
+
+    if (virtualTime == TRUE)
+    {
+        return (uint32_t)__atomic_load_n(&virtualNow, __ATOMIC_ACQUIRE);
+    }
+    clock_gettime(CLOCK_REALTIME, &time);
+    return (uint32_t)((uint64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000);
+}
+
+extern void Clock_useVirtual()
+{
+    virtualTime = TRUE;
+}
+
+extern bool_e Clock_isVirtual()
+{
+    return virtualTime;
+}
+
+extern void Clock_advance(int64_t time)
+{
+    if (time > __atomic_load_n(&virtualNow, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&virtualNow, time, __ATOMIC_RELEASE);
+    }
+}
+
+extern int64_t Clock_monotonic()
+{
+    struct timespec time;
+
+    if (virtualTime == TRUE)
+    {
+        return __atomic_load_n(&virtualNow, __ATOMIC_ACQUIRE);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (int64_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+extern long Clock_milliseconds()
+{
+    return (long)(Clock_monotonic() / 1000);
+}
+
+extern void Clock_sleep(int duration)
+{
+    if (virtualTime == TRUE)
+    {
+        Clock_advance(Clock_monotonic() + (int64_t)duration * 1000);
+    }
+    else
+    {
+        usleep((useconds_t)duration * 1000);
+    }
+}
+
+extern void Clock_reset(ClockEstimate_s *estimate)
+{
+    memset(estimate, 0, sizeof(*estimate));
+}
+
+extern void Clock_sample(ClockEstimate_s *estimate, uint32_t origin, uint32_t receive, uint32_t transmit, uint32_t arrival)
+{
+    ClockSample_s sample;
+    const int window = (estimate->count < CLOCK_FILTER) ? estimate->count + 1 : CLOCK_FILTER;
+
+    // Differences of wrapping timestamps, each one small
+    sample.delay = (int32_t)(arrival - origin) - (int32_t)(transmit - receive);
+    sample.offset = (int32_t)(((int64_t)(int32_t)(receive - origin) + (int32_t)(transmit - arrival)) / 2);
+    sample.time = origin;
+    if (sample.delay < 0)
+    {
+        sample.delay = 0; // Resolution of the clocks
+    }
+    estimate->a_samples[estimate->count % CLOCK_FILTER] = sample;
+    estimate->count++;
+
+    estimate->best = estimate->a_samples[0];
+    for (int i = 1; i < window; i++)
+    {
+        if (estimate->a_samples[i].delay < estimate->best.delay)
+        {
+            estimate->best = estimate->a_samples[i];
+        }
+    }
+
+    if (estimate->count == 1)
+    {
+        estimate->reference = estimate->best;
+    }
+    else if ((int32_t)(estimate->best.time - estimate->reference.time) >= DRIFT_PERIOD)
+    {
+        estimate->drift = (double)(estimate->best.offset - estimate->reference.offset) * 1e6 / (int32_t)(estimate->best.time - estimate->reference.time);
+        estimate->reference = estimate->best;
+    }
+
+    Clock_noteUplink(estimate, origin, receive);
+    Clock_noteDownlink(estimate, transmit, arrival);
+}
+
+extern int32_t Clock_noteUplink(ClockEstimate_s *estimate, uint32_t sent, uint32_t received)
+{
+    estimate->uplink = (int32_t)(received - sent) - Clock_getOffset(estimate, sent);
+    return estimate->uplink;
+}
+
+extern int32_t Clock_noteDownlink(ClockEstimate_s *estimate, uint32_t sent, uint32_t received)
+{
+    estimate->downlink = (int32_t)(received - sent) + Clock_getOffset(estimate, received);
+    return estimate->downlink;
+}
+
+extern int32_t Clock_getOffset(const ClockEstimate_s *estimate, uint32_t time)
+{
+    return estimate->best.offset + (int32_t)(estimate->drift * (int32_t)(time - estimate->best.time) / 1e6);
+}
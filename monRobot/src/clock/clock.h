@@ -0,0 +1,172 @@
+/**
+ * @file  clock.h
+ *
+ * @brief  Time source of the programs and estimation of the offset and drift between the clocks of telco and commando
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _CLOCK_
+#define _CLOCK_
+
+#include <stdint.h>
+
+#include "../common.h"
+
+/**
+ * @brief Number of exchanges kept, the one with the shortest round trip gives the offset
+ */
+#define CLOCK_FILTER (8)
+
+/**
+ * @brief An exchange of timestamps
+ */
+typedef struct
+{
+    int32_t offset; // µs
+    int32_t delay;  // µs
+    uint32_t time;  // Departure, clock of the initiator
+} ClockSample_s;
+
+/**
+ * @brief What a side knows of the clock of the other one
+ *
+ * The timestamps are microseconds of CLOCK_REALTIME modulo 2^32, their
+ * differences stay right as long as the clocks are less than half an hour apart.
+ * The offset is always the clock of commando minus the clock of telco.
+ */
+typedef struct
+{
+    ClockSample_s a_samples[CLOCK_FILTER];
+    int count; // Exchanges received, the window holds the last ones
+    ClockSample_s best;
+    ClockSample_s reference; // Start of the drift measure
+    double drift;    // ppm, positive if the clock of commando runs faster
+    int32_t uplink;   // µs, last one-way latency from telco to commando
+    int32_t downlink; // µs, last one-way latency from commando to telco
+} ClockEstimate_s;
+
+/**
+ * @brief Gives the timestamp of the present time
+ *
+ * @return uint32_t µs of CLOCK_REALTIME, modulo 2^32, or of the virtual time
+ */
+extern uint32_t Clock_now();
+
+/**
+ * @brief Replaces the time of the system by a virtual time, which only moves with Clock_advance()
+ *
+ * For the simulations: every wait and every measure of the program follows it.
+ */
+extern void Clock_useVirtual();
+
+/**
+ * @brief Tells whether the time is virtual
+ *
+ * @return bool_e TRUE after Clock_useVirtual()
+ */
+extern bool_e Clock_isVirtual();
+
+/**
+ * @brief Moves the virtual time forward
+ *
+ * @param time New virtual time (µs since the start), ignored if it is in the past
+ */
+extern void Clock_advance(int64_t time);
+
+/**
+ * @brief Gives a monotonic time
+ *
+ * @return int64_t µs of CLOCK_MONOTONIC, or of the virtual time
+ */
+extern int64_t Clock_monotonic();
+
+/**
+ * @brief Gives a monotonic time, for the periods and the timeouts
+ *
+ * @return long ms of Clock_monotonic()
+ */
+extern long Clock_milliseconds();
+
+/**
+ * @brief Waits for a duration, at once with a virtual time which moves forward by as much
+ *
+ * @param duration The duration (ms)
+ */
+extern void Clock_sleep(int duration);
+
+/**
+ * @brief Forgets the exchanges
+ *
+ * @param estimate The estimate
+ */
+extern void Clock_reset(ClockEstimate_s *estimate);
+
+/**
+ * @brief Takes an exchange into account
+ *
+ * @param estimate The estimate
+ * @param origin Departure of the ping (telco)
+ * @param receive Arrival of the ping (commando)
+ * @param transmit Departure of the answer (commando)
+ * @param arrival Arrival of the answer (telco)
+ */
+extern void Clock_sample(ClockEstimate_s *estimate, uint32_t origin, uint32_t receive, uint32_t transmit, uint32_t arrival);
+
+/**
+ * @brief Measures the latency of a frame from telco to commando
+ *
+ * @param estimate The estimate
+ * @param sent Departure (telco)
+ * @param received Arrival (commando)
+ * @return int32_t The latency (µs), also kept as uplink
+ */
+extern int32_t Clock_noteUplink(ClockEstimate_s *estimate, uint32_t sent, uint32_t received);
+
+/**
+ * @brief Measures the latency of a frame from commando to telco
+ *
+ * @param estimate The estimate
+ * @param sent Departure (commando)
+ * @param received Arrival (telco)
+ * @return int32_t The latency (µs), also kept as downlink
+ */
+extern int32_t Clock_noteDownlink(ClockEstimate_s *estimate, uint32_t sent, uint32_t received);
+
+/**
+ * @brief Gives the offset at a time, corrected by the drift
+ *
+ * @param estimate The estimate
+ * @param time Time of telco
+ * @return int32_t Clock of commando minus clock of telco (µs)
+ */
+extern int32_t Clock_getOffset(const ClockEstimate_s *estimate, uint32_t time);
+
+#endif // _CLOCK_
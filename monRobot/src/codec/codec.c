@@ -0,0 +1,273 @@
+/**
+ * @file codec.c
+ *
+ * @see codec.h
+ *
+ * A frame is made of 32-bit fields only, so frames and payloads are both
+ * converted as arrays of words. On x86 the words are swapped with byte
+ * shuffles, 8 per instruction with AVX2 or 4 with SSSE3. The build does
+ * not enable these instruction sets, the shuffles are compiled for them
+ * alone and chosen at run time from the features of the processor.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <arpa/inet.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CODEC_SIMD
+#endif
+
+#include "codec.h"
+
+/**
+ * @brief Words swapped by each measure of Codec_benchmark(), whatever the size of the calls
+ */
+#define BENCH_WORDS (1 << 24)
+
+/**
+ * @brief Measures of each case, the fastest one is kept
+ */
+#define BENCH_ROUNDS (3)
+
+/**
+ * @brief A way to swap the words
+ *
+ * @param words Where to write the words, may be source
+ * @param source The words
+ * @param count Number of words
+ * @return int Number of words swapped, the rest is left to the caller
+ */
+typedef int (*Swapper_f)(uint32_t *words, const uint32_t *source, int count);
+
+/**
+ * @brief Reverses the bytes of each word, the conversion goes both ways
+ *
+ * @param words Where to write the words, may be source
+ * @param source The words
+ * @param count Number of words
+ */
+static void swap(uint32_t *words, const uint32_t *source, int count);
+
+/**
+ * @brief Swaps the words one by one
+ *
+ * @param words Where to write the words, may be source
+ * @param source The words
+ * @param from First word to swap
+ * @param count Number of words
+ */
+static void swapScalar(uint32_t *words, const uint32_t *source, int from, int count);
+
+/**
+ * @brief Leaves every word to swapScalar(), the reference of the measures
+ *
+ * @return int 0
+ */
+static int swapNone(uint32_t *words, const uint32_t *source, int count);
+
+/**
+ * @brief Measures a way to swap calls of a size
+ *
+ * @param swapper The way, NULL for swap() and its dispatch
+ * @param count Number of words of each call
+ * @return double ns per call, the best of BENCH_ROUNDS
+ */
+static double measure(Swapper_f swapper, int count);
+
+#ifdef CODEC_SIMD
+/**
+ * @brief Swaps the words 8 by 8 with AVX2
+ *
+ * @param words Where to write the words, may be source
+ * @param source The words
+ * @param count Number of words
+ * @return int Number of words swapped, the rest is left to the caller
+ */
+__attribute__((target("avx2"))) static int swapAvx2(uint32_t *words, const uint32_t *source, int count);
+
+/**
+ * @brief Swaps the words 4 by 4 with SSSE3
+ *
+ * @param words Where to write the words, may be source
+ * @param source The words
+ * @param count Number of words
+ * @return int Number of words swapped, the rest is left to the caller
+ */
+__attribute__((target("ssse3"))) static int swapSsse3(uint32_t *words, const uint32_t *source, int count);
+
+/**
+ * @brief Order of the bytes of each lane after the shuffle, loaded at once instead of built at every call
+ */
+static const uint8_t a_shuffle[32] = {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                      3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12};
+#endif
+
+extern void Codec_encodeFrames(Data_s *frames, const Data_s *source, int count)
+{
+    swap((uint32_t *)frames, (const uint32_t *)source, count * (int)(sizeof(Data_s) / sizeof(uint32_t)));
+}
+
+extern void Codec_decodeFrames(Data_s *frames, const Data_s *source, int count)
+{
+    swap((uint32_t *)frames, (const uint32_t *)source, count * (int)(sizeof(Data_s) / sizeof(uint32_t)));
+}
+
+extern void Codec_encodeWords(int32_t *words, const int32_t *source, int count)
+{
+    swap((uint32_t *)words, (const uint32_t *)source, count);
+}
+
+extern void Codec_decodeWords(int32_t *words, const int32_t *source, int count)
+{
+    swap((uint32_t *)words, (const uint32_t *)source, count);
+}
+
+extern void Codec_benchmark()
+{
+    const int a_counts[] = {8, 16, 64, 256, MAX_PAYLOAD / (int)sizeof(uint32_t)};
+
+    printf("Conversion des mots (ns par appel, le meilleur de %d mesures) :\n", BENCH_ROUNDS);
+    printf("%6s %10s %10s %10s %10s\n", "mots", "scalaire", "SSSE3", "AVX2", "choisi");
+    for (size_t i = 0; i < sizeof(a_counts) / sizeof(a_counts[0]); i++)
+    {
+        const int count = a_counts[i];
+
+        printf("%6d %10.1f", count, measure(&swapNone, count));
+#ifdef CODEC_SIMD
+        if (__builtin_cpu_supports("ssse3"))
+        {
+            printf(" %10.1f", measure(&swapSsse3, count));
+        }
+        else
+        {
+            printf(" %10s", "-");
+        }
+        if (__builtin_cpu_supports("avx2"))
+        {
+            printf(" %10.1f", measure(&swapAvx2, count));
+        }
+        else
+        {
+            printf(" %10s", "-");
+        }
+#else
+        printf(" %10s %10s", "-", "-");
+#endif
+        printf(" %10.1f\n", measure(NULL, count));
+    }
+}
+
+static void swap(uint32_t *words, const uint32_t *source, int count)
+{
+    int i = 0;
+
+    if (htonl(1) == 1)
+    {
+        if (words != source)
+        {
+            memmove(words, source, count * sizeof(uint32_t)); // Already in network byte order
+        }
+        return;
+    }
+
+#ifdef CODEC_SIMD
+    // Below a register the dispatch costs more than it saves
+    if (count >= 8 && __builtin_cpu_supports("avx2"))
+    {
+        i = swapAvx2(words, source, count);
+    }
+    else if (count >= 4 && __builtin_cpu_supports("ssse3"))
+    {
+        i = swapSsse3(words, source, count);
+    }
+#endif
+    swapScalar(words, source, i, count);
+}
+
+static void swapScalar(uint32_t *words, const uint32_t *source, int from, int count)
+{
+    for (int i = from; i < count; i++)
+    {
+        words[i] = __builtin_bswap32(source[i]);
+    }
+}
+
+static int swapNone(uint32_t *words, const uint32_t *source, int count)
+{
+    return 0;
+}
+
+static double measure(Swapper_f swapper, int count)
+{
+    static uint32_t a_source[MAX_PAYLOAD / sizeof(uint32_t)];
+    static uint32_t a_words[MAX_PAYLOAD / sizeof(uint32_t)];
+    const int calls = BENCH_WORDS / count;
+    double best = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        a_source[i] = (uint32_t)i * 0x01020304u;
+    }
+    for (int round = 0; round < BENCH_ROUNDS; round++)
+    {
+        struct timespec start;
+        struct timespec end;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int call = 0; call < calls; call++)
+        {
+            // Into another buffer, as the telemetry does: the source stays the same at every call
+            if (swapper == NULL)
+            {
+                swap(a_words, a_source, count);
+            }
+            else
+            {
+                swapScalar(a_words, a_source, swapper(a_words, a_source, count), count);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        const double duration = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / calls;
+        if (round == 0 || duration < best)
+        {
+            best = duration;
+        }
+    }
+    return best;
+}
+
+#ifdef CODEC_SIMD
+__attribute__((target("avx2"))) static int swapAvx2(uint32_t *words, const uint32_t *source, int count)
+{
+    const __m256i mask = _mm256_loadu_si256((const __m256i *)a_shuffle);
+    int i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i value = _mm256_loadu_si256((const __m256i *)(source + i));
+
+        _mm256_storeu_si256((__m256i *)(words + i), _mm256_shuffle_epi8(value, mask));
+    }
+    return i;
+}
+
+__attribute__((target("ssse3"))) static int swapSsse3(uint32_t *words, const uint32_t *source, int count)
+{
+    const __m128i mask = _mm_loadu_si128((const __m128i *)a_shuffle);
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i value = _mm_loadu_si128((const __m128i *)(source + i));
+
+        _mm_storeu_si128((__m128i *)(words + i), _mm_shuffle_epi8(value, mask));
+    }
+    return i;
+}
+#endif
@@ -0,0 +1,86 @@
+/**
+ * @file  codec.h
+ *
+ * @brief  Conversion of the frames and payloads between host and network byte order
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _CODEC_
+#define _CODEC_
+
+#include <stdint.h>
+
+#include "../common.h"
+
+/**
+ * @brief Converts frames to network byte order
+ *
+ * @param frames Where to write the converted frames, may be source
+ * @param source Frames in host byte order
+ * @param count Number of frames
+ */
+extern void Codec_encodeFrames(Data_s *frames, const Data_s *source, int count);
+
+/**
+ * @brief Converts frames to host byte order
+ *
+ * @param frames Where to write the converted frames, may be source
+ * @param source Frames in network byte order
+ * @param count Number of frames
+ */
+extern void Codec_decodeFrames(Data_s *frames, const Data_s *source, int count);
+
+/**
+ * @brief Converts 32-bit words of payload to network byte order
+ *
+ * @param words Where to write the converted words, may be source
+ * @param source Words in host byte order
+ * @param count Number of words
+ */
+extern void Codec_encodeWords(int32_t *words, const int32_t *source, int count);
+
+/**
+ * @brief Converts 32-bit words of payload to host byte order
+ *
+ * @param words Where to write the converted words, may be source
+ * @param source Words in network byte order
+ * @param count Number of words
+ */
+extern void Codec_decodeWords(int32_t *words, const int32_t *source, int count);
+
+/**
+ * @brief Measures the conversion of words with each instruction set, then with the one chosen at run time, and prints the times
+ *
+ * From a frame (8 words) to the largest payload, the sizes of the calls of the programs.
+ */
+extern void Codec_benchmark();
+
+#endif // _CODEC_
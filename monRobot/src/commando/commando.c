@@ -1,15 +1,133 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <unistd.h>
 
 #include "../common.h"
 #include "server/server.h"
+#include "control/control.h"
+#include "simulation/simulation.h"
+#include "robot/robot.h"
+#include "profile/profile.h"
+#include "../link/link.h"
+#include "../codec/codec.h"
+
+/**
+ * @brief Displays the options of commando
+ *
+ * @param program Name of the program
+ */
+static void usage(const char *program);
 
 int main(int argc, char *argv[])
 {
+    int option;
+    int acceleration = 0;
+    int jerk = 0;
+    const char *p_simulation = NULL;
+    bool_e paced = FALSE;
+    FilterConfig_s filter;
+    char a_host[64];
+    int port;
+
+    while ((option = getopt(argc, argv, "j:a:k:urs:tl:i:x:PCh")) != -1)
+    {
+        switch (option)
+        {
+        case 'j':
+            Server_setShardCount(atoi(optarg));
+            break;
+        case 'a':
+            acceleration = atoi(optarg);
+            break;
+        case 'k':
+            jerk = atoi(optarg);
+            break;
+        case 'u':
+            if (Server_useRing() == FALSE)
+            {
+                printf("%sCommando est compilé sans io_uring%s\n", "\033[41m", "\033[0m");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'r':
+            Server_resume();
+            break;
+        case 's':
+            p_simulation = optarg;
+            break;
+        case 't':
+            paced = TRUE;
+            break;
+        case 'l':
+            if (Filter_parse(optarg, &filter) == FALSE)
+            {
+                printf("%sFiltres des capteurs incompris : %s%s\n", "\033[41m", optarg, "\033[0m");
+                return EXIT_FAILURE;
+            }
+            Robot_setFilter(&filter);
+            break;
+        case 'i':
+            port = 12345;
+            Link_parseAddress(optarg, a_host, sizeof(a_host), &port);
+            Robot_setSimulator(a_host, port);
+            break;
+        case 'x':
+            port = LINK_PORT;
+            Link_parseAddress(optarg, a_host, sizeof(a_host), &port);
+            Robot_useRelay(a_host, port);
+            break;
+        case 'P':
+            if (Profile_start() == FALSE)
+            {
+                printf("%sCompteurs du processeur refusés par le système (perf_event_paranoid)%s\n", "\033[41m", "\033[0m");
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'C':
+            Codec_benchmark();
+            return EXIT_SUCCESS;
+        default:
+            usage(argv[0]);
+            return (option == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    Control_setLimits(acceleration, jerk);
+    if (p_simulation != NULL)
+    {
+        Simulation_new(p_simulation);
+        Simulation_setPaced(paced);
+        Simulation_start();
+        Simulation_stop();
+        Profile_print();
+        Profile_stop();
+        return EXIT_SUCCESS;
+    }
+
     printf("\033c");
     Server_new();
     Server_start();
     Server_stop();
+    Profile_stop();
     return EXIT_SUCCESS;
 }
+
+static void usage(const char *program)
+{
+    printf("Usage : %s [options]\n", program);
+    printf("  -j <n> : nombre de boucles d'événements (0 : une par cœur, 1 par défaut)\n");
+    printf("  -a <n> : accélération maximale des roues en %%/s (0 : sans limite, par défaut)\n");
+    printf("  -k <n> : variation maximale de l'accélération en %%/s² (0 : sans limite, par défaut)\n");
+    printf("  -u     : réseau par io_uring au lieu de select()\n");
+    printf("  -r     : relève le commando en cours sans couper le robot ni les clients\n");
+    printf("  -s <f> : simule le script f (commandes de telco) sans Intox ni réseau, plus vite que le temps réel\n");
+    printf("  -t     : avec -s, attend le temps réel entre les événements\n");
+    printf("  -l <f> : filtre les capteurs, par ex. median=5,mean=4,ema=0.3,debounce=3 (aucun filtre par défaut)\n");
+    printf("  -i <hôte[:port]> : adresse d'Intox (127.0.0.1:12345 par défaut)\n");
+    printf("  -x <hôte[:port]> : passe par le relais au lieu d'Intox (port %d par défaut)\n", LINK_PORT);
+    printf("  -P     : compte cycles, instructions, défauts de cache et mauvaises prédictions des sections chaudes,\n");
+    printf("           affichés sur SIGUSR1 et à l'arrêt, ou demandés par telco (profile)\n");
+    printf("  -C     : mesure la conversion des trames avec AVX2, SSSE3 et sans, puis quitte\n");
+    printf("  -h     : affiche cette aide\n");
+}
@@ -0,0 +1,522 @@
+/**
+ * @file control.c
+ *
+ * @see control.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "../../common.h"
+#include "../pilot/pilot.h"
+#include "../robot/robot.h"
+#include "../queue/queue.h"
+#include "../telemetry/telemetry.h"
+#include "../mission/mission.h"
+#include "../odometry/odometry.h"
+#include "../odometry/grid.h"
+#include "../planner/navigation.h"
+#include "../history/history.h"
+#include "../profile/profile.h"
+#include "../../clock/clock.h"
+#include "control.h"
+
+/**
+ * @brief Maximum number of orders waiting for the control thread
+ */
+#define COMMAND_QUEUE_SIZE (64)
+
+/**
+ * @brief Period of the control loop (ms)
+ */
+#define CONTROL_PERIOD (20)
+
+/**
+ * @brief Period of the states broadcast to the observers (ms)
+ */
+#define TELEMETRY_PERIOD (100)
+
+/**
+ * @brief Internal order ending the control thread
+ */
+#define ORDER_QUIT (O_NB_ORDER)
+
+/**
+ * @brief Internal order handing the robot over to another commando
+ */
+#define ORDER_SUSPEND (O_NB_ORDER + 1)
+
+/**
+ * @brief Default speed of the robot
+ */
+#define POWER (100)
+
+/**
+ * @brief Body of the control thread
+ *
+ * @param arg Not used
+ * @return void* Not used
+ */
+static void *run(void *arg);
+
+/**
+ * @brief Takes the robot, or the pilot handed over, and sets the clock of the loop
+ */
+static void begin();
+
+/**
+ * @brief Applies an order to the pilot
+ *
+ * @param command The order
+ */
+static void apply(Command_s command);
+
+/**
+ * @brief Convert the direction chosen by the user into a velocity vector
+ *
+ * @param direction The direction in which the robot should go
+ * @return VelocityVector_s corresponds to the direction and speed where to go
+ */
+static VelocityVector_s translate(const Direction_e direction);
+
+/**
+ * @brief Work of the control loop at each period
+ *
+ * @param time Current time (ms)
+ */
+static void tick(long time);
+
+/**
+ * @brief Saves the state of the pilot and releases the robot, unless a mission or a goal is in progress
+ */
+static void suspend();
+
+/**
+ * @brief Gives up the mission and the goal in progress, the operator takes over
+ */
+static void takeOver();
+
+/**
+ * @brief Answers a request of the map
+ *
+ * @param command The request, its payload is a MapRegion_s
+ */
+static void replyMap(Command_s command);
+
+/**
+ * @brief Answers a request of the history
+ *
+ * @param command The request, its payload is a HistoryQuery_s
+ */
+static void replyHistory(Command_s command);
+
+/**
+ * @brief Broadcasts the state of the pilot if there are observers and the period has elapsed
+ *
+ * @param time Current time (ms)
+ */
+static void publish(long time);
+
+static Queue_s *p_commands = NULL;
+static pthread_t thread;
+static bool_e work;
+static VelocityVector_s vectorDefault = {D_STOP, 0};
+static long lastPublish = 0;
+static long lastTick = 0;
+static long nextTick = 0;
+static long startTime = 0; // Origin of the times of the history
+static int acceleration = 0; // Limits of the pilot, 0: none
+static int jerk = 0;
+static bool_e resuming = FALSE; // Started from the snapshot of another commando
+static ControlSnapshot_s snapshot;
+static int suspendAnswer = 0; // 0: waiting, 1: ended, -1: goes on
+static bool_e suspended = FALSE;
+static bool_e stepped = FALSE; // Driven by Control_step(), without thread
+
+extern void Control_new()
+{
+    p_commands = Queue_new(COMMAND_QUEUE_SIZE, sizeof(Command_s));
+    if (p_commands == NULL)
+    {
+        perror("Erreur lors de la création de la file des ordres");
+        exit(EXIT_FAILURE);
+    }
+    Pilot_new();
+    Odometry_new();
+    History_clear();
+}
+
+extern void Control_setLimits(int maxAcceleration, int maxJerk)
+{
+    acceleration = maxAcceleration;
+    jerk = maxJerk;
+}
+
+extern void Control_start()
+{
+    work = TRUE;
+    if (pthread_create(&thread, NULL, &run, NULL) != 0)
+    {
+        printf("%sErreur lors du lancement du pilote%s\n", "\033[41m", "\033[0m");
+        exit(EXIT_FAILURE);
+    }
+}
+
+extern void Control_startStepped()
+{
+    work = TRUE;
+    stepped = TRUE;
+    begin();
+}
+
+extern void Control_resume(const ControlSnapshot_s *handedOver)
+{
+    snapshot = *handedOver;
+    resuming = TRUE;
+    suspended = FALSE; // Also after a handoff that failed
+    Control_start();
+}
+
+extern bool_e Control_suspend(ControlSnapshot_s *handedOver)
+{
+    const Command_s order = {ORDER_SUSPEND, D_STOP, -1, NULL, 0};
+    int answer;
+
+    __atomic_store_n(&suspendAnswer, 0, __ATOMIC_RELAXED);
+    while (Control_post(order) == FALSE)
+    {
+        sched_yield(); // The queue is full, the thread will empty it
+    }
+    while ((answer = __atomic_load_n(&suspendAnswer, __ATOMIC_ACQUIRE)) == 0)
+    {
+        sched_yield(); // At most a control period
+    }
+    if (answer < 0)
+    {
+        return FALSE;
+    }
+    pthread_join(thread, NULL);
+    suspended = TRUE;
+    *handedOver = snapshot;
+    return TRUE;
+}
+
+extern void Control_stop()
+{
+    const Command_s quit = {ORDER_QUIT, D_STOP, -1, NULL, 0};
+
+    if (stepped == TRUE)
+    {
+        Control_post(quit);
+        Control_step();
+    }
+    else if (suspended == FALSE)
+    {
+        while (Control_post(quit) == FALSE)
+        {
+            sched_yield(); // The queue is full, the thread will empty it
+        }
+        pthread_join(thread, NULL);
+    }
+    Queue_free(p_commands);
+    p_commands = NULL;
+}
+
+extern bool_e Control_post(Command_s command)
+{
+    return Queue_push(p_commands, &command);
+}
+
+extern long Control_step()
+{
+    Command_s command;
+
+    while (work == TRUE && Queue_pop(p_commands, &command))
+    {
+        apply(command);
+    }
+
+    const long time = Clock_milliseconds();
+    if (work == TRUE && time >= nextTick)
+    {
+        tick(time);
+        nextTick += CONTROL_PERIOD;
+        if (nextTick <= time)
+        {
+            nextTick = time + CONTROL_PERIOD; // Late, the missed ticks are not replayed
+        }
+    }
+    return nextTick;
+}
+
+static void *run(void *arg)
+{
+    Command_s command;
+
+    begin();
+    while (work == TRUE)
+    {
+        const long wait = nextTick - Clock_milliseconds();
+
+        if (Queue_waitPop(p_commands, &command, (wait > 0) ? (int)wait : 0))
+        {
+            apply(command);
+        }
+        Control_step();
+    }
+
+    return NULL;
+}
+
+static void begin()
+{
+    // The robot belongs to the calling thread from now on
+    if (resuming == FALSE)
+    {
+        Pilot_start();
+    }
+    else
+    {
+        Pilot_resume(&snapshot.pilot);
+        Odometry_setPose(snapshot.pose);
+    }
+    Pilot_setLimits(acceleration, jerk);
+    Pilot_setBumpHandler(&Navigation_onBump);
+    lastTick = Clock_milliseconds();
+    startTime = lastTick;
+    nextTick = lastTick + CONTROL_PERIOD;
+}
+
+static void apply(Command_s command)
+{
+    if (command.order == ORDER_QUIT)
+    {
+        // The robot is left stopped when the server ends, whoever asked it
+        Pilot_stop(vectorDefault);
+        Pilot_free();
+        work = FALSE;
+    }
+    else if (command.order == ORDER_SUSPEND)
+    {
+        suspend();
+    }
+    else if (command.order == ORDER_SKIP)
+    {
+        TRACE("Order %u shed by the server\n", command.sequence);
+    }
+    else if (command.order == O_ASK_LOG)
+    {
+        if (Telemetry_reply(command.socket, command.generation, command.sequence, Pilot_getState()) == FALSE)
+        {
+            TRACE("Telemetry queue full, state dropped\n");
+        }
+    }
+    else if (command.order == O_CHANGE_MVT)
+    {
+        takeOver();
+        Pilot_setVelocity(translate(command.direction));
+    }
+    else if (command.order == O_MISSION)
+    {
+        Navigation_abort(M_ABORTED);
+        Mission_load(command.socket, command.generation, (const MissionStep_s *)command.p_payload, command.size / (int)sizeof(MissionStep_s), Clock_milliseconds());
+    }
+    else if (command.order == O_ABORT)
+    {
+        takeOver();
+    }
+    else if (command.order == O_BEHAVIOUR)
+    {
+        const BehaviourOrder_s *p_behaviour = (const BehaviourOrder_s *)command.p_payload;
+
+        if (command.size != sizeof(BehaviourOrder_s))
+        {
+            TRACE("Invalid behaviour order of %d bytes ignored\n", command.size);
+        }
+        else
+        {
+            takeOver();
+            Pilot_setBehaviour(p_behaviour->behaviour, p_behaviour->power);
+        }
+    }
+    else if (command.order == O_POSE)
+    {
+        const Pose_s pose = Odometry_getPose();
+        const PoseReport_s report = {(int)pose.x, (int)pose.y, (int)(pose.heading * 1000)};
+
+        if (Telemetry_replyPayload(command.socket, command.generation, command.sequence, O_POSE, &report, sizeof(report)) == FALSE)
+        {
+            TRACE("Telemetry queue full, pose dropped\n");
+        }
+    }
+    else if (command.order == O_PROFILE)
+    {
+        ProfileReport_s a_reports[PR_NB_REGION];
+        const int count = Profile_report(a_reports);
+
+        if (Telemetry_replyPayload(command.socket, command.generation, command.sequence, O_PROFILE, a_reports, count * sizeof(ProfileReport_s)) == FALSE)
+        {
+            TRACE("Telemetry queue full, profile dropped\n");
+        }
+    }
+    else if (command.order == O_MAP)
+    {
+        replyMap(command);
+    }
+    else if (command.order == O_HISTORY)
+    {
+        replyHistory(command);
+    }
+    else if (command.order == O_GOTO)
+    {
+        if (command.size != sizeof(GoalOrder_s))
+        {
+            TRACE("Invalid goal of %d bytes ignored\n", command.size);
+        }
+        else
+        {
+            Mission_abort(M_ABORTED);
+            Navigation_go(command.socket, command.generation, *(const GoalOrder_s *)command.p_payload);
+        }
+    }
+    else if (command.order == O_SETPOINT)
+    {
+        const Setpoint_s *p_setpoint = (const Setpoint_s *)command.p_payload;
+
+        if (command.size != sizeof(Setpoint_s))
+        {
+            TRACE("Invalid setpoint of %d bytes ignored\n", command.size);
+        }
+        else
+        {
+            takeOver();
+            if (p_setpoint->kind == SP_WHEELS)
+            {
+                Pilot_setWheels(p_setpoint->first, p_setpoint->second);
+            }
+            else
+            {
+                Pilot_setTwist(p_setpoint->first, p_setpoint->second);
+            }
+        }
+    }
+    else if (command.order == O_STOP)
+    {
+        // The robot stays with the server, the session of the sender ends
+        takeOver();
+        Pilot_stop(vectorDefault);
+    }
+    else
+    {
+        TRACE("Order %d ignored\n", command.order);
+    }
+    free(command.p_payload);
+    if (command.sequence != 0 && Telemetry_acknowledge(command.socket, command.generation, command.sequence) == FALSE)
+    {
+        TRACE("Telemetry queue full, acknowledgement delayed\n");
+    }
+}
+
+static VelocityVector_s translate(const Direction_e direction)
+{
+    VelocityVector_s velocityVector = {direction, POWER};
+    return velocityVector;
+}
+
+static void tick(long time)
+{
+    Robot_reap();
+    Mission_tick(time);
+    Pilot_tick(time - lastTick); // The ramps follow the real time, even late
+    Odometry_update(time - lastTick);
+    Navigation_tick(time);
+    History_record(time - startTime, Pilot_getState());
+    lastTick = time;
+    publish(time);
+}
+
+static void suspend()
+{
+    if (Mission_isRunning() == TRUE || Navigation_isActive() == TRUE)
+    {
+        __atomic_store_n(&suspendAnswer, -1, __ATOMIC_RELEASE);
+        return;
+    }
+    snapshot.pilot = Pilot_save();
+    snapshot.pose = Odometry_getPose();
+    Pilot_free(); // Without stopping it
+    work = FALSE;
+    __atomic_store_n(&suspendAnswer, 1, __ATOMIC_RELEASE);
+}
+
+static void takeOver()
+{
+    Mission_abort(M_ABORTED);
+    Navigation_abort(M_ABORTED);
+}
+
+static void replyMap(Command_s command)
+{
+    static int32_t a_answer[MAX_PAYLOAD / sizeof(int32_t)];
+    const int maxCells = (MAX_PAYLOAD - sizeof(MapRegion_s)) * 4; // 2 bits per cell
+    MapRegion_s region;
+
+    if (command.size != sizeof(MapRegion_s))
+    {
+        TRACE("Invalid map request of %d bytes ignored\n", command.size);
+        return;
+    }
+    region = *(const MapRegion_s *)command.p_payload;
+    // Row and column in the map as well, their sum with the size would overflow near INT_MAX
+    region.row = (region.row < 0) ? 0 : (region.row >= MAP_SIZE) ? MAP_SIZE - 1 : region.row;
+    region.column = (region.column < 0) ? 0 : (region.column >= MAP_SIZE) ? MAP_SIZE - 1 : region.column;
+    region.width = (region.width < 0) ? 0 : (region.width > MAP_SIZE) ? MAP_SIZE : region.width;
+    region.height = (region.height < 0) ? 0 : (region.height > MAP_SIZE) ? MAP_SIZE : region.height;
+    if (region.width * region.height > maxCells)
+    {
+        region.height = maxCells / region.width; // Cut to fit in one answer
+    }
+
+    memcpy(a_answer, &region, sizeof(region));
+    const int words = Grid_pack(region, (uint32_t *)a_answer + sizeof(region) / sizeof(int32_t));
+    if (Telemetry_replyPayload(command.socket, command.generation, command.sequence, O_MAP, a_answer, sizeof(region) + words * sizeof(int32_t)) == FALSE)
+    {
+        TRACE("Telemetry queue full, map dropped\n");
+    }
+}
+
+static void replyHistory(Command_s command)
+{
+    static int32_t a_answer[MAX_PAYLOAD / sizeof(int32_t)];
+    HistoryHeader_s *p_header = (HistoryHeader_s *)a_answer;
+
+    if (command.size != sizeof(HistoryQuery_s))
+    {
+        TRACE("Invalid history request of %d bytes ignored\n", command.size);
+        return;
+    }
+    p_header->now = Clock_milliseconds() - startTime;
+    p_header->count = History_query(*(const HistoryQuery_s *)command.p_payload, (HistorySample_s *)(p_header + 1), MAX_HISTORY_REPLY);
+    if (Telemetry_replyPayload(command.socket, command.generation, command.sequence, O_HISTORY, a_answer, sizeof(HistoryHeader_s) + p_header->count * sizeof(HistorySample_s)) == FALSE)
+    {
+        TRACE("Telemetry queue full, history dropped\n");
+    }
+}
+
+static void publish(long time)
+{
+    if (time - lastPublish >= TELEMETRY_PERIOD && Telemetry_getObserverCount() > 0)
+    {
+        lastPublish = time;
+        if (Telemetry_publish(Pilot_getState()) == FALSE)
+        {
+            TRACE("Telemetry queue full, state dropped\n");
+        }
+    }
+}
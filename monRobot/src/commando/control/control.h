@@ -0,0 +1,139 @@
+/**
+ * @file  control.h
+ *
+ * @brief  Control thread, sole owner of the pilot and the robot
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stdint.h>
+
+#include "../../common.h"
+#include "../pilot/pilot.h"
+#include "../odometry/odometry.h"
+
+/**
+ * @brief An order received by the server, to be applied by the pilot
+ */
+typedef struct
+{
+    Order_e order;
+    Direction_e direction;
+    int socket;         // Connection waiting for the answer
+    int32_t *p_payload; // Payload in host byte order, freed by the control thread
+    int size;           // Bytes of payload
+    uint32_t sequence;  // Number given by the client, acknowledged once applied, 0 if none
+    uint32_t generation; // Of the connection, see Telemetry_attach()
+} Command_s;
+
+/**
+ * @brief Order of the server: nothing to apply, only the acknowledgement of an order it shed
+ */
+#define ORDER_SKIP (O_NB_ORDER + 2)
+
+/**
+ * @brief What the control thread hands over to a replacing commando
+ */
+typedef struct
+{
+    PilotSnapshot_s pilot;
+    Pose_s pose;
+} ControlSnapshot_s;
+
+/**
+ * @brief Initializes the control thread and the pilot
+ */
+extern void Control_new();
+
+/**
+ * @brief Limits the changes of the wheel commands, to be called before Control_start()
+ *
+ * @param acceleration Maximum acceleration (%/s), 0 for no limit
+ * @param jerk Maximum change of the acceleration (%/s²), 0 for no limit
+ */
+extern void Control_setLimits(int acceleration, int jerk);
+
+/**
+ * @brief Starts the control thread (and the robot within it)
+ */
+extern void Control_start();
+
+/**
+ * @brief Starts the control loop without thread, instead of Control_start(), for a simulation
+ *
+ * The loop then only runs within Control_step().
+ */
+extern void Control_startStepped();
+
+/**
+ * @brief Applies the orders posted and runs the control period if its time has come
+ *
+ * Called by the control thread, or by the simulation after Control_startStepped().
+ *
+ * @return long Time of the next control period (ms of Clock_monotonic())
+ */
+extern long Control_step();
+
+/**
+ * @brief Starts the control thread where another commando left it, instead of Control_start()
+ *
+ * @param snapshot What the other commando handed over (copied)
+ */
+extern void Control_resume(const ControlSnapshot_s *snapshot);
+
+/**
+ * @brief Ends the control thread without stopping the robot, for a replacing commando
+ *
+ * The robot is released as it goes, with its last commands. A mission or a
+ * goal in progress could not be finished by the other commando: the control
+ * thread then goes on and nothing is handed over.
+ *
+ * @param snapshot Where to write what the pilot was doing
+ * @return TRUE if the control thread ended, FALSE if it goes on
+ */
+extern bool_e Control_suspend(ControlSnapshot_s *snapshot);
+
+/**
+ * @brief Stops the control thread and waits for its end
+ */
+extern void Control_stop();
+
+/**
+ * @brief Gives an order to the control thread, never blocks
+ *
+ * @param command The order to apply
+ * @return TRUE if the order was queued, FALSE if the queue is full
+ */
+extern bool_e Control_post(Command_s command);
+
+#endif /* CONTROL_H */
@@ -0,0 +1,302 @@
+/**
+ * @file filter.c
+ *
+ * @see filter.h
+ *
+ * The streams are laid out side by side, four of them in a vector of the
+ * compiler (SSE on x86, NEON on ARM): each stage runs on four streams per
+ * instruction, and a bank of hundreds of streams costs a few hundred
+ * vector operations per sample. The median sorts its window with an
+ * odd-even transposition network, made of minima and maxima only, which
+ * needs no branch per stream.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "filter.h"
+
+/**
+ * @brief Streams per vector
+ */
+#define LANES (4)
+
+/**
+ * @brief Four analog streams
+ */
+typedef float Float4_v __attribute__((vector_size(LANES * sizeof(float))));
+
+/**
+ * @brief Four contact streams, or the mask of a comparison (-1: true)
+ */
+typedef int32_t Int4_v __attribute__((vector_size(LANES * sizeof(int32_t))));
+
+struct FilterBank
+{
+    FilterConfig_s config;
+    int analogCount;
+    int contactCount;
+    int analogVectors;
+    int contactVectors;
+    unsigned long sampleCount; // Samples pushed, gives the slots of the windows
+    Float4_v *p_raw;           // [median][analogVectors], the last samples
+    Float4_v *p_medians;       // [mean][analogVectors], the last medians
+    Float4_v *p_smooth;        // [analogVectors], the exponential average, output of the stages
+    Int4_v *p_counters;        // [contactVectors], between 0 (released) and debounce (pressed)
+    Int4_v *p_states;          // [contactVectors], 0 or 1
+};
+
+/**
+ * @brief Gives a vector with the same value in every lane
+ *
+ * @param value The value
+ * @return Float4_v The vector
+ */
+static Float4_v splat(float value);
+
+/**
+ * @brief Takes the lanes of a where the mask is set, those of b elsewhere
+ *
+ * @param mask Result of a comparison
+ * @param a Values where the mask is set
+ * @param b Values elsewhere
+ * @return Float4_v The blend
+ */
+static Float4_v select4(Int4_v mask, Float4_v a, Float4_v b);
+
+/**
+ * @brief Orders two vectors lane by lane, the smaller values in the first one
+ *
+ * @param p_low First vector
+ * @param p_high Second vector
+ */
+static void exchange(Float4_v *p_low, Float4_v *p_high);
+
+/**
+ * @brief Allocates vectors aligned for the vector instructions, cleared
+ *
+ * @param count Number of vectors
+ * @return void* The vectors, NULL on failure
+ */
+static void *allocate(int count);
+
+extern FilterConfig_s Filter_raw()
+{
+    const FilterConfig_s config = {1, 1, 1.0f, 1};
+    return config;
+}
+
+extern bool_e Filter_parse(const char *p_text, FilterConfig_s *p_config)
+{
+    FilterConfig_s config = Filter_raw();
+
+    while (*p_text != '\0')
+    {
+        char a_name[16];
+        float value;
+        int length;
+
+        if (sscanf(p_text, "%15[a-z]=%f%n", a_name, &value, &length) != 2)
+        {
+            return FALSE;
+        }
+        if (strcmp(a_name, "median") == 0 && (int)value % 2 == 1 && value <= MAX_FILTER_WINDOW)
+        {
+            config.median = (int)value;
+        }
+        else if (strcmp(a_name, "mean") == 0 && value >= 1 && value <= MAX_FILTER_WINDOW)
+        {
+            config.mean = (int)value;
+        }
+        else if (strcmp(a_name, "ema") == 0 && value > 0 && value <= 1)
+        {
+            config.smoothing = value;
+        }
+        else if (strcmp(a_name, "debounce") == 0 && value >= 1)
+        {
+            config.debounce = (int)value;
+        }
+        else
+        {
+            return FALSE;
+        }
+        p_text += length;
+        p_text += (*p_text == ',') ? 1 : 0;
+    }
+    *p_config = config;
+    return TRUE;
+}
+
+extern bool_e Filter_isUsed(const FilterConfig_s *p_config)
+{
+    return (p_config->median > 1 || p_config->mean > 1 || p_config->smoothing < 1.0f || p_config->debounce > 1) ? TRUE : FALSE;
+}
+
+extern FilterBank_s *Filter_new(int analogCount, int contactCount, const FilterConfig_s *p_config)
+{
+    FilterBank_s *p_bank = (FilterBank_s *)calloc(1, sizeof(FilterBank_s));
+
+    if (p_bank == NULL)
+    {
+        return NULL;
+    }
+    p_bank->config = *p_config;
+    p_bank->analogCount = analogCount;
+    p_bank->contactCount = contactCount;
+    p_bank->analogVectors = (analogCount + LANES - 1) / LANES;
+    p_bank->contactVectors = (contactCount + LANES - 1) / LANES;
+    p_bank->p_raw = (Float4_v *)allocate(p_config->median * p_bank->analogVectors);
+    p_bank->p_medians = (Float4_v *)allocate(p_config->mean * p_bank->analogVectors);
+    p_bank->p_smooth = (Float4_v *)allocate(p_bank->analogVectors);
+    p_bank->p_counters = (Int4_v *)allocate(p_bank->contactVectors);
+    p_bank->p_states = (Int4_v *)allocate(p_bank->contactVectors);
+    if (p_bank->p_raw == NULL || p_bank->p_medians == NULL || p_bank->p_smooth == NULL || p_bank->p_counters == NULL || p_bank->p_states == NULL)
+    {
+        Filter_free(p_bank);
+        return NULL;
+    }
+    return p_bank;
+}
+
+extern void Filter_free(FilterBank_s *p_bank)
+{
+    if (p_bank == NULL)
+    {
+        return;
+    }
+    free(p_bank->p_raw);
+    free(p_bank->p_medians);
+    free(p_bank->p_smooth);
+    free(p_bank->p_counters);
+    free(p_bank->p_states);
+    free(p_bank);
+}
+
+extern void Filter_push(FilterBank_s *p_bank, const float a_analog[], const int a_contacts[])
+{
+    const FilterConfig_s *p_config = &p_bank->config;
+    const bool_e first = (p_bank->sampleCount == 0) ? TRUE : FALSE;
+    const int rawSlot = p_bank->sampleCount % p_config->median;
+    const int meanSlot = p_bank->sampleCount % p_config->mean;
+    const Float4_v smoothing = splat(p_config->smoothing);
+    const Float4_v scale = splat(1.0f / p_config->mean);
+
+    for (int v = 0; v < p_bank->analogVectors; v++)
+    {
+        const int lanes = (p_bank->analogCount - v * LANES < LANES) ? p_bank->analogCount - v * LANES : LANES;
+        Float4_v a_window[MAX_FILTER_WINDOW];
+        Float4_v sample = splat(0.0f);
+        Float4_v sum = splat(0.0f);
+
+        memcpy(&sample, &a_analog[v * LANES], lanes * sizeof(float)); // The lanes after the last stream stay at 0
+
+        // Median: the window is sorted, lane by lane
+        for (int k = 0; k < p_config->median; k++)
+        {
+            if (first == TRUE || k == rawSlot)
+            {
+                p_bank->p_raw[k * p_bank->analogVectors + v] = sample;
+            }
+            a_window[k] = p_bank->p_raw[k * p_bank->analogVectors + v];
+        }
+        for (int pass = 0; pass < p_config->median; pass++)
+        {
+            for (int k = pass % 2; k + 1 < p_config->median; k += 2)
+            {
+                exchange(&a_window[k], &a_window[k + 1]);
+            }
+        }
+
+        // Moving average of the medians, summed again at each sample: no drift
+        for (int k = 0; k < p_config->mean; k++)
+        {
+            if (first == TRUE || k == meanSlot)
+            {
+                p_bank->p_medians[k * p_bank->analogVectors + v] = a_window[p_config->median / 2];
+            }
+            sum += p_bank->p_medians[k * p_bank->analogVectors + v];
+        }
+
+        // Exponential average
+        Float4_v *p_smooth = &p_bank->p_smooth[v];
+        const Float4_v mean = sum * scale;
+        *p_smooth = (first == TRUE) ? mean : *p_smooth + smoothing * (mean - *p_smooth);
+    }
+
+    // Debounce: a counter climbs while pressed and falls while released, the state only switches at the ends
+    const Int4_v zero = {0, 0, 0, 0};
+    const Int4_v one = {1, 1, 1, 1};
+    const Int4_v full = {p_config->debounce, p_config->debounce, p_config->debounce, p_config->debounce};
+
+    for (int v = 0; v < p_bank->contactVectors; v++)
+    {
+        const int lanes = (p_bank->contactCount - v * LANES < LANES) ? p_bank->contactCount - v * LANES : LANES;
+        Int4_v sample = zero;
+
+        memcpy(&sample, &a_contacts[v * LANES], lanes * sizeof(int));
+
+        const Int4_v pressed = (sample != zero);
+        Int4_v counter = (first == TRUE) ? (pressed & full) : p_bank->p_counters[v];
+        Int4_v up = counter + one;
+        Int4_v down = counter - one;
+
+        up = ((up > full) & full) | (~(up > full) & up);
+        down = ~(down < zero) & down;
+        counter = (pressed & up) | (~pressed & down);
+
+        const Int4_v high = (counter == full);
+        const Int4_v low = (counter == zero);
+        p_bank->p_counters[v] = counter;
+        p_bank->p_states[v] = (high & one) | (~high & ~low & p_bank->p_states[v]);
+    }
+    p_bank->sampleCount++;
+}
+
+extern void Filter_get(const FilterBank_s *p_bank, float a_analog[], int a_contacts[])
+{
+    for (int v = 0; v < p_bank->analogVectors; v++)
+    {
+        const int lanes = (p_bank->analogCount - v * LANES < LANES) ? p_bank->analogCount - v * LANES : LANES;
+        memcpy(&a_analog[v * LANES], &p_bank->p_smooth[v], lanes * sizeof(float));
+    }
+    for (int v = 0; v < p_bank->contactVectors; v++)
+    {
+        const int lanes = (p_bank->contactCount - v * LANES < LANES) ? p_bank->contactCount - v * LANES : LANES;
+        memcpy(&a_contacts[v * LANES], &p_bank->p_states[v], lanes * sizeof(int));
+    }
+}
+
+static Float4_v splat(float value)
+{
+    const Float4_v vector = {value, value, value, value};
+    return vector;
+}
+
+static Float4_v select4(Int4_v mask, Float4_v a, Float4_v b)
+{
+    return (Float4_v)((mask & (Int4_v)a) | (~mask & (Int4_v)b));
+}
+
+static void exchange(Float4_v *p_low, Float4_v *p_high)
+{
+    const Int4_v less = (*p_low < *p_high);
+    const Float4_v low = select4(less, *p_low, *p_high);
+
+    *p_high = select4(less, *p_high, *p_low);
+    *p_low = low;
+}
+
+static void *allocate(int count)
+{
+    const size_t size = (count > 0 ? count : 1) * sizeof(Float4_v);
+    void *p_vectors = aligned_alloc(sizeof(Float4_v), size);
+
+    if (p_vectors != NULL)
+    {
+        memset(p_vectors, 0, size);
+    }
+    return p_vectors;
+}
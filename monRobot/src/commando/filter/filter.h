@@ -0,0 +1,124 @@
+/**
+ * @file  filter.h
+ *
+ * @brief  Conditioning of the sensor readings, several streams at once
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "../../common.h"
+
+/**
+ * @brief Largest window of the median and of the moving average, in samples
+ */
+#define MAX_FILTER_WINDOW (9)
+
+/**
+ * @brief Settings of the filters, a stage set to 1 is left out
+ *
+ * The analog samples go through the median, then the moving average, then
+ * the exponential average. The contacts are debounced with hysteresis.
+ */
+typedef struct
+{
+    int median;      // Window of the median, odd
+    int mean;        // Window of the moving average
+    float smoothing; // Weight of a new value in the exponential average, in ]0, 1]
+    int debounce;    // Samples that must agree to switch a contact
+} FilterConfig_s;
+
+/**
+ * @brief Several sensor streams filtered together, each stage is computed for four streams at once
+ */
+typedef struct FilterBank FilterBank_s;
+
+/**
+ * @brief Gives the settings leaving the readings as they are
+ *
+ * @return FilterConfig_s The settings
+ */
+extern FilterConfig_s Filter_raw();
+
+/**
+ * @brief Reads settings from a text such as "median=5,mean=4,ema=0.3,debounce=3"
+ *
+ * @param p_text The text, the stages not given are left out
+ * @param p_config Where to write the settings
+ * @return bool_e FALSE if the text is not understood
+ */
+extern bool_e Filter_parse(const char *p_text, FilterConfig_s *p_config);
+
+/**
+ * @brief Tells whether settings change the readings
+ *
+ * @param p_config The settings
+ * @return bool_e TRUE if a stage is used
+ */
+extern bool_e Filter_isUsed(const FilterConfig_s *p_config);
+
+/**
+ * @brief Allocates the streams
+ *
+ * @param analogCount Number of analog streams
+ * @param contactCount Number of contact streams
+ * @param p_config The settings, the same for all the streams of the bank
+ * @return FilterBank_s* Pointer to the bank, NULL on failure
+ */
+extern FilterBank_s *Filter_new(int analogCount, int contactCount, const FilterConfig_s *p_config);
+
+/**
+ * @brief Destroy the bank in memory
+ *
+ * @param p_bank The bank
+ */
+extern void Filter_free(FilterBank_s *p_bank);
+
+/**
+ * @brief Adds a sample to every stream, the first one fills the windows
+ *
+ * @param p_bank The bank
+ * @param a_analog A sample of each analog stream
+ * @param a_contacts A sample of each contact stream, 0 released, otherwise pressed
+ */
+extern void Filter_push(FilterBank_s *p_bank, const float a_analog[], const int a_contacts[]);
+
+/**
+ * @brief Gives the filtered values
+ *
+ * @param p_bank The bank
+ * @param a_analog Where to write the value of each analog stream
+ * @param a_contacts Where to write the state of each contact stream, 0 or 1
+ */
+extern void Filter_get(const FilterBank_s *p_bank, float a_analog[], int a_contacts[]);
+
+#endif /* FILTER_H */
@@ -0,0 +1,179 @@
+/**
+ * @file handoff.c
+ *
+ * @see handoff.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "handoff.h"
+
+/**
+ * @brief Gives the address of the handoff socket
+ *
+ * @return struct sockaddr_un The address
+ */
+static struct sockaddr_un address();
+
+extern int Handoff_listen()
+{
+    const struct sockaddr_un local = address();
+    const int listener = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+
+    if (listener < 0)
+    {
+        return -1;
+    }
+    unlink(HANDOFF_PATH); // Left by a commando which did not end properly
+    if (bind(listener, (const struct sockaddr *)&local, sizeof(local)) != 0 || listen(listener, 1) != 0)
+    {
+        close(listener);
+        return -1;
+    }
+    return listener;
+}
+
+extern int Handoff_accept(int listener)
+{
+    const int socket = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+
+    if (socket < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+    {
+        perror("Erreur lors de la reprise par un autre commando");
+    }
+    return socket;
+}
+
+extern void Handoff_close(int listener)
+{
+    if (listener >= 0)
+    {
+        close(listener);
+        unlink(HANDOFF_PATH);
+    }
+}
+
+extern int Handoff_connect()
+{
+    const struct sockaddr_un remote = address();
+    const int connection = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+
+    if (connection >= 0 && connect(connection, (const struct sockaddr *)&remote, sizeof(remote)) != 0)
+    {
+        close(connection);
+        return -1;
+    }
+    return connection;
+}
+
+extern bool_e Handoff_send(int socket, const void *record, size_t size, int fd)
+{
+    union
+    {
+        struct cmsghdr header;
+        char a_space[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct iovec vector = {(void *)record, size};
+    struct msghdr message;
+
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    if (fd >= 0)
+    {
+        // The kernel installs a duplicate of the descriptor in the receiving process
+        memset(&control, 0, sizeof(control));
+        message.msg_control = control.a_space;
+        message.msg_controllen = sizeof(control.a_space);
+        struct cmsghdr *p_header = CMSG_FIRSTHDR(&message);
+        p_header->cmsg_level = SOL_SOCKET;
+        p_header->cmsg_type = SCM_RIGHTS;
+        p_header->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(p_header), &fd, sizeof(int));
+    }
+
+    return (sendmsg(socket, &message, MSG_NOSIGNAL) == (ssize_t)size) ? TRUE : FALSE;
+}
+
+extern int Handoff_receive(int socket, void *record, size_t size, int *fd, int timeout)
+{
+    union
+    {
+        struct cmsghdr header;
+        char a_space[CMSG_SPACE(sizeof(int))];
+    } control;
+    struct iovec vector = {record, size};
+    struct msghdr message;
+    struct pollfd wait = {socket, POLLIN, 0};
+    ssize_t received;
+
+    *fd = -1;
+    if (poll(&wait, 1, timeout) <= 0)
+    {
+        return -1;
+    }
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control.a_space;
+    message.msg_controllen = sizeof(control.a_space);
+
+    received = recvmsg(socket, &message, MSG_CMSG_CLOEXEC);
+    if (received < 0)
+    {
+        return -1;
+    }
+    // The descriptors are installed even in a truncated message: each one is kept or closed
+    for (struct cmsghdr *p_header = CMSG_FIRSTHDR(&message); p_header != NULL; p_header = CMSG_NXTHDR(&message, p_header))
+    {
+        if (p_header->cmsg_level != SOL_SOCKET || p_header->cmsg_type != SCM_RIGHTS)
+        {
+            continue;
+        }
+        const size_t count = (p_header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            int descriptor;
+
+            memcpy(&descriptor, CMSG_DATA(p_header) + i * sizeof(int), sizeof(int));
+            if (*fd < 0)
+            {
+                *fd = descriptor;
+            }
+            else
+            {
+                close(descriptor); // A single descriptor per record
+            }
+        }
+    }
+    if (received == 0 || (message.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) != 0)
+    {
+        if (*fd >= 0)
+        {
+            close(*fd);
+            *fd = -1;
+        }
+        return -1;
+    }
+    return (int)received;
+}
+
+static struct sockaddr_un address()
+{
+    struct sockaddr_un unixAddress;
+
+    memset(&unixAddress, 0, sizeof(unixAddress));
+    unixAddress.sun_family = AF_UNIX;
+    strncpy(unixAddress.sun_path, HANDOFF_PATH, sizeof(unixAddress.sun_path) - 1);
+    return unixAddress;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file  handoff.h
+ *
+ * @brief  Passing descriptors and records to the commando taking over
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include <stddef.h>
+
+#include "../../common.h"
+
+/**
+ * @brief Unix socket where a running commando waits for the one replacing it
+ */
+#define HANDOFF_PATH "/tmp/commando.handoff"
+
+/**
+ * @brief Largest record exchanged (bytes)
+ */
+#define HANDOFF_MAX_RECORD (sizeof(Data_s) + MAX_PAYLOAD + 256)
+
+/**
+ * @brief Waits for a replacing commando, replaces a stale socket left by a crash
+ *
+ * @return int The listening socket, -1 on error
+ */
+extern int Handoff_listen();
+
+/**
+ * @brief Accepts a replacing commando, never blocks
+ *
+ * @param listener The listening socket
+ * @return int The connection, -1 if there is none
+ */
+extern int Handoff_accept(int listener);
+
+/**
+ * @brief Stops waiting for a replacing commando and removes the socket
+ *
+ * @param listener The listening socket
+ */
+extern void Handoff_close(int listener);
+
+/**
+ * @brief Connects to the running commando
+ *
+ * @return int The connection, -1 if no commando is running
+ */
+extern int Handoff_connect();
+
+/**
+ * @brief Sends a record, with a descriptor if any
+ *
+ * The records keep their boundaries (SOCK_SEQPACKET), each one is read by a single Handoff_receive().
+ *
+ * @param socket The connection
+ * @param record The record
+ * @param size Bytes of the record, at most HANDOFF_MAX_RECORD
+ * @param fd The descriptor to duplicate in the other process, -1 for none
+ * @return TRUE if sent
+ */
+extern bool_e Handoff_send(int socket, const void *record, size_t size, int fd);
+
+/**
+ * @brief Receives a record, with its descriptor if any
+ *
+ * @param socket The connection
+ * @param record Where to write the record
+ * @param size Room for the record
+ * @param fd Where to write the descriptor received, -1 if none
+ * @param timeout Longest wait (ms)
+ * @return int Bytes of the record, -1 on error, timeout or end of the connection
+ */
+extern int Handoff_receive(int socket, void *record, size_t size, int *fd, int timeout);
+
+#endif /* HANDOFF_H */
@@ -0,0 +1,110 @@
+/**
+ * @file history.c
+ *
+ * @see history.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <string.h>
+
+#include "history.h"
+
+/**
+ * @brief Gives a sample from its age order
+ *
+ * @param index 0 for the oldest sample kept
+ * @return const HistorySample_s* The sample
+ */
+static const HistorySample_s *at(int index);
+
+/**
+ * @brief Finds the first sample at or after a time (binary search, the times never decrease)
+ *
+ * @param time The time
+ * @return int Index of the sample (0 for the oldest), the number of samples if none
+ */
+static int lowerBound(int time);
+
+static HistorySample_s a_samples[HISTORY_SIZE]; // Preallocated, recording never allocates
+static int oldest = 0;
+static int count = 0;
+
+extern void History_clear()
+{
+    oldest = 0;
+    count = 0;
+}
+
+extern void History_record(int time, PilotState_s state)
+{
+    HistorySample_s *p_sample;
+
+    if (count < HISTORY_SIZE)
+    {
+        p_sample = &a_samples[(oldest + count++) % HISTORY_SIZE];
+    }
+    else
+    {
+        p_sample = &a_samples[oldest];
+        oldest = (oldest + 1) % HISTORY_SIZE;
+    }
+    p_sample->time = time;
+    p_sample->speed = state.speed;
+    p_sample->collision = state.collision;
+    p_sample->luminosity = state.luminosity;
+}
+
+extern int History_query(HistoryQuery_s query, HistorySample_s *samples, int maxSamples)
+{
+    const int first = (query.from > 0) ? lowerBound(query.from) : 0;
+    const int end = (query.to > 0) ? lowerBound(query.to) : count;
+    int wanted = end - first;
+
+    if (query.count > 0 && query.count < wanted)
+    {
+        wanted = query.count;
+    }
+    if (wanted > maxSamples)
+    {
+        wanted = maxSamples;
+    }
+    if (wanted <= 0)
+    {
+        return 0;
+    }
+
+    // The most recent ones, copied in at most two pieces of the ring
+    const int start = (oldest + end - wanted) % HISTORY_SIZE;
+    const int firstPiece = (start + wanted > HISTORY_SIZE) ? HISTORY_SIZE - start : wanted;
+
+    memcpy(samples, &a_samples[start], firstPiece * sizeof(HistorySample_s));
+    memcpy(samples + firstPiece, a_samples, (wanted - firstPiece) * sizeof(HistorySample_s));
+    return wanted;
+}
+
+static const HistorySample_s *at(int index)
+{
+    return &a_samples[(oldest + index) % HISTORY_SIZE];
+}
+
+static int lowerBound(int time)
+{
+    int low = 0;
+    int high = count;
+
+    while (low < high)
+    {
+        const int middle = low + (high - low) / 2;
+
+        if (at(middle)->time < time)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return low;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file  history.h
+ *
+ * @brief  Ring of the last states of the robot, queried by time window
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "../../common.h"
+
+/**
+ * @brief Number of samples kept, one per control period
+ */
+#define HISTORY_SIZE (8192)
+
+/**
+ * @brief Forgets all the samples
+ */
+extern void History_clear();
+
+/**
+ * @brief Keeps a sample, the oldest one is replaced once the ring is full
+ *
+ * @param time Time of the sample (ms since the start), never decreasing
+ * @param state State of the robot
+ */
+extern void History_record(int time, PilotState_s state);
+
+/**
+ * @brief Copies the most recent samples of a time window
+ *
+ * @param query The window and the maximum number of samples
+ * @param samples Where to copy the samples, from the oldest to the newest
+ * @param maxSamples Size of samples
+ * @return int Number of samples copied
+ */
+extern int History_query(HistoryQuery_s query, HistorySample_s *samples, int maxSamples);
+
+#endif /* HISTORY_H */
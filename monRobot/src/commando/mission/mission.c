@@ -0,0 +1,146 @@
+/**
+ * @file mission.c
+ *
+ * @see mission.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../../common.h"
+#include "../pilot/pilot.h"
+#include "../telemetry/telemetry.h"
+#include "mission.h"
+
+/**
+ * @brief Starts a step of the mission
+ *
+ * @param index Index of the step
+ * @param now Current time (ms)
+ */
+static void startStep(int index, long now);
+
+/**
+ * @brief Ends the mission
+ *
+ * @param status Reason given to the client
+ */
+static void finish(MissionStatus_e status);
+
+/**
+ * @brief Sends the progress of the mission to its client
+ *
+ * @param status Status of the mission
+ */
+static void report(MissionStatus_e status);
+
+static MissionStep_s a_steps[MAX_MISSION_STEPS]; // Preallocated, no allocation at upload
+static int stepCount = 0;
+static int currentStep = 0;
+static long stepEnd = 0; // End of the current step (ms)
+static int socketClient = -1;
+static uint32_t generationClient = 0;
+static bool_e running = FALSE;
+
+extern void Mission_load(int socket, uint32_t generation, const MissionStep_s *steps, int count, long now)
+{
+    if (running == TRUE)
+    {
+        Mission_abort(M_ABORTED); // The new mission replaces the old one
+    }
+    socketClient = socket;
+    generationClient = generation;
+    stepCount = 0;
+    currentStep = 0;
+
+    if (count <= 0 || count > MAX_MISSION_STEPS)
+    {
+        report(M_REFUSED);
+        return;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (steps[i].direction < D_STOP || steps[i].direction >= D_NB_DIRECTION || steps[i].power < 0 || steps[i].power > 100 || steps[i].duration < 0)
+        {
+            report(M_REFUSED);
+            return;
+        }
+    }
+    memcpy(a_steps, steps, count * sizeof(MissionStep_s));
+    stepCount = count;
+    running = TRUE;
+    startStep(0, now);
+}
+
+extern void Mission_abort(MissionStatus_e status)
+{
+    if (running == TRUE)
+    {
+        const VelocityVector_s stop = {D_STOP, 0};
+
+        Pilot_setVelocity(stop);
+        finish(status);
+    }
+}
+
+extern void Mission_tick(long now)
+{
+    if (running == FALSE)
+    {
+        return;
+    }
+    if (Pilot_getState().collision == TRUE)
+    {
+        // The pilot has already stopped the robot
+        finish(M_BUMPED);
+        return;
+    }
+    while (running == TRUE && now >= stepEnd)
+    {
+        if (currentStep + 1 < stepCount)
+        {
+            // From the planned end, the delays of the ticks do not add up
+            startStep(currentStep + 1, stepEnd);
+        }
+        else
+        {
+            const VelocityVector_s stop = {D_STOP, 0};
+
+            Pilot_setVelocity(stop);
+            finish(M_DONE);
+        }
+    }
+}
+
+extern bool_e Mission_isRunning()
+{
+    return running;
+}
+
+static void startStep(int index, long now)
+{
+    const VelocityVector_s vector = {(Direction_e)a_steps[index].direction, a_steps[index].power};
+
+    currentStep = index;
+    stepEnd = now + a_steps[index].duration;
+    Pilot_setVelocity(vector);
+    report(M_RUNNING);
+}
+
+static void finish(MissionStatus_e status)
+{
+    running = FALSE;
+    report(status);
+}
+
+static void report(MissionStatus_e status)
+{
+    const MissionProgress_s progress = {currentStep, stepCount, status};
+
+    if (Telemetry_replyPayload(socketClient, generationClient, 0, O_MISSION, &progress, sizeof(progress)) == FALSE)
+    {
+        TRACE("Telemetry queue full, progress dropped\n");
+    }
+}
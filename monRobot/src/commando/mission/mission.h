@@ -0,0 +1,78 @@
+/**
+ * @file  mission.h
+ *
+ * @brief  Missions: sequences of velocity vectors executed by the control thread
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef MISSION_H
+#define MISSION_H
+
+#include "../../common.h"
+
+/**
+ * @brief Replaces the current mission and starts it
+ *
+ * The steps are copied into a preallocated buffer. The client receives a
+ * MissionProgress_s at each step and at the end.
+ *
+ * @param socket Connection of the client following the mission
+ * @param generation Generation of the connection, see Telemetry_attach()
+ * @param steps The steps
+ * @param count Number of steps
+ * @param now Current time (ms)
+ */
+extern void Mission_load(int socket, uint32_t generation, const MissionStep_s *steps, int count, long now);
+
+/**
+ * @brief Aborts the current mission and stops the robot
+ *
+ * @param status Reason given to the client (M_ABORTED, M_BUMPED)
+ */
+extern void Mission_abort(MissionStatus_e status);
+
+/**
+ * @brief Advances the current mission, called at each tick of the control thread
+ *
+ * The collision sensors are checked at every tick.
+ *
+ * @param now Current time (ms)
+ */
+extern void Mission_tick(long now);
+
+/**
+ * @brief Tells whether a mission is in progress
+ *
+ * @return TRUE if a mission is in progress, otherwise FALSE
+ */
+extern bool_e Mission_isRunning();
+
+#endif /* MISSION_H */
@@ -0,0 +1,113 @@
+/**
+ * @file grid.c
+ *
+ * @see grid.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <string.h>
+
+#include "grid.h"
+
+/**
+ * @brief 8 x 8 cells, one bit of each word per cell, row-major
+ */
+typedef struct
+{
+    uint64_t known;    // The cell was observed
+    uint64_t occupied; // The cell holds an obstacle
+} Tile_s;
+
+/**
+ * @brief Gives the tile of a cell and the bit of the cell in it
+ *
+ * @param column Column of the cell (inside the grid)
+ * @param row Row of the cell (inside the grid)
+ * @param bit Where to write the mask of the cell
+ * @return Tile_s* The tile
+ */
+static Tile_s *locate(int column, int row, uint64_t *bit);
+
+/**
+ * @brief Tells whether a cell is inside the grid
+ *
+ * @param column Column of the cell
+ * @param row Row of the cell
+ * @return TRUE if inside
+ */
+static bool_e isInside(int column, int row);
+
+// The neighbouring cells share a tile, and so a cache line
+static Tile_s a_tiles[GRID_TILES * GRID_TILES];
+
+extern void Grid_clear()
+{
+    memset(a_tiles, 0, sizeof(a_tiles));
+}
+
+extern void Grid_mark(int column, int row, Cell_e cell)
+{
+    uint64_t bit;
+    Tile_s *p_tile;
+
+    if (isInside(column, row) == FALSE)
+    {
+        return;
+    }
+    p_tile = locate(column, row, &bit);
+    p_tile->known |= bit;
+    if (cell == C_OCCUPIED)
+    {
+        p_tile->occupied |= bit;
+    }
+    else
+    {
+        p_tile->occupied &= ~bit;
+    }
+}
+
+extern Cell_e Grid_get(int column, int row)
+{
+    uint64_t bit;
+    const Tile_s *p_tile;
+
+    if (isInside(column, row) == FALSE)
+    {
+        return C_UNKNOWN;
+    }
+    p_tile = locate(column, row, &bit);
+    if ((p_tile->known & bit) == 0)
+    {
+        return C_UNKNOWN;
+    }
+    return (p_tile->occupied & bit) ? C_OCCUPIED : C_FREE;
+}
+
+extern int Grid_pack(MapRegion_s region, uint32_t *words)
+{
+    const int count = (region.width * region.height + 15) / 16;
+    int index = 0;
+
+    memset(words, 0, count * sizeof(uint32_t));
+    for (int row = region.row; row < region.row + region.height; row++)
+    {
+        for (int column = region.column; column < region.column + region.width; column++)
+        {
+            words[index / 16] |= (uint32_t)Grid_get(column, row) << (2 * (index % 16));
+            index++;
+        }
+    }
+    return count;
+}
+
+static Tile_s *locate(int column, int row, uint64_t *bit)
+{
+    *bit = (uint64_t)1 << ((row % GRID_TILE) * GRID_TILE + column % GRID_TILE);
+    return &a_tiles[(row / GRID_TILE) * GRID_TILES + column / GRID_TILE];
+}
+
+static bool_e isInside(int column, int row)
+{
+    return (column >= 0 && column < MAP_SIZE && row >= 0 && row < MAP_SIZE) ? TRUE : FALSE;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file  grid.h
+ *
+ * @brief  Occupancy grid, bit-packed cells in row-major tiles
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef GRID_H
+#define GRID_H
+
+#include <stdint.h>
+
+#include "../../common.h"
+
+/**
+ * @brief Cells per side of a tile, a tile fits in two 64-bit words
+ */
+#define GRID_TILE (8)
+
+/**
+ * @brief Tiles per side of the grid
+ */
+#define GRID_TILES (MAP_SIZE / GRID_TILE)
+
+/**
+ * @brief Forgets all the cells
+ */
+extern void Grid_clear();
+
+/**
+ * @brief Records the observation of a cell, the last one wins
+ *
+ * @param column Column of the cell, outside the grid the call does nothing
+ * @param row Row of the cell
+ * @param cell C_FREE or C_OCCUPIED
+ */
+extern void Grid_mark(int column, int row, Cell_e cell);
+
+/**
+ * @brief Gives the state of a cell
+ *
+ * @param column Column of the cell
+ * @param row Row of the cell
+ * @return Cell_e C_UNKNOWN outside the grid
+ */
+extern Cell_e Grid_get(int column, int row);
+
+/**
+ * @brief Copies a region of the grid, 2 bits per cell, row by row
+ *
+ * The first cell is in the low bits of the first word, 16 cells per word.
+ *
+ * @param region Region to copy, it may go beyond the grid (unknown cells)
+ * @param words Where to write the cells, (width * height + 15) / 16 words
+ * @return int Number of words written
+ */
+extern int Grid_pack(MapRegion_s region, uint32_t *words);
+
+#endif /* GRID_H */
@@ -0,0 +1,80 @@
+/**
+ * @file odometry.c
+ *
+ * @see odometry.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <math.h>
+
+#include "../robot/robot.h"
+#include "grid.h"
+#include "odometry.h"
+
+/**
+ * @brief Speed of a wheel at a command of 100 % (mm/s)
+ */
+#define WHEEL_SPEED (200.0)
+
+/**
+ * @brief Distance between the wheels (mm)
+ */
+#define WHEEL_BASE (120.0)
+
+/**
+ * @brief Distance from the centre of the robot to the obstacle when it bumps (mm)
+ */
+#define BUMPER_REACH (80.0)
+
+static Pose_s pose;
+
+extern void Odometry_new()
+{
+    pose = (Pose_s){0, 0, 0};
+    Grid_clear();
+}
+
+extern void Odometry_update(long period)
+{
+    const double time = period / 1000.0;
+    int right;
+    int left;
+    int column;
+    int row;
+
+    Robot_getWheelsVelocity(&right, &left);
+
+    // Same convention as the pilot: D_LEFT drives the left wheel forward
+    const double speed = (left + right) / 2.0 * WHEEL_SPEED / 100.0;
+    const double turnRate = (left - right) * WHEEL_SPEED / 100.0 / WHEEL_BASE;
+    const double middle = pose.heading + turnRate * time / 2; // Heading in the middle of the period
+
+    pose.x += speed * time * cos(middle);
+    pose.y += speed * time * sin(middle);
+    pose.heading = remainder(pose.heading + turnRate * time, 2 * M_PI);
+
+    Odometry_toCell(pose.x, pose.y, &column, &row);
+    Grid_mark(column, row, C_FREE);
+    if (Robot_getSensorState().collision == BUMPED)
+    {
+        Odometry_toCell(pose.x + BUMPER_REACH * cos(pose.heading), pose.y + BUMPER_REACH * sin(pose.heading), &column, &row);
+        Grid_mark(column, row, C_OCCUPIED);
+    }
+}
+
+extern Pose_s Odometry_getPose()
+{
+    return pose;
+}
+
+extern void Odometry_setPose(Pose_s newPose)
+{
+    pose = newPose;
+}
+
+extern void Odometry_toCell(double x, double y, int *column, int *row)
+{
+    *column = (int)floor(x / MAP_CELL) + MAP_SIZE / 2;
+    *row = (int)floor(y / MAP_CELL) + MAP_SIZE / 2;
+}
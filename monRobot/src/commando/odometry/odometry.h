@@ -0,0 +1,89 @@
+/**
+ * @file  odometry.h
+ *
+ * @brief  Dead reckoning of the pose from the wheel commands, and mapping
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef ODOMETRY_H
+#define ODOMETRY_H
+
+#include "../../common.h"
+
+/**
+ * @brief Pose of the robot
+ */
+typedef struct
+{
+    double x;       // mm
+    double y;       // mm
+    double heading; // rad, between -pi and pi
+} Pose_s;
+
+/**
+ * @brief Puts the robot back at the origin and forgets the map
+ */
+extern void Odometry_new();
+
+/**
+ * @brief Integrates the wheel commands over a period and updates the map
+ *
+ * Called by the control thread at each tick, it never allocates.
+ *
+ * @param period Time since the last update (ms)
+ */
+extern void Odometry_update(long period);
+
+/**
+ * @brief Gives the estimated pose
+ *
+ * @return Pose_s The pose
+ */
+extern Pose_s Odometry_getPose();
+
+/**
+ * @brief Puts the robot at a known pose, the map is kept
+ *
+ * @param newPose The pose
+ */
+extern void Odometry_setPose(Pose_s newPose);
+
+/**
+ * @brief Gives the cell of the map under a position
+ *
+ * @param x Position (mm)
+ * @param y Position (mm)
+ * @param column Where to write the column
+ * @param row Where to write the row
+ */
+extern void Odometry_toCell(double x, double y, int *column, int *row);
+
+#endif /* ODOMETRY_H */
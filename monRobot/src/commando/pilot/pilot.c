@@ -9,9 +9,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <math.h>
 
 #include "pilot.h"
 #include "../robot/robot.h"
+#include "../profile/profile.h"
+
+/**
+ * @brief Time to move back from an obstacle (ms)
+ */
+#define BACK_OFF_TIME (400)
+
+/**
+ * @brief Time to turn to a new heading (ms)
+ */
+#define TURN_TIME (500)
+
+/**
+ * @brief Decrease of the light that makes the robot turn (mV)
+ */
+#define LIGHT_HYSTERESIS (10)
 
 typedef enum State
 {
@@ -19,6 +36,9 @@ typedef enum State
     S_RUNNING,
     S_IDLE,
     S_VERS_RUNNING,
+    S_CRUISING, // Behaviour: goes ahead
+    S_BACKING,  // Behaviour: moves back from an obstacle
+    S_TURNING,  // Behaviour: turns to a new heading
     S_NB_STATE
 } State_e;
 
@@ -28,6 +48,10 @@ typedef enum Event
     E_ASK_LOG,
     E_BUMPED,
     E_STOP,
+    E_BEHAVIOUR, // A behaviour was chosen
+    E_TICK,      // Control period
+    E_DARKER,    // The light decreases
+    E_DONE,      // End of a manoeuvre
     E_NB_EVENT
 } Event_e;
 
@@ -37,9 +61,24 @@ typedef enum Action
     A_CHECK_VECTOR,
     A_STOP,
     A_SET_MVT,
+    A_CRUISE,
+    A_BACK_OFF,
+    A_TURN,
+    A_MANOEUVRE,
+    A_BUMP,
     A_NB_ACTION
 } Action_e;
 
+/**
+ * @brief A velocity moving towards its setpoint
+ */
+typedef struct Ramp
+{
+    double value; // Current command (%)
+    double rate;  // Current acceleration (%/s)
+    double target;
+} Ramp_s;
+
 typedef struct Transition
 {
     State_e stateNext;
@@ -54,11 +93,33 @@ static Transition_s a_stateMachine[S_NB_STATE][E_NB_EVENT] =
         [S_IDLE][E_CHANGE_MVT] = {S_VERS_RUNNING, A_CHECK_VECTOR},
         [S_RUNNING][E_CHANGE_MVT] = {S_VERS_RUNNING, A_CHECK_VECTOR},
 
-        [S_RUNNING][E_BUMPED] = {S_IDLE, A_STOP},
-        [S_IDLE][E_BUMPED] = {S_IDLE, A_STOP},
+        [S_RUNNING][E_BUMPED] = {S_IDLE, A_BUMP},
+        [S_IDLE][E_BUMPED] = {S_IDLE, A_BUMP},
 
         [S_VERS_RUNNING][E_CHANGE_MVT] = {S_RUNNING, A_SET_MVT},
         [S_VERS_RUNNING][E_STOP] = {S_IDLE, A_STOP},
+
+        [S_IDLE][E_BEHAVIOUR] = {S_CRUISING, A_CRUISE},
+        [S_RUNNING][E_BEHAVIOUR] = {S_CRUISING, A_CRUISE},
+        [S_CRUISING][E_BEHAVIOUR] = {S_CRUISING, A_CRUISE},
+        [S_BACKING][E_BEHAVIOUR] = {S_CRUISING, A_CRUISE},
+        [S_TURNING][E_BEHAVIOUR] = {S_CRUISING, A_CRUISE},
+
+        [S_CRUISING][E_TICK] = {S_CRUISING, A_CRUISE},
+        [S_CRUISING][E_BUMPED] = {S_BACKING, A_BACK_OFF},
+        [S_CRUISING][E_DARKER] = {S_TURNING, A_TURN},
+        [S_BACKING][E_TICK] = {S_BACKING, A_MANOEUVRE},
+        [S_BACKING][E_DONE] = {S_TURNING, A_TURN},
+        [S_TURNING][E_TICK] = {S_TURNING, A_MANOEUVRE},
+        [S_TURNING][E_DONE] = {S_CRUISING, A_CRUISE},
+
+        // The operator takes over
+        [S_CRUISING][E_CHANGE_MVT] = {S_VERS_RUNNING, A_CHECK_VECTOR},
+        [S_BACKING][E_CHANGE_MVT] = {S_VERS_RUNNING, A_CHECK_VECTOR},
+        [S_TURNING][E_CHANGE_MVT] = {S_VERS_RUNNING, A_CHECK_VECTOR},
+        [S_CRUISING][E_STOP] = {S_IDLE, A_STOP},
+        [S_BACKING][E_STOP] = {S_IDLE, A_STOP},
+        [S_TURNING][E_STOP] = {S_IDLE, A_STOP},
 };
 
 /**
@@ -82,6 +143,77 @@ static void sendMvt(VelocityVector_s vector);
  */
 static void checkVector(VelocityVector_s vector);
 
+/**
+ * @brief Goes ahead with the behaviour, checks the bumper and the light
+ *
+ * @param vector Speed vector (Not taken into consideration)
+ */
+static void cruise(VelocityVector_s vector);
+
+/**
+ * @brief Stops at once and moves back from the obstacle
+ *
+ * @param vector Speed vector (Not taken into consideration)
+ */
+static void backOff(VelocityVector_s vector);
+
+/**
+ * @brief Turns on the spot, alternately to the left and to the right
+ *
+ * @param vector Speed vector (Not taken into consideration)
+ */
+static void turn(VelocityVector_s vector);
+
+/**
+ * @brief Ends the manoeuvre in progress once its time is over
+ *
+ * @param vector Speed vector (Not taken into consideration)
+ */
+static void manoeuvre(VelocityVector_s vector);
+
+/**
+ * @brief Stops the robot after a collision and tells the bump handler
+ *
+ * @param vector Speed vector (Not taken into consideration)
+ */
+static void bump(VelocityVector_s vector);
+
+/**
+ * @brief Stops the robot at once and forgets the ramps
+ */
+static void halt();
+
+/**
+ * @brief Sets the setpoint of both velocities
+ *
+ * @param linearTarget Linear velocity (%)
+ * @param angularTarget Angular velocity (%)
+ */
+static void setTarget(double linearTarget, double angularTarget);
+
+/**
+ * @brief Follows a continuous setpoint if the robot can move
+ *
+ * @param linearTarget Linear velocity (%)
+ * @param angularTarget Angular velocity (%)
+ */
+static void follow(double linearTarget, double angularTarget);
+
+/**
+ * @brief Moves a velocity towards its setpoint within the limits
+ *
+ * @param ramp The velocity
+ * @param period Time step (s)
+ */
+static void step(Ramp_s *ramp, double period);
+
+/**
+ * @brief Moves the velocities and sends the wheel commands if they changed
+ *
+ * @param period Time step (s)
+ */
+static void drive(double period);
+
 /**
  * @brief State machine of our pilot
  *
@@ -92,9 +224,23 @@ static void run(Event_e event, VelocityVector_s vector);
 static PilotState_s *p_pilot = 0;
 static State_e currentState;
 static VelocityVector_s vectorDefault = {D_STOP, 0};
+static Ramp_s linear = {0, 0, 0};
+static Ramp_s angular = {0, 0, 0};
+static int sentLeft = 0;  // Last commands given to the robot
+static int sentRight = 0;
+static double maxAcceleration = 0; // 0: no limit
+static double maxJerk = 0;         // 0: no limit
+static Behaviour_e behaviour = B_MANUAL;
+static int behaviourPower = 0;
+static long manoeuvreLeft = 0;    // Time left for the manoeuvre (ms)
+static long tickPeriod = 0;       // Time since the last tick (ms)
+static bool_e turnLeft = TRUE;    // Next turn
+static float referenceLight = -1; // Brightest light since the last turn, -1: not known yet
+static int runDepth = 0;          // The actions run the machine again, only the outermost pass is profiled
 
 typedef void (*action_p)();
-static const action_p a_actionTab[A_NB_ACTION] = {&Pilot_check, &checkVector, &Pilot_stop, &sendMvt};
+static const action_p a_actionTab[A_NB_ACTION] = {&Pilot_check, &checkVector, &Pilot_stop, &sendMvt, &cruise, &backOff, &turn, &manoeuvre, &bump};
+static BumpHandler_p bumpHandler = NULL;
 
 extern void Pilot_new()
 {
@@ -112,9 +258,33 @@ extern void Pilot_start()
     currentState = S_IDLE;
 }
 
+extern PilotSnapshot_s Pilot_save()
+{
+    const PilotSnapshot_s snapshot = {currentState, {linear.value, linear.rate, linear.target}, {angular.value, angular.rate, angular.target},
+                                      sentLeft, sentRight, behaviour, behaviourPower, manoeuvreLeft, turnLeft, referenceLight};
+    return snapshot;
+}
+
+extern void Pilot_resume(const PilotSnapshot_s *snapshot)
+{
+    Robot_resume();
+    currentState = (snapshot->state > S_NONE && snapshot->state < S_NB_STATE) ? (State_e)snapshot->state : S_IDLE;
+    linear = (Ramp_s){snapshot->a_linear[0], snapshot->a_linear[1], snapshot->a_linear[2]};
+    angular = (Ramp_s){snapshot->a_angular[0], snapshot->a_angular[1], snapshot->a_angular[2]};
+    behaviour = (snapshot->behaviour > B_MANUAL && snapshot->behaviour < B_NB_BEHAVIOUR) ? (Behaviour_e)snapshot->behaviour : B_MANUAL;
+    behaviourPower = snapshot->behaviourPower;
+    manoeuvreLeft = snapshot->manoeuvreLeft;
+    turnLeft = snapshot->turnLeft;
+    referenceLight = snapshot->referenceLight;
+    sentLeft = snapshot->sentLeft;
+    sentRight = snapshot->sentRight;
+    Robot_setWheelsVelocity(sentRight, sentLeft); // Unchanged if the robot kept them
+}
+
 extern void Pilot_stop(VelocityVector_s vector)
 {
-    Robot_stop();
+    halt();
+    behaviour = B_MANUAL;
     currentState = S_IDLE;
 }
 
@@ -123,10 +293,54 @@ extern void Pilot_setVelocity(VelocityVector_s vector)
     run(E_CHANGE_MVT, vector);
 }
 
+extern void Pilot_setLimits(int acceleration, int jerk)
+{
+    maxAcceleration = (acceleration > 0) ? acceleration : 0;
+    maxJerk = (jerk > 0) ? jerk : 0;
+}
+
+extern void Pilot_setTwist(int linear, int angular)
+{
+    follow(linear, angular);
+}
+
+extern void Pilot_setWheels(int left, int right)
+{
+    follow((left + right) / 2.0, (left - right) / 2.0);
+}
+
+extern void Pilot_setBehaviour(Behaviour_e newBehaviour, int power)
+{
+    if (newBehaviour <= B_MANUAL || newBehaviour >= B_NB_BEHAVIOUR)
+    {
+        run(E_STOP, vectorDefault); // Back to the orders of the operator
+        return;
+    }
+    behaviour = newBehaviour;
+    behaviourPower = (power > 100) ? 100 : (power < 0) ? 0 : power;
+    referenceLight = -1;
+    run(E_BEHAVIOUR, vectorDefault);
+}
+
+extern void Pilot_setBumpHandler(BumpHandler_p handler)
+{
+    bumpHandler = handler;
+}
+
+extern void Pilot_tick(long period)
+{
+    tickPeriod = period;
+    run(E_TICK, vectorDefault); // Only the behaviours react to it
+    if (currentState == S_RUNNING || currentState == S_CRUISING || currentState == S_BACKING || currentState == S_TURNING)
+    {
+        drive(period / 1000.0);
+    }
+}
+
 extern PilotState_s Pilot_getState()
 {
     p_pilot->collision = hasBumped();
-    p_pilot->luminosity = Robot_getSensorState().luminosity;
+    p_pilot->luminosity = (int)lroundf(Robot_getSensorState().luminosity); // Rounded, not truncated, on the wire
     p_pilot->speed = Robot_getRobotSpeed();
     run(E_ASK_LOG, vectorDefault);
 
@@ -156,20 +370,173 @@ static void sendMvt(VelocityVector_s vector)
     switch (vector.dir)
     {
     case D_FORWARD:
-        Robot_setWheelsVelocity(vector.power, vector.power);
+        setTarget(vector.power, 0);
         break;
     case D_BACKWARD:
-        Robot_setWheelsVelocity(-vector.power, -vector.power);
+        setTarget(-vector.power, 0);
         break;
     case D_LEFT:
-        Robot_setWheelsVelocity(-vector.power, vector.power);
+        setTarget(0, vector.power);
         break;
     case D_RIGHT:
-        Robot_setWheelsVelocity(vector.power, -vector.power);
+        setTarget(0, -vector.power);
         break;
     default:
         run(E_STOP, vectorDefault);
-        break;
+        return;
+    }
+    drive(0); // Without limits, the robot follows at once
+}
+
+static void cruise(VelocityVector_s vector)
+{
+    const SensorState_s sensors = Robot_getSensorState();
+
+    if (sensors.collision == BUMPED)
+    {
+        run(E_BUMPED, vectorDefault);
+        return;
+    }
+    if (behaviour == B_SEEK_LIGHT)
+    {
+        // Run and tumble: goes ahead while the light does not decrease
+        if (referenceLight >= 0 && sensors.luminosity < referenceLight - LIGHT_HYSTERESIS)
+        {
+            run(E_DARKER, vectorDefault);
+            return;
+        }
+        if (sensors.luminosity > referenceLight)
+        {
+            referenceLight = sensors.luminosity;
+        }
+    }
+    setTarget(behaviourPower, 0);
+}
+
+static void backOff(VelocityVector_s vector)
+{
+    halt(); // The robot is against the obstacle
+    setTarget(-behaviourPower, 0);
+    manoeuvreLeft = BACK_OFF_TIME;
+}
+
+static void turn(VelocityVector_s vector)
+{
+    setTarget(0, turnLeft ? behaviourPower : -behaviourPower);
+    turnLeft = !turnLeft;
+    referenceLight = -1; // The light is measured again on the new heading
+    manoeuvreLeft = TURN_TIME;
+}
+
+static void manoeuvre(VelocityVector_s vector)
+{
+    manoeuvreLeft -= tickPeriod;
+    if (manoeuvreLeft <= 0)
+    {
+        run(E_DONE, vectorDefault);
+    }
+}
+
+static void bump(VelocityVector_s vector)
+{
+    Pilot_stop(vector);
+    if (bumpHandler != NULL)
+    {
+        bumpHandler();
+    }
+}
+
+static void halt()
+{
+    // Always immediate, whatever the limits
+    Robot_stop();
+    linear = (Ramp_s){0, 0, 0};
+    angular = (Ramp_s){0, 0, 0};
+    sentLeft = 0;
+    sentRight = 0;
+}
+
+static void follow(double linearTarget, double angularTarget)
+{
+    if (hasBumped())
+    {
+        run(E_BUMPED, vectorDefault);
+        return;
+    }
+    currentState = S_RUNNING; // A null setpoint slows down with the limits, it is not a stop
+    setTarget(linearTarget, angularTarget);
+    drive(0);
+}
+
+static void setTarget(double linearTarget, double angularTarget)
+{
+    linear.target = (linearTarget > 100) ? 100 : (linearTarget < -100) ? -100 : linearTarget;
+    angular.target = (angularTarget > 100) ? 100 : (angularTarget < -100) ? -100 : angularTarget;
+}
+
+static void step(Ramp_s *ramp, double period)
+{
+    const double error = ramp->target - ramp->value;
+    const double sign = (error > 0) ? 1 : -1;
+    double wanted;
+
+    if (maxAcceleration == 0 || error == 0)
+    {
+        ramp->value = ramp->target;
+        ramp->rate = 0;
+        return;
+    }
+
+    wanted = sign * maxAcceleration;
+    if (maxJerk > 0)
+    {
+        const double change = maxJerk * period;
+
+        if (ramp->rate * sign > 0 && ramp->rate * ramp->rate >= 2 * maxJerk * error * sign)
+        {
+            wanted = 0; // Eases off now to reach the setpoint without overshoot
+        }
+        ramp->rate += (wanted - ramp->rate > change) ? change : (wanted - ramp->rate < -change) ? -change : wanted - ramp->rate;
+    }
+    else
+    {
+        ramp->rate = wanted;
+    }
+
+    ramp->value += ramp->rate * period;
+    if ((ramp->target - ramp->value) * sign <= 0)
+    {
+        ramp->value = ramp->target;
+        ramp->rate = 0;
+    }
+}
+
+static void drive(double period)
+{
+    double left;
+    double right;
+    double largest;
+
+    step(&linear, period);
+    step(&angular, period);
+
+    // Same convention as D_LEFT: the right wheel goes back when turning
+    right = linear.value - angular.value;
+    left = linear.value + angular.value;
+    largest = (fabs(left) > fabs(right)) ? fabs(left) : fabs(right);
+    if (largest > 100)
+    {
+        left = left * 100 / largest; // Keeps the curvature
+        right = right * 100 / largest;
+    }
+
+    const int commandLeft = (int)(left + ((left >= 0) ? 0.5 : -0.5));
+    const int commandRight = (int)(right + ((right >= 0) ? 0.5 : -0.5));
+    if (commandLeft != sentLeft || commandRight != sentRight)
+    {
+        Robot_setWheelsVelocity(commandRight, commandLeft);
+        sentLeft = commandLeft;
+        sentRight = commandRight;
     }
 }
 
@@ -189,10 +556,19 @@ static void run(Event_e event, VelocityVector_s vector)
 {
     const Action_e action = a_stateMachine[currentState][event].action;
     const State_e stateNext = a_stateMachine[currentState][event].stateNext;
+    ProfileMark_s mark = {FALSE, {0}};
 
+    if (runDepth++ == 0)
+    {
+        Profile_enter(&mark);
+    }
     if (stateNext != S_NONE)
     {
         currentState = stateNext;
         a_actionTab[action](vector);
     }
+    if (--runDepth == 0)
+    {
+        Profile_leave(PR_PILOT, &mark);
+    }
 }
\ No newline at end of file
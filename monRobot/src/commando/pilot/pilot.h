@@ -43,6 +43,28 @@ typedef struct
     int power;
 } VelocityVector_s;
 
+/**
+ * @brief What a replacing commando needs to drive on exactly as the pilot did
+ */
+typedef struct
+{
+    int state;             // Of the state machine
+    double a_linear[3];    // Ramp of the linear velocity: command, acceleration, setpoint
+    double a_angular[3];   // Ramp of the angular velocity
+    int sentLeft;          // Last commands given to the robot
+    int sentRight;
+    int behaviour;         // Behaviour_e
+    int behaviourPower;
+    long manoeuvreLeft;    // ms
+    bool_e turnLeft;
+    float referenceLight;
+} PilotSnapshot_s;
+
+/**
+ * @brief Called when a collision stops the robot driven by the operator
+ */
+typedef void (*BumpHandler_p)();
+
 typedef struct
 {
     void (*start)();
@@ -69,6 +91,22 @@ extern void Pilot_free();
  */
 extern void Pilot_start();
 
+/**
+ * @brief Gives what the pilot is doing, to hand it over to another commando
+ *
+ * @return PilotSnapshot_s The state of the pilot
+ */
+extern PilotSnapshot_s Pilot_save();
+
+/**
+ * @brief Starts the pilot where another commando left it, instead of Pilot_start()
+ *
+ * The robot is not stopped, the wheel commands of the snapshot are given again.
+ *
+ * @param snapshot The state of the pilot
+ */
+extern void Pilot_resume(const PilotSnapshot_s *snapshot);
+
 /**
  * @brief Stop pilot and robot (motor speeds at zero)
  *
@@ -83,6 +121,54 @@ extern void Pilot_stop(VelocityVector_s vector);
  */
 extern void Pilot_setVelocity(VelocityVector_s vector);
 
+/**
+ * @brief Limits the changes of the wheel commands, 0 for no limit
+ *
+ * @param acceleration Maximum acceleration (%/s)
+ * @param jerk Maximum change of the acceleration (%/s²)
+ */
+extern void Pilot_setLimits(int acceleration, int jerk);
+
+/**
+ * @brief Sets a continuous setpoint, reached at the pace of the limits
+ *
+ * @param linear Linear velocity, between -100 and 100 (%)
+ * @param angular Angular velocity, between -100 and 100 (%), positive turns like D_LEFT
+ */
+extern void Pilot_setTwist(int linear, int angular);
+
+/**
+ * @brief Sets a continuous setpoint given as wheel speeds
+ *
+ * @param left Left wheel speed, between -100 and 100 (%)
+ * @param right Right wheel speed, between -100 and 100 (%)
+ */
+extern void Pilot_setWheels(int left, int right);
+
+/**
+ * @brief Lets the pilot drive on its own, the manual orders take over again
+ *
+ * @param behaviour Behaviour to run, B_MANUAL stops the robot
+ * @param power Cruising power, between 0 and 100
+ */
+extern void Pilot_setBehaviour(Behaviour_e behaviour, int power);
+
+/**
+ * @brief Chooses the function called when a collision stops the robot
+ *
+ * The behaviours handle their own collisions, the handler is not called for them.
+ *
+ * @param handler The function, NULL for none
+ */
+extern void Pilot_setBumpHandler(BumpHandler_p handler);
+
+/**
+ * @brief Moves the wheel commands towards the setpoint, called at each control period
+ *
+ * @param period Time since the last call (ms)
+ */
+extern void Pilot_tick(long period);
+
 /**
  * @brief Gives the general state of the pilot
  *
@@ -0,0 +1,238 @@
+/**
+ * @file navigation.c
+ *
+ * @see navigation.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#include "../pilot/pilot.h"
+#include "../odometry/odometry.h"
+#include "../telemetry/telemetry.h"
+#include "../../clock/clock.h"
+#include "planner.h"
+#include "navigation.h"
+
+/**
+ * @brief Maximum number of waypoints of a plan
+ */
+#define MAX_WAYPOINTS (256)
+
+/**
+ * @brief Distance under which a waypoint is reached (mm)
+ */
+#define REACHED (MAP_CELL / 2)
+
+/**
+ * @brief Heading error over which the robot turns on the spot (mrad)
+ */
+#define TURN_ON_SPOT (400)
+
+/**
+ * @brief Correction of the heading while driving (% of angular velocity per rad)
+ */
+#define HEADING_GAIN (60)
+
+/**
+ * @brief Time to move back from an obstacle before the new plan (ms)
+ */
+#define BACK_OFF_TIME (400)
+
+/**
+ * @brief Collisions after which the goal is given up
+ */
+#define MAX_REPLANS (8)
+
+typedef enum
+{
+    N_IDLE = 0,
+    N_DRIVING,
+    N_BACKING
+} NavigationState_e;
+
+/**
+ * @brief Plans the way from the current pose to the goal
+ *
+ * @return bool_e TRUE if a way was found
+ */
+static bool_e plan();
+
+/**
+ * @brief Ends the navigation
+ *
+ * @param status Reason given to the client
+ */
+static void finish(MissionStatus_e status);
+
+/**
+ * @brief Sends the progress to the client
+ *
+ * @param status Status of the navigation
+ */
+static void report(MissionStatus_e status);
+
+static Waypoint_s a_waypoints[MAX_WAYPOINTS];
+static int waypointCount = 0;
+static int currentWaypoint = 0;
+static Waypoint_s goalCell;
+static int power = 0;
+static int socketClient = -1;
+static uint32_t generationClient = 0;
+static NavigationState_e state = N_IDLE;
+static bool_e bumped = FALSE;
+static long backingEnd = 0;
+static int planningTime = 0; // µs
+static int replans = 0;
+
+extern void Navigation_go(int socket, uint32_t generation, GoalOrder_s goal)
+{
+    Navigation_abort(M_ABORTED); // The new goal replaces the old one
+    socketClient = socket;
+    generationClient = generation;
+    power = (goal.power > 100) ? 100 : (goal.power <= 0) ? 50 : goal.power;
+    replans = 0;
+    bumped = FALSE;
+    Odometry_toCell(goal.x, goal.y, &goalCell.column, &goalCell.row);
+
+    if (plan() == FALSE)
+    {
+        finish(M_REFUSED);
+        return;
+    }
+    state = N_DRIVING;
+    report(M_RUNNING);
+}
+
+extern void Navigation_abort(MissionStatus_e status)
+{
+    if (state != N_IDLE)
+    {
+        const VelocityVector_s stop = {D_STOP, 0};
+
+        Pilot_setVelocity(stop);
+        finish(status);
+    }
+}
+
+extern void Navigation_tick(long now)
+{
+    if (state == N_IDLE)
+    {
+        return;
+    }
+    if (bumped == TRUE)
+    {
+        const VelocityVector_s back = {D_BACKWARD, power};
+
+        bumped = FALSE;
+        if (++replans > MAX_REPLANS)
+        {
+            finish(M_BUMPED);
+            return;
+        }
+        Pilot_setVelocity(back); // The bumper is pressed, only a manual move is allowed
+        state = N_BACKING;
+        backingEnd = now + BACK_OFF_TIME;
+        return;
+    }
+    if (state == N_BACKING)
+    {
+        if (now < backingEnd)
+        {
+            return;
+        }
+        if (plan() == FALSE)
+        {
+            const VelocityVector_s stop = {D_STOP, 0};
+
+            Pilot_setVelocity(stop);
+            finish(M_BUMPED);
+            return;
+        }
+        state = N_DRIVING;
+        report(M_RUNNING);
+    }
+
+    const Pose_s pose = Odometry_getPose();
+    const double x = (a_waypoints[currentWaypoint].column - MAP_SIZE / 2 + 0.5) * MAP_CELL;
+    const double y = (a_waypoints[currentWaypoint].row - MAP_SIZE / 2 + 0.5) * MAP_CELL;
+
+    if (hypot(x - pose.x, y - pose.y) < REACHED)
+    {
+        if (++currentWaypoint == waypointCount)
+        {
+            const VelocityVector_s stop = {D_STOP, 0};
+
+            Pilot_setVelocity(stop);
+            finish(M_DONE);
+        }
+        else
+        {
+            report(M_RUNNING);
+        }
+        return;
+    }
+
+    const double error = remainder(atan2(y - pose.y, x - pose.x) - pose.heading, 2 * M_PI);
+    if (fabs(error) * 1000 > TURN_ON_SPOT)
+    {
+        Pilot_setTwist(0, (error > 0) ? power / 2 : -power / 2);
+    }
+    else
+    {
+        Pilot_setTwist(power, (int)(error * HEADING_GAIN));
+    }
+}
+
+extern void Navigation_onBump()
+{
+    if (state == N_DRIVING)
+    {
+        bumped = TRUE; // Handled at the next tick, once the map knows the obstacle
+    }
+}
+
+extern bool_e Navigation_isActive()
+{
+    return (state != N_IDLE) ? TRUE : FALSE;
+}
+
+static bool_e plan()
+{
+    const Pose_s pose = Odometry_getPose();
+    int64_t begin;
+    Waypoint_s start;
+
+    Odometry_toCell(pose.x, pose.y, &start.column, &start.row);
+    begin = Clock_monotonic();
+    waypointCount = Planner_plan(start, goalCell, a_waypoints, MAX_WAYPOINTS);
+    planningTime = (int)(Clock_monotonic() - begin); // 0 in a simulation, the virtual time stands still
+    TRACE("Plan of %d waypoints in %d us\n", waypointCount, planningTime);
+
+    currentWaypoint = 0;
+    if (waypointCount == 0)
+    {
+        a_waypoints[0] = goalCell; // Already in the cell of the goal, only the centre is left
+        waypointCount = 1;
+    }
+    return (waypointCount > 0) ? TRUE : FALSE;
+}
+
+static void finish(MissionStatus_e status)
+{
+    state = N_IDLE;
+    report(status);
+}
+
+static void report(MissionStatus_e status)
+{
+    const NavigationProgress_s progress = {status, currentWaypoint, (waypointCount > 0) ? waypointCount : 0, planningTime, replans};
+
+    if (Telemetry_replyPayload(socketClient, generationClient, 0, O_GOTO, &progress, sizeof(progress)) == FALSE)
+    {
+        TRACE("Telemetry queue full, progress dropped\n");
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ * @file  navigation.h
+ *
+ * @brief  Go-to-goal: plans a route on the map and drives it
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef NAVIGATION_H
+#define NAVIGATION_H
+
+#include "../../common.h"
+
+/**
+ * @brief Plans the way to a goal and starts driving it, replaces the current goal
+ *
+ * The client receives a NavigationProgress_s after each plan, at each
+ * waypoint and at the end.
+ *
+ * @param socket Connection of the client
+ * @param generation Generation of the connection, see Telemetry_attach()
+ * @param goal The goal
+ */
+extern void Navigation_go(int socket, uint32_t generation, GoalOrder_s goal);
+
+/**
+ * @brief Gives up the current goal and stops the robot
+ *
+ * @param status Reason given to the client
+ */
+extern void Navigation_abort(MissionStatus_e status);
+
+/**
+ * @brief Drives towards the next waypoint, called at each control period
+ *
+ * @param now Current time (ms)
+ */
+extern void Navigation_tick(long now);
+
+/**
+ * @brief Handler of the collisions of the pilot, a new plan will be made
+ */
+extern void Navigation_onBump();
+
+/**
+ * @brief Tells whether a goal is in progress
+ *
+ * @return TRUE if the robot is driving to a goal, otherwise FALSE
+ */
+extern bool_e Navigation_isActive();
+
+#endif /* NAVIGATION_H */
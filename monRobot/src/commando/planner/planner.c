@@ -0,0 +1,301 @@
+/**
+ * @file planner.c
+ *
+ * @see planner.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "../odometry/grid.h"
+#include "planner.h"
+
+/**
+ * @brief Number of cells of the grid
+ */
+#define CELL_COUNT (MAP_SIZE * MAP_SIZE)
+
+/**
+ * @brief Cost of a move to a side neighbour, and to a diagonal one
+ */
+#define STRAIGHT_COST (10)
+#define DIAGONAL_COST (14)
+
+/**
+ * @brief Size of the arena: the costs, the parents, the positions in the heap and the heap
+ */
+#define ARENA_SIZE (CELL_COUNT * (3 * sizeof(int32_t) + sizeof(HeapEntry_s)) + 64)
+
+/**
+ * @brief Position in the heap of a cell already expanded
+ */
+#define CLOSED (-2)
+
+/**
+ * @brief Memory handed out in order and given back all at once
+ */
+typedef struct
+{
+    unsigned char *p_memory;
+    size_t size;
+    size_t used;
+} Arena_s;
+
+/**
+ * @brief An entry of the open list
+ */
+typedef struct
+{
+    uint32_t cost; // Estimated cost of the path through the cell
+    int32_t cell;
+} HeapEntry_s;
+
+/**
+ * @brief Takes memory from the arena
+ *
+ * @param arena The arena
+ * @param size Number of bytes
+ * @return void* The memory, aligned on 8 bytes, NULL if the arena is full
+ */
+static void *allocate(Arena_s *arena, size_t size);
+
+/**
+ * @brief Puts a cell in the heap, or moves it up if its cost decreased
+ *
+ * @param entry The cell and its cost
+ */
+static void push(HeapEntry_s entry);
+
+/**
+ * @brief Takes the cell with the lowest cost out of the heap
+ *
+ * @return HeapEntry_s The cell
+ */
+static HeapEntry_s pop();
+
+/**
+ * @brief Moves an entry of the heap up to its place
+ *
+ * @param index Position of the entry
+ */
+static void siftUp(int index);
+
+/**
+ * @brief Moves an entry of the heap down to its place
+ *
+ * @param index Position of the entry
+ */
+static void siftDown(int index);
+
+/**
+ * @brief Estimates the cost between two cells (octile distance)
+ *
+ * @param cell The cell
+ * @param goal The goal
+ * @return uint32_t The cost, never more than the real one
+ */
+static uint32_t estimate(int cell, Waypoint_s goal);
+
+/**
+ * @brief Tells whether the robot can stand in a cell
+ *
+ * @param column Column of the cell
+ * @param row Row of the cell
+ * @return TRUE if it is inside the grid and not occupied
+ */
+static bool_e isFree(int column, int row);
+
+static unsigned char a_memory[ARENA_SIZE];
+static Arena_s arena = {a_memory, sizeof(a_memory), 0};
+static uint32_t *p_costs;   // Cost from the start, per cell
+static int32_t *p_parents;  // Previous cell of the path, per cell
+static int32_t *p_position; // Position in the heap, -1 never seen, CLOSED
+static HeapEntry_s *p_heap;
+static int heapSize;
+
+extern int Planner_plan(Waypoint_s start, Waypoint_s goal, Waypoint_s *waypoints, int maxWaypoints)
+{
+    static const int a_moves[8][3] = {{1, 0, STRAIGHT_COST}, {-1, 0, STRAIGHT_COST}, {0, 1, STRAIGHT_COST}, {0, -1, STRAIGHT_COST}, {1, 1, DIAGONAL_COST}, {1, -1, DIAGONAL_COST}, {-1, 1, DIAGONAL_COST}, {-1, -1, DIAGONAL_COST}};
+    const int startCell = start.row * MAP_SIZE + start.column;
+    const int goalCell = goal.row * MAP_SIZE + goal.column;
+    int32_t *p_path;
+    int length = 0;
+    int count = 0;
+
+    if (isFree(start.column, start.row) == FALSE || isFree(goal.column, goal.row) == FALSE)
+    {
+        return -1;
+    }
+
+    arena.used = 0; // Everything of the previous plan is given back
+    p_costs = allocate(&arena, CELL_COUNT * sizeof(uint32_t));
+    p_parents = allocate(&arena, CELL_COUNT * sizeof(int32_t));
+    p_position = allocate(&arena, CELL_COUNT * sizeof(int32_t));
+    p_heap = allocate(&arena, CELL_COUNT * sizeof(HeapEntry_s));
+    memset(p_costs, 0xFF, CELL_COUNT * sizeof(uint32_t));
+    memset(p_position, 0xFF, CELL_COUNT * sizeof(int32_t));
+    heapSize = 0;
+
+    p_costs[startCell] = 0;
+    p_parents[startCell] = -1;
+    push((HeapEntry_s){estimate(startCell, goal), startCell});
+
+    while (heapSize > 0 && p_position[goalCell] != CLOSED)
+    {
+        const int cell = pop().cell;
+        const int column = cell % MAP_SIZE;
+        const int row = cell / MAP_SIZE;
+
+        p_position[cell] = CLOSED;
+        for (int i = 0; i < 8; i++)
+        {
+            const int nextColumn = column + a_moves[i][0];
+            const int nextRow = row + a_moves[i][1];
+            const int next = nextRow * MAP_SIZE + nextColumn;
+            const uint32_t cost = p_costs[cell] + a_moves[i][2];
+
+            if (isFree(nextColumn, nextRow) == FALSE || p_position[next] == CLOSED)
+            {
+                continue;
+            }
+            if (a_moves[i][2] == DIAGONAL_COST && (isFree(nextColumn, row) == FALSE || isFree(column, nextRow) == FALSE))
+            {
+                continue; // The robot would rub the corner of an obstacle
+            }
+            if (cost < p_costs[next])
+            {
+                p_costs[next] = cost;
+                p_parents[next] = cell;
+                push((HeapEntry_s){cost + estimate(next, goal), next});
+            }
+        }
+    }
+    if (p_position[goalCell] != CLOSED)
+    {
+        return -1;
+    }
+
+    // From the goal back to the start, in the memory of the heap no longer needed
+    p_path = (int32_t *)p_heap;
+    for (int cell = goalCell; cell != -1; cell = p_parents[cell])
+    {
+        p_path[length++] = cell;
+    }
+
+    // Only the cells where the direction changes, and the goal
+    for (int i = length - 2; i >= 0; i--)
+    {
+        const int previous = p_path[i + 1];
+        const bool_e isLast = (i == 0);
+        const bool_e turns = (isLast == FALSE) && (p_path[i] - previous != p_path[i - 1] - p_path[i]);
+
+        if (isLast || turns)
+        {
+            if (count == maxWaypoints)
+            {
+                return -1;
+            }
+            waypoints[count].column = p_path[i] % MAP_SIZE;
+            waypoints[count].row = p_path[i] / MAP_SIZE;
+            count++;
+        }
+    }
+    return count;
+}
+
+static void *allocate(Arena_s *arena, size_t size)
+{
+    const size_t start = (arena->used + 7) & ~(size_t)7;
+
+    if (start + size > arena->size)
+    {
+        return NULL;
+    }
+    arena->used = start + size;
+    return arena->p_memory + start;
+}
+
+static void push(HeapEntry_s entry)
+{
+    int index = p_position[entry.cell];
+
+    if (index < 0)
+    {
+        index = heapSize++;
+    }
+    p_heap[index] = entry;
+    p_position[entry.cell] = index;
+    siftUp(index);
+}
+
+static HeapEntry_s pop()
+{
+    const HeapEntry_s top = p_heap[0];
+
+    p_heap[0] = p_heap[--heapSize];
+    p_position[p_heap[0].cell] = 0;
+    siftDown(0);
+    return top;
+}
+
+static void siftUp(int index)
+{
+    const HeapEntry_s entry = p_heap[index];
+
+    while (index > 0 && p_heap[(index - 1) / 2].cost > entry.cost)
+    {
+        p_heap[index] = p_heap[(index - 1) / 2];
+        p_position[p_heap[index].cell] = index;
+        index = (index - 1) / 2;
+    }
+    p_heap[index] = entry;
+    p_position[entry.cell] = index;
+}
+
+static void siftDown(int index)
+{
+    const HeapEntry_s entry = p_heap[index];
+
+    for (;;)
+    {
+        int child = 2 * index + 1;
+
+        if (child >= heapSize)
+        {
+            break;
+        }
+        if (child + 1 < heapSize && p_heap[child + 1].cost < p_heap[child].cost)
+        {
+            child++;
+        }
+        if (p_heap[child].cost >= entry.cost)
+        {
+            break;
+        }
+        p_heap[index] = p_heap[child];
+        p_position[p_heap[index].cell] = index;
+        index = child;
+    }
+    p_heap[index] = entry;
+    p_position[entry.cell] = index;
+}
+
+static uint32_t estimate(int cell, Waypoint_s goal)
+{
+    const int dx = (cell % MAP_SIZE > goal.column) ? cell % MAP_SIZE - goal.column : goal.column - cell % MAP_SIZE;
+    const int dy = (cell / MAP_SIZE > goal.row) ? cell / MAP_SIZE - goal.row : goal.row - cell / MAP_SIZE;
+    const int diagonal = (dx < dy) ? dx : dy;
+
+    return STRAIGHT_COST * (dx + dy) + (DIAGONAL_COST - 2 * STRAIGHT_COST) * diagonal;
+}
+
+static bool_e isFree(int column, int row)
+{
+    if (column < 0 || column >= MAP_SIZE || row < 0 || row >= MAP_SIZE)
+    {
+        return FALSE;
+    }
+    return (Grid_get(column, row) != C_OCCUPIED) ? TRUE : FALSE;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file  planner.h
+ *
+ * @brief  Shortest paths on the occupancy grid, A* without allocation
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include "../../common.h"
+
+/**
+ * @brief A cell of the grid to drive through
+ */
+typedef struct
+{
+    int column;
+    int row;
+} Waypoint_s;
+
+/**
+ * @brief Finds the shortest path between two cells (A*, 8 neighbours)
+ *
+ * The occupied cells and the diagonals between them are avoided, the
+ * unknown cells are assumed free. All the memory comes from a static
+ * arena emptied at each call, a plan never calls malloc().
+ *
+ * @param start Cell of the robot
+ * @param goal Cell to reach
+ * @param waypoints Where to write the path, only the cells where it turns and the goal
+ * @param maxWaypoints Size of waypoints
+ * @return int Number of waypoints, -1 if there is no path (or it is too long)
+ */
+extern int Planner_plan(Waypoint_s start, Waypoint_s goal, Waypoint_s *waypoints, int maxWaypoints);
+
+#endif /* PLANNER_H */
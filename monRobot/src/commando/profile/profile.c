@@ -0,0 +1,267 @@
+/**
+ * @file profile.c
+ *
+ * @see profile.h
+ *
+ * The counters of a thread form one group of perf_event_open(), read in a
+ * single system call at the entry and at the exit of a section: the
+ * difference is what the thread spent in it, whatever the other threads
+ * do. The totals are shared by the threads and kept with atomic additions.
+ *
+ * The group is led by the time of the thread, a software counter always
+ * there: a processor without hardware counters, as in most virtual
+ * machines, still gives the time of each section.
+ *
+ * Only the user space is counted when the system keeps the kernel for
+ * itself (perf_event_paranoid 2), the system calls then look free.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "profile.h"
+
+/**
+ * @brief Most descriptors of counters, for every thread
+ */
+#define MAX_DESCRIPTORS (64 * PROFILE_COUNTERS)
+
+/**
+ * @brief A reading of a group (PERF_FORMAT_GROUP)
+ */
+typedef struct
+{
+    uint64_t count; // Counters of the group, in their order of opening
+    uint64_t a_values[PROFILE_COUNTERS];
+} GroupReading_s;
+
+/**
+ * @brief Opens the counters of the calling thread
+ *
+ * @return int The descriptor of the group, -1 if the first counter is refused
+ */
+static int openGroup();
+
+/**
+ * @brief Opens a counter of the calling thread
+ *
+ * @param type The kind of event (PERF_TYPE_...)
+ * @param config The event (PERF_COUNT_...)
+ * @param leader The group, -1 to start one
+ * @return int The descriptor, -1 on failure
+ */
+static int openCounter(uint32_t type, uint64_t config, int leader);
+
+/**
+ * @brief Reads the counters of the calling thread, opened the first time
+ *
+ * @param a_values Where to write the counters, 0 for those not available
+ * @return bool_e FALSE if the thread has no counters
+ */
+static bool_e readGroup(uint64_t a_values[]);
+
+static const uint32_t a_types[PROFILE_COUNTERS] = {PERF_TYPE_SOFTWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+                                                   PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+static const uint64_t a_events[PROFILE_COUNTERS] = {PERF_COUNT_SW_TASK_CLOCK, PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+static const char *a_regionNames[PR_NB_REGION] = {"pilote", "capteurs", "trames", "sockets"};
+static bool_e enabled = FALSE;
+static bool_e userOnly = FALSE; // The kernel is not counted
+static uint32_t availableMask = 0; // Counters opened at least once, bit k for a_events[k]
+static int a_descriptors[MAX_DESCRIPTORS];
+static int descriptorCount = 0;
+static uint64_t a_calls[PR_NB_REGION];
+static uint64_t a_totals[PR_NB_REGION][PROFILE_COUNTERS];
+static __thread int groupDescriptor = -2;           // -2: not opened yet, -1: refused
+static __thread int a_slots[PROFILE_COUNTERS];      // Place of each counter in a reading, -1 if missing
+
+extern bool_e Profile_start()
+{
+    enabled = TRUE;
+    groupDescriptor = openGroup(); // Tells at once whether the system lets us count
+    if (groupDescriptor < 0)
+    {
+        enabled = FALSE;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+extern void Profile_stop()
+{
+    const int count = __atomic_load_n(&descriptorCount, __ATOMIC_ACQUIRE);
+
+    enabled = FALSE;
+    for (int i = 0; i < count && i < MAX_DESCRIPTORS; i++)
+    {
+        close(a_descriptors[i]);
+    }
+    __atomic_store_n(&descriptorCount, 0, __ATOMIC_RELEASE);
+}
+
+extern void Profile_enter(ProfileMark_s *p_mark)
+{
+    p_mark->taken = (enabled == TRUE) ? readGroup(p_mark->a_values) : FALSE;
+}
+
+extern void Profile_leave(ProfileRegion_e region, const ProfileMark_s *p_mark)
+{
+    uint64_t a_values[PROFILE_COUNTERS];
+
+    if (p_mark->taken == FALSE || readGroup(a_values) == FALSE)
+    {
+        return;
+    }
+    for (int k = 0; k < PROFILE_COUNTERS; k++)
+    {
+        __atomic_fetch_add(&a_totals[region][k], a_values[k] - p_mark->a_values[k], __ATOMIC_RELAXED);
+    }
+    __atomic_fetch_add(&a_calls[region], 1, __ATOMIC_RELAXED);
+}
+
+extern int Profile_report(ProfileReport_s a_reports[])
+{
+    if (enabled == FALSE)
+    {
+        return 0;
+    }
+    for (int region = 0; region < PR_NB_REGION; region++)
+    {
+        const uint64_t calls = __atomic_load_n(&a_calls[region], __ATOMIC_RELAXED);
+        uint32_t a_means[PROFILE_COUNTERS];
+
+        for (int k = 0; k < PROFILE_COUNTERS; k++)
+        {
+            a_means[k] = (calls > 0) ? (uint32_t)(__atomic_load_n(&a_totals[region][k], __ATOMIC_RELAXED) / calls) : 0;
+        }
+        a_reports[region].region = region;
+        a_reports[region].calls = (uint32_t)calls;
+        a_reports[region].nanoseconds = a_means[0];
+        a_reports[region].cycles = a_means[1];
+        a_reports[region].instructions = a_means[2];
+        a_reports[region].cacheMisses = a_means[3];
+        a_reports[region].branchMisses = a_means[4];
+    }
+    return PR_NB_REGION;
+}
+
+extern void Profile_print()
+{
+    ProfileReport_s a_reports[PR_NB_REGION];
+    const int count = Profile_report(a_reports);
+    const uint32_t mask = __atomic_load_n(&availableMask, __ATOMIC_RELAXED);
+
+    if (count == 0)
+    {
+        return;
+    }
+    printf("%sCompteurs du processeur, moyennes par passage%s%s :%s\n", "\033[36m", (userOnly == TRUE) ? " (hors noyau)" : "",
+           ((mask & ~1u) == 0) ? ", temps seul sans compteurs matériels" : "", "\033[0m");
+    for (int i = 0; i < count; i++)
+    {
+        const ProfileReport_s *p_report = &a_reports[i];
+
+        printf("%s  %-9s : %u passages - %.2f µs", "\033[36m", a_regionNames[p_report->region], p_report->calls, p_report->nanoseconds / 1000.0);
+        if ((mask & (1u << 1)) != 0)
+        {
+            printf(" - cycles %u", p_report->cycles);
+        }
+        if ((mask & (1u << 2)) != 0)
+        {
+            printf(" - instructions %u (IPC %.2f)", p_report->instructions,
+                   (p_report->cycles > 0) ? (double)p_report->instructions / p_report->cycles : 0.0);
+        }
+        if ((mask & (1u << 3)) != 0)
+        {
+            printf(" - défauts de cache %u", p_report->cacheMisses);
+        }
+        if ((mask & (1u << 4)) != 0)
+        {
+            printf(" - mauvaises prédictions %u", p_report->branchMisses);
+        }
+        printf("%s\n", "\033[0m");
+    }
+}
+
+static int openGroup()
+{
+    const int leader = openCounter(a_types[0], a_events[0], -1);
+    int slot = 1;
+
+    if (leader < 0)
+    {
+        return -1;
+    }
+    a_slots[0] = 0;
+    __atomic_fetch_or(&availableMask, 1, __ATOMIC_RELAXED);
+    for (int k = 1; k < PROFILE_COUNTERS; k++)
+    {
+        // A counter the processor lacks leaves the others
+        a_slots[k] = (openCounter(a_types[k], a_events[k], leader) >= 0) ? slot++ : -1;
+        if (a_slots[k] >= 0)
+        {
+            __atomic_fetch_or(&availableMask, 1u << k, __ATOMIC_RELAXED);
+        }
+    }
+    return leader;
+}
+
+static int openCounter(uint32_t type, uint64_t config, int leader)
+{
+    struct perf_event_attr attributes;
+    int descriptor;
+
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.read_format = PERF_FORMAT_GROUP;
+    attributes.exclude_hv = 1;
+    attributes.exclude_kernel = (userOnly == TRUE) ? 1 : 0;
+
+    // pid 0 and cpu -1: the calling thread, on any core
+    descriptor = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0);
+    if (descriptor < 0 && userOnly == FALSE)
+    {
+        attributes.exclude_kernel = 1;
+        descriptor = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, leader, 0);
+        userOnly = (descriptor >= 0) ? TRUE : FALSE;
+    }
+    if (descriptor < 0)
+    {
+        return -1;
+    }
+
+    const int index = __atomic_fetch_add(&descriptorCount, 1, __ATOMIC_ACQ_REL);
+    if (index >= MAX_DESCRIPTORS)
+    {
+        close(descriptor); // Too many threads, this one is not counted
+        return -1;
+    }
+    a_descriptors[index] = descriptor;
+    return descriptor;
+}
+
+static bool_e readGroup(uint64_t a_values[])
+{
+    GroupReading_s reading;
+
+    if (groupDescriptor == -2)
+    {
+        groupDescriptor = openGroup();
+    }
+    if (groupDescriptor < 0 || read(groupDescriptor, &reading, sizeof(reading)) < (ssize_t)sizeof(uint64_t))
+    {
+        return FALSE;
+    }
+    for (int k = 0; k < PROFILE_COUNTERS; k++)
+    {
+        a_values[k] = (a_slots[k] >= 0 && (uint64_t)a_slots[k] < reading.count) ? reading.a_values[a_slots[k]] : 0;
+    }
+    return TRUE;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file  profile.h
+ *
+ * @brief  Counters of the processor around the hot sections of commando
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+#include "../../common.h"
+
+/**
+ * @brief Counters read together: time on a core, cycles, instructions, cache misses, branch misses
+ */
+#define PROFILE_COUNTERS (5)
+
+/**
+ * @brief Counters of the thread when it enters a section
+ */
+typedef struct
+{
+    bool_e taken; // FALSE if the counters are off or could not be read
+    uint64_t a_values[PROFILE_COUNTERS];
+} ProfileMark_s;
+
+/**
+ * @brief Turns the counters on, to be called before the threads of commando are started
+ *
+ * Each thread opens its own counters the first time it enters a section.
+ *
+ * @return bool_e FALSE if the system refuses them (perf_event_paranoid, seccomp...)
+ */
+extern bool_e Profile_start();
+
+/**
+ * @brief Closes the counters of every thread
+ */
+extern void Profile_stop();
+
+/**
+ * @brief Marks the entry into a section, a single test when the counters are off
+ *
+ * @param p_mark Where to keep the counters of the thread
+ */
+extern void Profile_enter(ProfileMark_s *p_mark);
+
+/**
+ * @brief Adds what the counters of the thread counted since Profile_enter() to a section
+ *
+ * The nested sections are counted in the outer one too.
+ *
+ * @param region The section
+ * @param p_mark Filled by Profile_enter()
+ */
+extern void Profile_leave(ProfileRegion_e region, const ProfileMark_s *p_mark);
+
+/**
+ * @brief Gives the means per pass of every section, from any thread
+ *
+ * @param a_reports Room for PR_NB_REGION reports
+ * @return int Number of reports, 0 if the counters are off
+ */
+extern int Profile_report(ProfileReport_s a_reports[]);
+
+/**
+ * @brief Displays the means per pass of every section, if the counters are on
+ */
+extern void Profile_print();
+
+#endif /* PROFILE_H */
@@ -0,0 +1,207 @@
+/**
+ * @file queue.c
+ *
+ * @see queue.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <semaphore.h>
+
+#include "queue.h"
+
+/**
+ * @brief Alignment of the cells, avoids sharing a cache line between the two ends
+ */
+#define CACHE_LINE (64)
+
+/**
+ * @brief A cell of the ring, its sequence tells whether it is free or filled
+ */
+typedef struct
+{
+    size_t sequence;
+    unsigned char item[];
+} Cell_s;
+
+struct Queue
+{
+    size_t mask;     // Capacity - 1
+    size_t itemSize; // Size of an item
+    size_t cellSize; // Size of a cell with its sequence
+    unsigned char *p_cells;
+    sem_t available; // Number of items ready to be taken
+    size_t head __attribute__((aligned(CACHE_LINE))); // Next cell to fill
+    size_t tail __attribute__((aligned(CACHE_LINE))); // Next cell to empty
+};
+
+/**
+ * @brief Gives the cell at a position of the ring
+ *
+ * @param queue The queue
+ * @param position Position (not yet masked)
+ * @return Cell_s* The cell
+ */
+static Cell_s *cellAt(const Queue_s *queue, size_t position);
+
+/**
+ * @brief Copies the first item out of the queue once the semaphore is taken, waits until it is published
+ *
+ * @param queue The queue
+ * @param item Where to copy the item
+ */
+static void take(Queue_s *queue, void *item);
+
+extern Queue_s *Queue_new(size_t capacity, size_t itemSize)
+{
+    size_t size = 2;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    Queue_s *p_queue = (Queue_s *)aligned_alloc(CACHE_LINE, sizeof(Queue_s));
+    if (p_queue == NULL)
+    {
+        return NULL;
+    }
+    p_queue->mask = size - 1;
+    p_queue->itemSize = itemSize;
+    p_queue->cellSize = (sizeof(Cell_s) + itemSize + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+    p_queue->p_cells = (unsigned char *)malloc(size * p_queue->cellSize);
+    if (p_queue->p_cells == NULL)
+    {
+        free(p_queue);
+        return NULL;
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+        cellAt(p_queue, i)->sequence = i;
+    }
+    p_queue->head = 0;
+    p_queue->tail = 0;
+    sem_init(&p_queue->available, 0, 0);
+
+    return p_queue;
+}
+
+extern void Queue_free(Queue_s *queue)
+{
+    if (queue != NULL)
+    {
+        sem_destroy(&queue->available);
+        free(queue->p_cells);
+        free(queue);
+    }
+}
+
+extern bool_e Queue_push(Queue_s *queue, const void *item)
+{
+    size_t position = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    Cell_s *p_cell;
+
+    for (;;)
+    {
+        p_cell = cellAt(queue, position);
+        const size_t sequence = __atomic_load_n(&p_cell->sequence, __ATOMIC_ACQUIRE);
+        const long difference = (long)sequence - (long)position;
+
+        if (difference == 0)
+        {
+            // The cell is free, we try to reserve it
+            if (__atomic_compare_exchange_n(&queue->head, &position, position + 1, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (difference < 0)
+        {
+            return FALSE; // Full
+        }
+        else
+        {
+            position = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(p_cell->item, item, queue->itemSize);
+    __atomic_store_n(&p_cell->sequence, position + 1, __ATOMIC_RELEASE);
+    sem_post(&queue->available);
+
+    return TRUE;
+}
+
+extern bool_e Queue_pop(Queue_s *queue, void *item)
+{
+    if (sem_trywait(&queue->available) != 0)
+    {
+        return FALSE; // Empty
+    }
+    take(queue, item);
+
+    return TRUE;
+}
+
+extern bool_e Queue_waitPop(Queue_s *queue, void *item, int timeoutMs)
+{
+    int rc;
+
+    if (timeoutMs < 0)
+    {
+        do
+        {
+            rc = sem_wait(&queue->available);
+        } while (rc != 0 && errno == EINTR);
+    }
+    else
+    {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeoutMs / 1000;
+        deadline.tv_nsec += (long)(timeoutMs % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        do
+        {
+            rc = sem_timedwait(&queue->available, &deadline);
+        } while (rc != 0 && errno == EINTR);
+    }
+
+    if (rc != 0)
+    {
+        return FALSE; // Timeout
+    }
+
+    take(queue, item);
+
+    return TRUE;
+}
+
+static Cell_s *cellAt(const Queue_s *queue, size_t position)
+{
+    return (Cell_s *)(queue->p_cells + (position & queue->mask) * queue->cellSize);
+}
+
+static void take(Queue_s *queue, void *item)
+{
+    const size_t position = queue->tail;
+    Cell_s *p_cell = cellAt(queue, position);
+
+    // Each producer posts after publishing its own cell, not the earlier ones:
+    // the one of this position may still be written by a slower producer
+    while (__atomic_load_n(&p_cell->sequence, __ATOMIC_ACQUIRE) != position + 1)
+    {
+        sched_yield();
+    }
+    memcpy(item, p_cell->item, queue->itemSize);
+    __atomic_store_n(&p_cell->sequence, position + queue->mask + 1, __ATOMIC_RELEASE);
+    queue->tail = position + 1;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file  queue.h
+ *
+ * @brief  Bounded lock-free queue linking the threads of commando
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+#include <stddef.h>
+
+#include "../../common.h"
+
+/**
+ * @brief Bounded queue of fixed-size items
+ *
+ * Any number of threads may push, a single thread pops.
+ */
+typedef struct Queue Queue_s;
+
+/**
+ * @brief Allocates a queue
+ *
+ * @param capacity Maximum number of items (rounded up to a power of two)
+ * @param itemSize Size in bytes of one item
+ * @return Queue_s* Pointer to the queue, NULL on failure
+ */
+extern Queue_s *Queue_new(size_t capacity, size_t itemSize);
+
+/**
+ * @brief Destroy the queue in memory
+ *
+ * @param queue The queue
+ */
+extern void Queue_free(Queue_s *queue);
+
+/**
+ * @brief Copies an item at the end of the queue, never blocks
+ *
+ * @param queue The queue
+ * @param item Item to copy
+ * @return TRUE if the item was queued, FALSE if the queue is full
+ */
+extern bool_e Queue_push(Queue_s *queue, const void *item);
+
+/**
+ * @brief Takes the first item of the queue, never blocks
+ *
+ * @param queue The queue
+ * @param item Where to copy the item
+ * @return TRUE if an item was taken, FALSE if the queue is empty
+ */
+extern bool_e Queue_pop(Queue_s *queue, void *item);
+
+/**
+ * @brief Takes the first item of the queue, waits for one if it is empty
+ *
+ * @param queue The queue
+ * @param item Where to copy the item
+ * @param timeoutMs Maximum waiting time in milliseconds (negative: no limit)
+ * @return TRUE if an item was taken, FALSE on timeout
+ */
+extern bool_e Queue_waitPop(Queue_s *queue, void *item, int timeoutMs);
+
+#endif /* QUEUE_H */
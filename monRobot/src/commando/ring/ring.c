@@ -0,0 +1,263 @@
+/**
+ * @file ring.c
+ *
+ * @see ring.h
+ *
+ * @author Thorkel-dev
+ */
+
+#ifdef IO_URING
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "ring.h"
+
+/**
+ * @brief Group of the provided buffers
+ */
+#define BUFFER_GROUP (0)
+
+struct Ring
+{
+    int fd;
+    // Submission queue
+    unsigned *p_sqHead;
+    unsigned *p_sqTail;
+    unsigned sqMask;
+    unsigned sqEntries;
+    unsigned *p_sqArray;
+    struct io_uring_sqe *p_sqes;
+    unsigned sqeTail;      // Next entry given by Ring_getSqe()
+    unsigned sqeSubmitted; // Entries already given to the kernel
+    // Completion queue
+    unsigned *p_cqHead;
+    unsigned *p_cqTail;
+    unsigned cqMask;
+    struct io_uring_cqe *p_cqes;
+    // Mappings
+    void *p_sqRing;
+    size_t sqRingSize;
+    void *p_cqRing;
+    size_t cqRingSize;
+    size_t sqesSize;
+    // Provided buffers
+    struct io_uring_buf_ring *p_bufferRing;
+    size_t bufferRingSize;
+    unsigned char *p_buffers;
+    unsigned bufferCount;
+    unsigned bufferSize;
+};
+
+extern Ring_s *Ring_new(unsigned entries)
+{
+    struct io_uring_params params;
+    Ring_s *p_ring = (Ring_s *)calloc(1, sizeof(Ring_s));
+
+    if (p_ring == NULL)
+    {
+        return NULL;
+    }
+    memset(&params, 0, sizeof(params));
+    p_ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (p_ring->fd < 0)
+    {
+        free(p_ring);
+        return NULL;
+    }
+
+    p_ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    p_ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (p_ring->cqRingSize > p_ring->sqRingSize)
+        {
+            p_ring->sqRingSize = p_ring->cqRingSize;
+        }
+        p_ring->cqRingSize = p_ring->sqRingSize;
+    }
+    p_ring->p_sqRing = mmap(NULL, p_ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, p_ring->fd, IORING_OFF_SQ_RING);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        p_ring->p_cqRing = p_ring->p_sqRing;
+    }
+    else
+    {
+        p_ring->p_cqRing = mmap(NULL, p_ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, p_ring->fd, IORING_OFF_CQ_RING);
+    }
+    p_ring->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    p_ring->p_sqes = (struct io_uring_sqe *)mmap(NULL, p_ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, p_ring->fd, IORING_OFF_SQES);
+    if (p_ring->p_sqRing == MAP_FAILED || p_ring->p_cqRing == MAP_FAILED || p_ring->p_sqes == MAP_FAILED)
+    {
+        close(p_ring->fd);
+        free(p_ring);
+        return NULL;
+    }
+
+    unsigned char *p_sq = (unsigned char *)p_ring->p_sqRing;
+    unsigned char *p_cq = (unsigned char *)p_ring->p_cqRing;
+    p_ring->p_sqHead = (unsigned *)(p_sq + params.sq_off.head);
+    p_ring->p_sqTail = (unsigned *)(p_sq + params.sq_off.tail);
+    p_ring->sqMask = *(unsigned *)(p_sq + params.sq_off.ring_mask);
+    p_ring->sqEntries = *(unsigned *)(p_sq + params.sq_off.ring_entries);
+    p_ring->p_sqArray = (unsigned *)(p_sq + params.sq_off.array);
+    p_ring->p_cqHead = (unsigned *)(p_cq + params.cq_off.head);
+    p_ring->p_cqTail = (unsigned *)(p_cq + params.cq_off.tail);
+    p_ring->cqMask = *(unsigned *)(p_cq + params.cq_off.ring_mask);
+    p_ring->p_cqes = (struct io_uring_cqe *)(p_cq + params.cq_off.cqes);
+    p_ring->sqeTail = *p_ring->p_sqTail;
+    p_ring->sqeSubmitted = p_ring->sqeTail;
+
+    return p_ring;
+}
+
+extern void Ring_free(Ring_s *ring)
+{
+    if (ring == NULL)
+    {
+        return;
+    }
+    if (ring->p_bufferRing != NULL)
+    {
+        munmap(ring->p_bufferRing, ring->bufferRingSize);
+        free(ring->p_buffers);
+    }
+    munmap(ring->p_sqes, ring->sqesSize);
+    if (ring->p_cqRing != ring->p_sqRing)
+    {
+        munmap(ring->p_cqRing, ring->cqRingSize);
+    }
+    munmap(ring->p_sqRing, ring->sqRingSize);
+    close(ring->fd); // Also unregisters the buffers
+    free(ring);
+}
+
+extern struct io_uring_sqe *Ring_getSqe(Ring_s *ring)
+{
+    const unsigned head = __atomic_load_n(ring->p_sqHead, __ATOMIC_ACQUIRE);
+
+    if (ring->sqeTail - head >= ring->sqEntries)
+    {
+        return NULL; // Full, submit first
+    }
+
+    const unsigned index = ring->sqeTail & ring->sqMask;
+    struct io_uring_sqe *p_sqe = &ring->p_sqes[index];
+
+    memset(p_sqe, 0, sizeof(*p_sqe));
+    ring->p_sqArray[index] = index;
+    ring->sqeTail++;
+
+    return p_sqe;
+}
+
+extern int Ring_submit(Ring_s *ring, unsigned waitCount, int timeoutMs)
+{
+    const unsigned toSubmit = ring->sqeTail - ring->sqeSubmitted;
+    unsigned flags = (waitCount > 0) ? IORING_ENTER_GETEVENTS : 0;
+    struct __kernel_timespec timeout;
+    struct io_uring_getevents_arg arg;
+    int rc;
+
+    __atomic_store_n(ring->p_sqTail, ring->sqeTail, __ATOMIC_RELEASE);
+    ring->sqeSubmitted = ring->sqeTail;
+
+    if (waitCount > 0 && timeoutMs >= 0)
+    {
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (long long)(timeoutMs % 1000) * 1000000LL;
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = (uint64_t)(uintptr_t)&timeout;
+        flags |= IORING_ENTER_EXT_ARG;
+        rc = (int)syscall(__NR_io_uring_enter, ring->fd, toSubmit, waitCount, flags, &arg, sizeof(arg));
+    }
+    else
+    {
+        rc = (int)syscall(__NR_io_uring_enter, ring->fd, toSubmit, waitCount, flags, NULL, 0);
+    }
+
+    if (rc < 0 && errno != ETIME && errno != EINTR)
+    {
+        return -errno;
+    }
+    return (rc < 0) ? 0 : rc;
+}
+
+extern struct io_uring_cqe *Ring_peek(Ring_s *ring)
+{
+    const unsigned head = *ring->p_cqHead;
+
+    if (head == __atomic_load_n(ring->p_cqTail, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
+    }
+    return &ring->p_cqes[head & ring->cqMask];
+}
+
+extern void Ring_seen(Ring_s *ring)
+{
+    __atomic_store_n(ring->p_cqHead, *ring->p_cqHead + 1, __ATOMIC_RELEASE);
+}
+
+extern bool_e Ring_provideBuffers(Ring_s *ring, unsigned count, unsigned size)
+{
+    struct io_uring_buf_reg registration;
+
+    ring->bufferRingSize = count * sizeof(struct io_uring_buf);
+    ring->p_bufferRing = (struct io_uring_buf_ring *)mmap(NULL, ring->bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ring->p_buffers = (unsigned char *)malloc((size_t)count * size);
+    if (ring->p_bufferRing == MAP_FAILED || ring->p_buffers == NULL)
+    {
+        if (ring->p_bufferRing != MAP_FAILED)
+        {
+            munmap(ring->p_bufferRing, ring->bufferRingSize);
+        }
+        free(ring->p_buffers);
+        ring->p_bufferRing = NULL;
+        return FALSE;
+    }
+    ring->bufferCount = count;
+    ring->bufferSize = size;
+
+    memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = (uint64_t)(uintptr_t)ring->p_bufferRing;
+    registration.ring_entries = count;
+    registration.bgid = BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PBUF_RING, &registration, 1) != 0)
+    {
+        munmap(ring->p_bufferRing, ring->bufferRingSize);
+        free(ring->p_buffers);
+        ring->p_bufferRing = NULL;
+        return FALSE;
+    }
+
+    ring->p_bufferRing->tail = 0;
+    for (unsigned id = 0; id < count; id++)
+    {
+        Ring_recycleBuffer(ring, id);
+    }
+
+    return TRUE;
+}
+
+extern unsigned char *Ring_getBuffer(Ring_s *ring, unsigned id)
+{
+    return ring->p_buffers + (size_t)id * ring->bufferSize;
+}
+
+extern void Ring_recycleBuffer(Ring_s *ring, unsigned id)
+{
+    const unsigned short tail = ring->p_bufferRing->tail;
+    struct io_uring_buf *p_buffer = &ring->p_bufferRing->bufs[tail & (ring->bufferCount - 1)];
+
+    p_buffer->addr = (uint64_t)(uintptr_t)Ring_getBuffer(ring, id);
+    p_buffer->len = ring->bufferSize;
+    p_buffer->bid = (unsigned short)id;
+    __atomic_store_n(&ring->p_bufferRing->tail, (unsigned short)(tail + 1), __ATOMIC_RELEASE);
+}
+
+#endif /* IO_URING */
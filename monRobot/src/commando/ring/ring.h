@@ -0,0 +1,128 @@
+/**
+ * @file  ring.h
+ *
+ * @brief  Minimal io_uring wrapper for the optional network backend
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef RING_H
+#define RING_H
+
+#ifdef IO_URING
+
+#include <stdint.h>
+#include <linux/io_uring.h>
+
+#include "../../common.h"
+
+/**
+ * @brief A submission and completion queue pair shared with the kernel
+ */
+typedef struct Ring Ring_s;
+
+/**
+ * @brief Creates a ring
+ *
+ * @param entries Number of submission entries (power of two)
+ * @return Ring_s* Pointer to the ring, NULL if io_uring is not available
+ */
+extern Ring_s *Ring_new(unsigned entries);
+
+/**
+ * @brief Destroy the ring in memory
+ *
+ * @param ring The ring
+ */
+extern void Ring_free(Ring_s *ring);
+
+/**
+ * @brief Gives a free submission entry, cleared
+ *
+ * @param ring The ring
+ * @return struct io_uring_sqe* The entry, NULL if all of them wait for submission
+ */
+extern struct io_uring_sqe *Ring_getSqe(Ring_s *ring);
+
+/**
+ * @brief Submits the prepared entries in a single system call
+ *
+ * @param ring The ring
+ * @param waitCount Completions to wait for
+ * @param timeoutMs Maximum waiting time in milliseconds (negative: no limit)
+ * @return int Number of entries submitted, negative errno on failure
+ */
+extern int Ring_submit(Ring_s *ring, unsigned waitCount, int timeoutMs);
+
+/**
+ * @brief Gives the next completion without waiting
+ *
+ * @param ring The ring
+ * @return struct io_uring_cqe* The completion, NULL if there is none
+ */
+extern struct io_uring_cqe *Ring_peek(Ring_s *ring);
+
+/**
+ * @brief Gives back the completion returned by Ring_peek()
+ *
+ * @param ring The ring
+ */
+extern void Ring_seen(Ring_s *ring);
+
+/**
+ * @brief Registers a ring of buffers the kernel picks from (group 0)
+ *
+ * @param ring The ring
+ * @param count Number of buffers (power of two)
+ * @param size Size of a buffer in bytes
+ * @return TRUE on success, FALSE if the kernel does not support it
+ */
+extern bool_e Ring_provideBuffers(Ring_s *ring, unsigned count, unsigned size);
+
+/**
+ * @brief Gives the memory of a provided buffer
+ *
+ * @param ring The ring
+ * @param id Identifier of the buffer, from the flags of the completion
+ * @return unsigned char* The buffer
+ */
+extern unsigned char *Ring_getBuffer(Ring_s *ring, unsigned id);
+
+/**
+ * @brief Gives a provided buffer back to the kernel once its data is consumed
+ *
+ * @param ring The ring
+ * @param id Identifier of the buffer
+ */
+extern void Ring_recycleBuffer(Ring_s *ring, unsigned id);
+
+#endif /* IO_URING */
+
+#endif /* RING_H */
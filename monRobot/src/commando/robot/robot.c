@@ -3,60 +3,294 @@
  *
  * @see robot.h
  *
+ * Each call into Infox waits for the simulator on the network. A worker
+ * thread makes them: the control thread posts requests to a submission
+ * queue and goes on, the worker executes what was posted meanwhile in one
+ * batch and posts a completion with its latency for each of them.
+ *
+ * At most one request of a kind waits: a newer motor command replaces the
+ * one not applied yet, a sensor reading asked again is the same one. The
+ * getters answer at once from the last commands and the last reading.
+ *
+ * When the readings are filtered, the worker oversamples the sensors on its
+ * own and the getter gives the output of the filters.
+ *
+ * Through a relay, each call is a record sent on the link and its answer:
+ * the relay merges the records of every commando into frames toward the
+ * simulator.
+ *
  * @author Thorkel-dev
  */
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include "robot.h"
 #include "../../common.h"
+#include "../queue/queue.h"
+#include "../filter/filter.h"
+#include "../profile/profile.h"
+#include "../../clock/clock.h"
+#include "../../link/link.h"
 
 #define ROBOT_CMD_STOP 0
 
+/**
+ * @brief Size of the submission queue, a request of each kind and the stop fit in it
+ */
+#define SUBMISSION_QUEUE_SIZE (8)
+
+/**
+ * @brief Size of the completion queue, emptied at each tick of the control loop
+ */
+#define COMPLETION_QUEUE_SIZE (64)
+
+/**
+ * @brief Period of the readings of the worker when the sensors are filtered (ms)
+ */
+#define SAMPLE_PERIOD (2)
+
+/**
+ * @brief Contact sensors: front and floor
+ */
+#define CONTACT_COUNT (2)
+
+/**
+ * @brief Weight of a latency in its mean, as a power of two
+ */
+#define LATENCY_SHIFT (3)
+
+/**
+ * @brief The requests to the worker, in their order of execution within a batch
+ */
+typedef enum
+{
+	HAL_SET_WHEELS = 0, // Applies the last commands of the motors
+	HAL_READ_SENSORS,	// Reads the sensors, after the motors
+	HAL_QUIT,			// Ends the worker, after the rest
+	HAL_NB_OP
+} HalOp_e;
+
+/**
+ * @brief A request of the submission queue
+ */
+typedef struct
+{
+	HalOp_e op;
+	int64_t submitted; // µs
+} HalRequest_s;
+
+/**
+ * @brief A result of the completion queue
+ */
+typedef struct
+{
+	HalOp_e op;
+	bool_e failed;
+	int64_t latency; // µs, from the submission
+} HalCompletion_s;
+
+/**
+ * @brief Posts a request, unless one of the same kind still waits
+ *
+ * @param op The request
+ * @param p_pending Flag of the waiting request of this kind
+ */
+static void post(HalOp_e op, bool_e *p_pending);
+
+/**
+ * @brief Loop of the worker
+ *
+ * @param p_arg Unused
+ * @return void* NULL
+ */
+static void *work(void *p_arg);
+
+/**
+ * @brief Executes a request in the worker and posts its completion
+ *
+ * @param p_request The request
+ */
+static void execute(const HalRequest_s *p_request);
+
+/**
+ * @brief Reads the sensors from Intox
+ *
+ * @return SensorState_s The state read, filtered
+ */
+static SensorState_s readSensors();
+
+/**
+ * @brief Reads the sensors in the worker and keeps the state for the getter
+ */
+static void sample();
+
+/**
+ * @brief Goes through the filters, if any, and merges the contacts
+ *
+ * @param luminosity Light sensor (mV)
+ * @param a_contacts The contact sensors, 0 released
+ * @return SensorState_s The state
+ */
+static SensorState_s condition(float luminosity, const int a_contacts[]);
+
+/**
+ * @brief Sends a record to the relay and waits for its answer
+ *
+ * @param p_record The request, replaced by the answer
+ * @return bool_e FALSE if the request failed or the link is broken
+ */
+static bool_e call(LinkRecord_s *p_record);
+
 static Robot_s *p_robot = 0;
-static SensorState_s sensorState;
+static SensorState_s sensorState; // Last reading, written by the worker
+static pthread_mutex_t sensorLock = PTHREAD_MUTEX_INITIALIZER;
+static bool_e stub = FALSE;
+static int a_commands[2]; // Right and left motors, as commanded
+static uint64_t packedCommands = 0; // The same for the worker, right in the upper half
+static SensorState_s stubSensors = {NO_BUMP, 0};
+static Queue_s *p_submissions = NULL;
+static Queue_s *p_completions = NULL;
+static pthread_t worker;
+static bool_e wheelsPending = FALSE;
+static bool_e readPending = FALSE;
+static HalStats_s stats;
+static FilterConfig_s filterConfig = {1, 1, 1.0f, 1};
+static FilterBank_s *p_filter = NULL; // NULL: the readings are given as they are
+static char a_simulatorHost[64] = "127.0.0.1";
+static int simulatorPort = 12345;
+static char a_relayHost[64] = "";
+static int relayPort = 0; // 0: Intox
+static LinkPeer_s relay = {-1, 0, {0}}; // Used by the worker only, once started
+
+extern void Robot_useStub()
+{
+	stub = TRUE;
+}
+
+extern void Robot_setStubSensors(Collision_e collision, float luminosity)
+{
+	stubSensors.collision = collision;
+	stubSensors.luminosity = luminosity;
+}
+
+extern void Robot_setFilter(const FilterConfig_s *p_config)
+{
+	filterConfig = *p_config;
+}
+
+extern void Robot_setSimulator(const char *host, int port)
+{
+	snprintf(a_simulatorHost, sizeof(a_simulatorHost), "%s", host);
+	simulatorPort = port;
+}
+
+extern void Robot_useRelay(const char *host, int port)
+{
+	snprintf(a_relayHost, sizeof(a_relayHost), "%s", host);
+	relayPort = port;
+}
 
 extern Robot_s *Robot_new()
 {
-	// Initialization for the use of the Intox simulator
-	if (ProSE_Intox_init("127.0.0.1", 12345) != 0)
+	if (Filter_isUsed(&filterConfig) == TRUE)
 	{
-		PProseError("Problème d'initialisation du simulateur Intox");
+		p_filter = Filter_new(1, CONTACT_COUNT, &filterConfig);
+		if (p_filter == NULL)
+		{
+			perror("Erreur lors de la création des filtres des capteurs");
+			exit(EXIT_FAILURE);
+		}
 	}
-
-	p_robot = (Robot_s *)malloc(sizeof(Robot_s));
-
-	// Initialization of the motors
-	p_robot->mD = Motor_open(RIGHT_MOTOR);
-	if (p_robot->mD == NULL)
+	if (stub == TRUE)
 	{
-		PProseError("Problème d'ouverture du moteur droit (port MD)");
+		p_robot = (Robot_s *)calloc(1, sizeof(Robot_s)); // No device, the commands stay in memory
+		return p_robot;
 	}
 
-	p_robot->mG = Motor_open(LEFT_MOTOR);
-	if (p_robot->mG == NULL)
+	if (relayPort > 0)
 	{
-		PProseError("Problème d'ouverture du moteur gauche (port MG)");
-	}
+		const int linkSocket = Link_connect(a_relayHost, relayPort);
 
-	// Initialization of the sensors
-	p_robot->sensorFront = ContactSensor_open(FRONT_BUMPER);
-	if (p_robot->sensorFront == NULL)
+		if (linkSocket < 0)
+		{
+			printf("%sRelais injoignable : %s:%d%s\n", "\033[41m", a_relayHost, relayPort, "\033[0m");
+			exit(EXIT_FAILURE);
+		}
+		Link_attach(&relay, linkSocket);
+		p_robot = (Robot_s *)calloc(1, sizeof(Robot_s)); // No device, the relay holds the robot
+	}
+	else
 	{
-		PProseError("Problème d'ouverture du capteur de contact haut");
+		// Initialization for the use of the Intox simulator
+		if (ProSE_Intox_init(a_simulatorHost, simulatorPort) != 0)
+		{
+			PProseError("Problème d'initialisation du simulateur Intox");
+		}
+
+		p_robot = (Robot_s *)malloc(sizeof(Robot_s));
+
+		// Initialization of the motors
+		p_robot->mD = Motor_open(RIGHT_MOTOR);
+		if (p_robot->mD == NULL)
+		{
+			PProseError("Problème d'ouverture du moteur droit (port MD)");
+		}
+
+		p_robot->mG = Motor_open(LEFT_MOTOR);
+		if (p_robot->mG == NULL)
+		{
+			PProseError("Problème d'ouverture du moteur gauche (port MG)");
+		}
+
+		// Initialization of the sensors
+		p_robot->sensorFront = ContactSensor_open(FRONT_BUMPER);
+		if (p_robot->sensorFront == NULL)
+		{
+			PProseError("Problème d'ouverture du capteur de contact haut");
+		}
+
+		p_robot->sensorFloor = ContactSensor_open(FLOOR_SENSOR);
+		if (p_robot->sensorFloor == NULL)
+		{
+			PProseError("Problème d'ouverture du capteur de contact avant");
+		}
+
+		p_robot->light = LightSensor_open(LIGHT_SENSOR);
+		if (p_robot->light == NULL)
+		{
+			PProseError("Problème d'ouverture du capteur de luminosité");
+		}
 	}
 
-	p_robot->sensorFloor = ContactSensor_open(FLOOR_SENSOR);
-	if (p_robot->sensorFloor == NULL)
+	// Read once before the worker, the getters never give a state not read
+	if (relayPort > 0)
 	{
-		PProseError("Problème d'ouverture du capteur de contact avant");
+		LinkRecord_s record = {LK_READ, 0, 0, 0, 0, 0, 0, 0};
+
+		call(&record);
+		a_commands[0] = record.right;
+		a_commands[1] = record.left;
 	}
+	else
+	{
+		a_commands[0] = Motor_getCmd(p_robot->mD);
+		a_commands[1] = Motor_getCmd(p_robot->mG);
+	}
+	packedCommands = ((uint64_t)(uint32_t)a_commands[0] << 32) | (uint32_t)a_commands[1];
+	sensorState = readSensors();
 
-	p_robot->light = LightSensor_open(LIGHT_SENSOR);
-	if (p_robot->light == NULL)
+	wheelsPending = FALSE;
+	readPending = FALSE;
+	p_submissions = Queue_new(SUBMISSION_QUEUE_SIZE, sizeof(HalRequest_s));
+	p_completions = Queue_new(COMPLETION_QUEUE_SIZE, sizeof(HalCompletion_s));
+	if (p_submissions == NULL || p_completions == NULL || pthread_create(&worker, NULL, &work, NULL) != 0)
 	{
-		PProseError("Problème d'ouverture du capteur de luminosité");
+		perror("Erreur lors du lancement du pilote des moteurs");
+		exit(EXIT_FAILURE);
 	}
 
 	return p_robot;
@@ -64,6 +298,37 @@ extern Robot_s *Robot_new()
 
 extern void Robot_free()
 {
+	if (stub == TRUE)
+	{
+		free(p_robot);
+		Filter_free(p_filter);
+		p_filter = NULL;
+		return;
+	}
+
+	// The requests posted before are executed first
+	const HalRequest_s quit = {HAL_QUIT, Clock_monotonic()};
+	Queue_push(p_submissions, &quit);
+	pthread_join(worker, NULL);
+	Robot_reap();
+	Queue_free(p_submissions);
+	Queue_free(p_completions);
+	p_submissions = NULL;
+	p_completions = NULL;
+
+	if (relayPort > 0)
+	{
+		if (relay.socket >= 0)
+		{
+			close(relay.socket);
+			relay.socket = -1;
+		}
+		free(p_robot);
+		Filter_free(p_filter);
+		p_filter = NULL;
+		return;
+	}
+
 	// Closing the access to the motors
 	Motor_close(p_robot->mD);
 	if (p_robot->mD != NULL)
@@ -97,6 +362,8 @@ extern void Robot_free()
 	}
 
 	free(p_robot);
+	Filter_free(p_filter);
+	p_filter = NULL;
 	ProSE_Intox_close(); // Closing the link with Intox
 }
 
@@ -106,6 +373,11 @@ extern void Robot_start()
 	Robot_setWheelsVelocity(ROBOT_CMD_STOP, ROBOT_CMD_STOP);
 }
 
+extern void Robot_resume()
+{
+	p_robot = Robot_new(); // No stop, the robot goes on during the handoff
+}
+
 extern void Robot_stop()
 {
 	Robot_setWheelsVelocity(ROBOT_CMD_STOP, ROBOT_CMD_STOP);
@@ -113,32 +385,262 @@ extern void Robot_stop()
 
 extern void Robot_setWheelsVelocity(int vr, int vl)
 {
-	if (Motor_setCmd(p_robot->mD, vr) != 0)
+	a_commands[0] = vr;
+	a_commands[1] = vl;
+	if (stub == TRUE)
 	{
-		PProseError("Problème de commande du moteur droit");
-	}
-	if (Motor_setCmd(p_robot->mG, vl) != 0)
-	{
-		PProseError("Problème de commande du moteur gauche");
+		return;
 	}
+	__atomic_store_n(&packedCommands, ((uint64_t)(uint32_t)vr << 32) | (uint32_t)vl, __ATOMIC_RELEASE);
+	post(HAL_SET_WHEELS, &wheelsPending);
+}
+
+extern void Robot_getWheelsVelocity(int *vr, int *vl)
+{
+	*vr = a_commands[0];
+	*vl = a_commands[1];
 }
 
 extern int Robot_getRobotSpeed()
 {
-	return (Motor_getCmd(p_robot->mG) + Motor_getCmd(p_robot->mD)) / 2;
+	return (a_commands[1] + a_commands[0]) / 2;
 }
 
 extern SensorState_s Robot_getSensorState()
 {
-	sensorState.luminosity = LightSensor_getStatus(p_robot->light);
-	if (ContactSensor_getStatus(p_robot->sensorFloor) == RELEASED && ContactSensor_getStatus(p_robot->sensorFront) == RELEASED)
+	SensorState_s state;
+	ProfileMark_s mark;
+
+	Profile_enter(&mark);
+	if (stub == TRUE)
 	{
-		sensorState.collision = NO_BUMP;
+		const int a_contacts[CONTACT_COUNT] = {stubSensors.collision, stubSensors.collision};
+
+		state = condition(stubSensors.luminosity, a_contacts); // A sample per call
+		Profile_leave(PR_SENSORS, &mark);
+		return state;
 	}
-	else
+	if (p_filter == NULL)
+	{
+		post(HAL_READ_SENSORS, &readPending); // Otherwise the worker reads them on its own
+	}
+	pthread_mutex_lock(&sensorLock);
+	state = sensorState;
+	pthread_mutex_unlock(&sensorLock);
+	Profile_leave(PR_SENSORS, &mark);
+
+	return state;
+}
+
+extern void Robot_reap()
+{
+	HalCompletion_s completion;
+
+	while (p_completions != NULL && Queue_pop(p_completions, &completion) == TRUE)
+	{
+		const int64_t mean = __atomic_load_n(&stats.meanLatency, __ATOMIC_RELAXED);
+
+		if (completion.failed == TRUE)
+		{
+			__atomic_fetch_add(&stats.failures, 1, __ATOMIC_RELAXED);
+		}
+		__atomic_store_n(&stats.meanLatency, mean + ((completion.latency - mean) >> LATENCY_SHIFT), __ATOMIC_RELAXED);
+		if (completion.latency > __atomic_load_n(&stats.maxLatency, __ATOMIC_RELAXED))
+		{
+			__atomic_store_n(&stats.maxLatency, completion.latency, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+extern HalStats_s Robot_getHalStats()
+{
+	HalStats_s copy;
+
+	copy.submitted = __atomic_load_n(&stats.submitted, __ATOMIC_RELAXED);
+	copy.coalesced = __atomic_load_n(&stats.coalesced, __ATOMIC_RELAXED);
+	copy.batches = __atomic_load_n(&stats.batches, __ATOMIC_RELAXED);
+	copy.failures = __atomic_load_n(&stats.failures, __ATOMIC_RELAXED);
+	copy.meanLatency = __atomic_load_n(&stats.meanLatency, __ATOMIC_RELAXED);
+	copy.maxLatency = __atomic_load_n(&stats.maxLatency, __ATOMIC_RELAXED);
+
+	return copy;
+}
+
+static void post(HalOp_e op, bool_e *p_pending)
+{
+	const HalRequest_s request = {op, Clock_monotonic()};
+
+	if (__atomic_exchange_n(p_pending, TRUE, __ATOMIC_ACQ_REL) == TRUE)
+	{
+		__atomic_fetch_add(&stats.coalesced, 1, __ATOMIC_RELAXED); // The worker will take the last values
+		return;
+	}
+	__atomic_fetch_add(&stats.submitted, 1, __ATOMIC_RELAXED);
+	Queue_push(p_submissions, &request); // Never full, a single request of each kind waits
+}
+
+static void *work(void *p_arg)
+{
+	bool_e running = TRUE;
+	int64_t nextSample = Clock_monotonic();
+
+	while (running == TRUE)
+	{
+		HalRequest_s a_batch[SUBMISSION_QUEUE_SIZE];
+		int count = 0;
+		const int64_t left = nextSample - Clock_monotonic();
+		const int timeout = (p_filter == NULL) ? -1 : (left > 0) ? (int)(left / 1000) : 0;
+
+		// Everything posted while the previous batch ran is taken at once
+		if (Queue_waitPop(p_submissions, &a_batch[count], timeout) == TRUE)
+		{
+			count++;
+			__atomic_fetch_add(&stats.batches, 1, __ATOMIC_RELAXED);
+		}
+		while (count > 0 && count < SUBMISSION_QUEUE_SIZE && Queue_pop(p_submissions, &a_batch[count]) == TRUE)
+		{
+			count++;
+		}
+
+		for (HalOp_e op = 0; op < HAL_NB_OP; op++)
+		{
+			for (int i = 0; i < count; i++)
+			{
+				if (a_batch[i].op == op)
+				{
+					execute(&a_batch[i]);
+					running = (op == HAL_QUIT) ? FALSE : running;
+				}
+			}
+		}
+
+		// Oversampling, whatever the requests
+		if (p_filter != NULL && Clock_monotonic() >= nextSample)
+		{
+			sample();
+			nextSample += SAMPLE_PERIOD * 1000;
+			nextSample = (nextSample < Clock_monotonic()) ? Clock_monotonic() + SAMPLE_PERIOD * 1000 : nextSample; // Late, no burst
+		}
+	}
+
+	return NULL;
+}
+
+static void execute(const HalRequest_s *p_request)
+{
+	HalCompletion_s completion = {p_request->op, FALSE, 0};
+
+	switch (p_request->op)
+	{
+	case HAL_SET_WHEELS:
+	{
+		// Cleared before the commands are taken: a newer command posts a new request
+		__atomic_store_n(&wheelsPending, FALSE, __ATOMIC_SEQ_CST);
+		const uint64_t commands = __atomic_load_n(&packedCommands, __ATOMIC_SEQ_CST);
+
+		if (relayPort > 0)
+		{
+			LinkRecord_s record = {LK_SET_WHEELS, 0, 0, 0, (int32_t)(commands >> 32), (int32_t)(commands & 0xFFFFFFFF), 0, 0};
+
+			completion.failed = (call(&record) == TRUE) ? FALSE : TRUE;
+			break;
+		}
+		if (Motor_setCmd(p_robot->mD, (int32_t)(commands >> 32)) != 0)
+		{
+			PProseError("Problème de commande du moteur droit");
+			completion.failed = TRUE;
+		}
+		if (Motor_setCmd(p_robot->mG, (int32_t)(commands & 0xFFFFFFFF)) != 0)
+		{
+			PProseError("Problème de commande du moteur gauche");
+			completion.failed = TRUE;
+		}
+		break;
+	}
+	case HAL_READ_SENSORS:
 	{
-		sensorState.collision = BUMPED;
+		__atomic_store_n(&readPending, FALSE, __ATOMIC_SEQ_CST);
+		sample();
+		break;
 	}
+	default:
+		break;
+	}
+
+	completion.latency = Clock_monotonic() - p_request->submitted;
+	Queue_push(p_completions, &completion); // If the control thread is late, the latency is lost
+}
+
+static SensorState_s readSensors()
+{
+	if (relayPort > 0)
+	{
+		LinkRecord_s record = {LK_READ, 0, 0, 0, 0, 0, 0, 0};
 
-	return sensorState;
-}
\ No newline at end of file
+		if (call(&record) == FALSE)
+		{
+			return sensorState; // Only the worker writes it, the last reading stays
+		}
+
+		const int a_linkContacts[CONTACT_COUNT] = {(record.contacts & 1) != 0, (record.contacts & 2) != 0};
+		return condition(record.luminosity / 1000.0f, a_linkContacts);
+	}
+
+	const float luminosity = LightSensor_getStatus(p_robot->light);
+	const int a_contacts[CONTACT_COUNT] = {ContactSensor_getStatus(p_robot->sensorFront) != RELEASED,
+										   ContactSensor_getStatus(p_robot->sensorFloor) != RELEASED};
+
+	return condition(luminosity, a_contacts);
+}
+
+static void sample()
+{
+	const SensorState_s state = readSensors();
+
+	pthread_mutex_lock(&sensorLock);
+	sensorState = state;
+	pthread_mutex_unlock(&sensorLock);
+}
+
+static SensorState_s condition(float luminosity, const int a_contacts[])
+{
+	SensorState_s state = {NO_BUMP, luminosity};
+	int a_states[CONTACT_COUNT] = {a_contacts[0], a_contacts[1]};
+
+	if (p_filter != NULL)
+	{
+		Filter_push(p_filter, &luminosity, a_contacts);
+		Filter_get(p_filter, &state.luminosity, a_states);
+	}
+	state.collision = (a_states[0] != 0 || a_states[1] != 0) ? BUMPED : NO_BUMP;
+
+	return state;
+}
+
+static bool_e call(LinkRecord_s *p_record)
+{
+	LinkRecord_s answer;
+	int count = 0;
+
+	if (relay.socket < 0)
+	{
+		return FALSE;
+	}
+	if (Link_send(relay.socket, p_record, 1) == TRUE)
+	{
+		// A single request at a time: the next frame is its answer
+		while ((count = Link_next(&relay, &answer, 1)) == 0 && Link_read(&relay) == TRUE)
+		{
+		}
+	}
+	if (count != 1)
+	{
+		printf("%sLiaison avec le relais perdue%s\n", "\033[41m", "\033[0m"); // Once, the socket is closed
+		close(relay.socket);
+		relay.socket = -1;
+		return FALSE;
+	}
+	*p_record = answer;
+
+	return (answer.status == 0) ? TRUE : FALSE;
+}
@@ -35,7 +35,10 @@
 #ifndef ROBOT_H
 #define ROBOT_H
 
+#include <stdint.h>
+
 #include "prose.h"
+#include "../filter/filter.h"
 
 // Motor and sensor pins
 #define LEFT_MOTOR MD
@@ -74,6 +77,59 @@ typedef struct
 	float luminosity;
 } SensorState_s;
 
+/**
+ * @brief Activity of the worker calling Intox, the latencies go from the submission to the end of the call
+ */
+typedef struct
+{
+	unsigned long submitted; // Requests posted
+	unsigned long coalesced; // Requests merged into one still waiting
+	unsigned long batches;	 // Wake-ups of the worker
+	unsigned long failures;	 // Calls refused by Intox or the relay
+	int64_t meanLatency;	 // µs
+	int64_t maxLatency;		 // µs
+} HalStats_s;
+
+/**
+ * @brief Replaces Intox by a robot in memory, to be called before Robot_new()
+ *
+ * The motors keep their commands, the sensors give what Robot_setStubSensors() set.
+ */
+extern void Robot_useStub();
+
+/**
+ * @brief Sets the sensors of the robot in memory
+ *
+ * @param collision State of the contact sensors
+ * @param luminosity Light sensor (mV)
+ */
+extern void Robot_setStubSensors(Collision_e collision, float luminosity);
+
+/**
+ * @brief Sets the filters of the sensors, to be called before Robot_new()
+ *
+ * @param p_config The settings, the readings are given as they are by default
+ */
+extern void Robot_setFilter(const FilterConfig_s *p_config);
+
+/**
+ * @brief Sets where Intox listens, to be called before Robot_new()
+ *
+ * @param host Name or address (127.0.0.1 by default)
+ * @param port Port (12345 by default)
+ */
+extern void Robot_setSimulator(const char *host, int port);
+
+/**
+ * @brief Reaches the simulator through a relay instead of Intox, to be called before Robot_new()
+ *
+ * The relay merges the requests of the commandos connected to it in frames toward a single simulator.
+ *
+ * @param host Name or address of the relay
+ * @param port Port of the relay
+ */
+extern void Robot_useRelay(const char *host, int port);
+
 /**
  * @brief Initializes the robot and the connection
  *
@@ -91,6 +147,11 @@ extern void Robot_free();
  */
 extern void Robot_start();
 
+/**
+ * @brief Takes over a robot released by another commando, the motors keep their commands
+ */
+extern void Robot_resume();
+
 /**
  * @brief Stopping robot (motor speeds at zero)
  */
@@ -104,6 +165,14 @@ extern void Robot_stop();
  */
 extern void Robot_setWheelsVelocity(int vr, int vl);
 
+/**
+ * @brief Gives the commands applied to the motors
+ *
+ * @param vr Where to write the right motor speed
+ * @param vl Where to write the left motor speed
+ */
+extern void Robot_getWheelsVelocity(int *vr, int *vl);
+
 /**
  * @brief Returns the robot speed (positive average of the motors speed)
  *
@@ -114,8 +183,22 @@ extern int Robot_getRobotSpeed();
 /**
  * @brief Returns the status of the sensors
  *
+ * The last state read by the worker is given at once, a new reading is asked for.
+ *
  * @return SensorState sensor status
  */
 extern SensorState_s Robot_getSensorState();
 
+/**
+ * @brief Takes the completions of the worker and keeps their latencies, from the control thread
+ */
+extern void Robot_reap();
+
+/**
+ * @brief Gives the activity of the worker, from any thread
+ *
+ * @return HalStats_s A copy of the counters
+ */
+extern HalStats_s Robot_getHalStats();
+
 #endif /* ROBOT_H */
@@ -35,6 +35,36 @@
 #ifndef _SERVER_
 #define _SERVER_
 
+#include "../../common.h"
+
+/**
+ * @brief Chooses the number of event loops, to be called before Server_new()
+ *
+ * Each event loop has its own listening socket on the same port (SO_REUSEPORT)
+ * and its own clients. The orders of all the loops go to the single pilot.
+ *
+ * @param count Number of event loops (0 or less: one per core)
+ */
+extern void Server_setShardCount(int count);
+
+/**
+ * @brief Chooses the io_uring event loops instead of select(), to be called before Server_start()
+ *
+ * The event loops fall back on select() if the kernel does not support io_uring.
+ *
+ * @return FALSE if commando was built without IO_URING, otherwise TRUE
+ */
+extern bool_e Server_useRing();
+
+/**
+ * @brief Takes over from the running commando instead of starting afresh, to be called before Server_new()
+ *
+ * The running commando hands over its listening sockets, its clients and the state
+ * of the pilot through HANDOFF_PATH, then ends: the robot and the clients go on
+ * without noticing. It refuses while a mission or a goal is running.
+ */
+extern void Server_resume();
+
 /**
  * @brief Initializes the server and the connection
  */
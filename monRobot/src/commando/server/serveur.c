@@ -12,212 +12,1064 @@
 #include <errno.h>
 #include <string.h>
 #include <netdb.h>
+#include <time.h>
+#include <sched.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stddef.h>
 #include <sys/types.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
 
 #include "../../common.h"
-#include "../pilot/pilot.h"
+#include "../control/control.h"
+#include "../robot/robot.h"
+#include "../telemetry/telemetry.h"
+#include "../ring/ring.h"
+#include "../handoff/handoff.h"
+#include "../profile/profile.h"
+#include "../../codec/codec.h"
+#include "../../clock/clock.h"
 #include "server.h"
 
-#define MAX_PENDING (1)
-#define MAX_CONNECTION_ATTEMPT (60)
+#define MAX_PENDING (16)
 
 /**
- * @brief Default speed of the robot
+ * @brief Maximum number of event loops
  */
-#define POWER (100)
+#define MAX_SHARDS (64)
 
 /**
- * @brief Returns the status of the pilot to the client
+ * @brief Maximum number of clients served by one event loop
+ */
+#define MAX_CLIENTS (32)
+
+/**
+ * @brief Time without any activity before the server stops (seconds)
+ */
+#define INACTIVITY_TIMEOUT (60)
+
+/**
+ * @brief Time between two checks of the end of the server by an event loop (seconds)
+ */
+#define POLL_PERIOD (1)
+
+/**
+ * @brief Bytes read from a client at once
+ */
+#define READ_SIZE (512)
+
+/**
+ * @brief Orders per second allowed to a client, in the long run
+ */
+#define ORDER_RATE (50)
+
+/**
+ * @brief Orders a client may send at once
+ */
+#define ORDER_BURST (25)
+
+/**
+ * @brief Identifies the records of a handoff, changed with their layout
+ */
+#define HANDOFF_MAGIC "COMMANDO"
+#define HANDOFF_VERSION (1)
+
+/**
+ * @brief Longest wait for a record of the running commando (ms)
+ */
+#define HANDOFF_TIMEOUT (5000)
+
+/**
+ * @brief Last record of each side, the running commando lets go only once both are exchanged
+ */
+#define HANDOFF_DONE (0x444F4E45)
+
+#ifdef IO_URING
+/**
+ * @brief Entries of the submission queue of an event loop
+ */
+#define RING_ENTRIES (256)
+
+/**
+ * @brief Number and size of the buffers the kernel fills with the received bytes
+ */
+#define RING_BUFFER_COUNT (256)
+#define RING_BUFFER_SIZE (2048)
+
+/**
+ * @brief Bits of the generation of a connection kept with its requests, beside the event and the socket
+ */
+#define RING_GENERATION_MASK (0xFFFFFFu)
+
+/**
+ * @brief What a completion of the ring is about
+ */
+typedef enum
+{
+    EV_ACCEPT = 1,
+    EV_RECV,
+    EV_TERMINAL,
+    EV_HANDOFF,
+    EV_CANCEL
+} RingEvent_e;
+#endif
+
+/**
+ * @brief A client connection and the frame it is sending
+ */
+typedef struct
+{
+    int socket;
+    uint32_t generation;   // Given by Telemetry_attach(), tells the connection from the later ones on the same socket
+    unsigned char buffer[sizeof(Data_s) + MAX_PAYLOAD];
+    size_t filled;         // Bytes of the frame already received
+    size_t expected;       // Bytes of the frame with its payload, once the header is known
+    bool_e observer;       // Receives the telemetry, cannot drive
+    double tokens;         // Orders the client may still send (token bucket)
+    long lastRefill;       // Last time the bucket was filled (ms)
+    Direction_e direction; // Last direction asked
+} Connection_s;
+
+/**
+ * @brief An event loop with its own listening socket and its own clients
+ */
+typedef struct
+{
+    int id;
+    int socket_ecoute;
+    Connection_s a_connections[MAX_CLIENTS];
+    int connectionCount;
+    pthread_t thread;
+} Shard_s;
+
+/**
+ * @brief First record of a handoff, the answer of the running commando
  *
- * @param pilot Status of the pilot
+ * The listening sockets follow, one record each with the socket, then the client
+ * connections, one HandoffConnection_s each with the socket.
  */
-static void sendMsg(PilotState_s pilot);
+typedef struct
+{
+    char magic[8];
+    int version;
+    int accepted;       // FALSE while a mission or a goal is running
+    int snapshotSize;   // sizeof(ControlSnapshot_s), both programs must agree
+    int connectionSize; // sizeof(HandoffConnection_s)
+    int shardCount;
+    int connectionCount;
+    ControlSnapshot_s control;
+} HandoffHeader_s;
 
 /**
- * @brief Read messages received from the client
+ * @brief A client connection handed over, only the bytes received are sent
  */
-static void readMsg();
+typedef struct
+{
+    int shard;
+    int observer;
+    int direction;
+    double tokens;
+    int filled;
+    int expected;
+    unsigned char buffer[sizeof(Data_s) + MAX_PAYLOAD];
+} HandoffConnection_s;
 
-static int socket_ecoute;
-static int socket_donnees;
-static struct sockaddr_in adresse;
+/**
+ * @brief Read messages received from a client
+ *
+ * @param connection The client connection
+ * @return FALSE if the client is disconnected, otherwise TRUE
+ */
+static bool_e readMsg(Connection_s *connection);
+
+/**
+ * @brief Splits the bytes received from a client into frames
+ *
+ * @param connection The client connection
+ * @param bytes Bytes received
+ * @param length Number of bytes
+ * @return FALSE if the client does not respect the protocol, otherwise TRUE
+ */
+static bool_e receive(Connection_s *connection, const unsigned char *bytes, size_t length);
+
+/**
+ * @brief Handles a complete frame received from a client
+ *
+ * An order outside Order_e is dropped. O_STOP stops the robot and ends the
+ * session of its sender only, the other clients go on.
+ *
+ * @param connection The client connection
+ * @param data The frame, in host byte order
+ * @param payload The payload of the frame, in network byte order
+ * @return FALSE if the session of the client ends, otherwise TRUE
+ */
+static bool_e handleFrame(Connection_s *connection, Data_s data, const unsigned char *payload);
+
+/**
+ * @brief Decides whether an order of a client goes to the pilot
+ *
+ * The state requests are shed when the client exceeds its rate, and so are the
+ * repeated directions. A change of direction or a stop always goes through.
+ *
+ * @param connection The client connection
+ * @param data The order
+ * @return TRUE if the order must be given to the pilot, otherwise FALSE
+ */
+static bool_e admit(Connection_s *connection, const Data_s *data);
+
+/**
+ * @brief Displays the counters of the shed work
+ */
+static void printStats();
+
+/**
+ * @brief Asks the first event loop to display the counters (SIGUSR1)
+ *
+ * @param signal Not used
+ */
+static void onStatsSignal(int signal);
+
+/**
+ * @brief Accepts a new client on the listening socket of the event loop
+ *
+ * @param shard The event loop
+ */
+static void acceptClient(Shard_s *shard);
+
+/**
+ * @brief Adds an accepted client to the event loop
+ *
+ * @param shard The event loop
+ * @param socket_donnees Connection of the client
+ * @return TRUE if the client is kept, FALSE if it was refused and closed
+ */
+static bool_e addClient(Shard_s *shard, int socket_donnees);
+
+/**
+ * @brief Closes a client connection and forgets it
+ *
+ * @param shard The event loop
+ * @param index Index of the connection in the event loop
+ */
+static void closeClient(Shard_s *shard, int index);
+
+/**
+ * @brief Runs the event loops until the end of the server or a handoff
+ */
+static void serve();
 
 /**
- * @brief Convert the direction chosen by the user into a velocity vector
+ * @brief Accepts a replacing commando, the event loops stop for the handoff
+ */
+static void acceptHandoff();
+
+/**
+ * @brief Gives the robot, the listening sockets and the clients to the replacing commando
+ *
+ * @return FALSE if the pilot refused (mission or goal running), the server goes on
+ */
+static bool_e handOff();
+
+/**
+ * @brief Takes over the robot, the listening sockets and the clients of the running commando
+ */
+static void takeOver();
+
+/**
+ * @brief Pins a thread on a core
+ *
+ * @param thread The thread
+ * @param core Index of the core (modulo the number of cores)
+ */
+static void pinToCore(pthread_t thread, int core);
+
+/**
+ * @brief Body of the threads of the secondary event loops
+ *
+ * @param arg The event loop
+ * @return void* Not used
+ */
+static void *runShard(void *arg);
+
+/**
+ * @brief Copies a payload in host byte order, for the control thread
  *
- * @param direction The direction in which the robot should go
- * @return VelocityVector_s corresponds to the direction and speed where to go
+ * @param payload The payload, in network byte order
+ * @param size Bytes of payload
+ * @return int32_t* The copy (to be freed by its user), NULL if there is no payload
  */
-static VelocityVector_s translate(const Direction_e direction);
+static int32_t *convertPayloadReception(const unsigned char *payload, int size);
 
 /**
- * @brief Convert data to Byte order for host
+ * @brief Allows an event loop to run after the server is launched
  *
- * @param order The type of order
- * @param direction The direction in which the robot should go.
- * @param speed The speed
- * @param collision Collision sensor status
- * @param luminosity The luminosity measured
+ * @param shard The event loop
+ */
+static void run(Shard_s *shard);
+
+/**
+ * @brief Event loop based on select()
  *
- * @return Data_s convert data to Byte order
+ * @param shard The event loop
  */
-static Data_s convertDataReception(const Order_e order, const Direction_e direction, const int speed, const bool_e collision, const int luminosity);
+static void runSelect(Shard_s *shard);
 
 /**
- * @brief Convert data to Byte order for network
+ * @brief Work of the first event loop between two waits: counters and inactivity
  *
- * @param order The type of order
- * @param direction The direction in which the robot should go.
- * @param speed The speed
- * @param collision Collision sensor status
- * @param luminosity The luminosity measured
+ * @param shard The event loop
+ * @param idle TRUE if nothing happened during the wait
+ */
+static void watch(const Shard_s *shard, bool_e idle);
+
+#ifdef IO_URING
+/**
+ * @brief Event loop based on io_uring
  *
- * @return Data_s convert data to Byte order
+ * @param shard The event loop
+ * @return FALSE if io_uring is not available, otherwise TRUE
  */
-static Data_s convertDataSend(const Order_e order, const Direction_e direction, const int speed, const bool_e collision, const int luminosity);
+static bool_e runRing(Shard_s *shard);
 
 /**
- * @brief Allows the server to run after it is launched
+ * @brief Queues a multishot accept, a multishot receive or a poll of the terminal
+ *
+ * The completions carry the event, the descriptor and the generation of the connection.
+ *
+ * @param ring The ring of the event loop
+ * @param event What to wait for
+ * @param socket The descriptor
+ * @param generation Generation of the connection received, 0 for the other events
+ */
+static void armRing(Ring_s *ring, RingEvent_e event, int socket, uint32_t generation);
+
+/**
+ * @brief Finds the client a completion is meant for
+ *
+ * @param shard The event loop
+ * @param userData What the request was armed with
+ * @return int Index of the connection, -1 if it is not known or closed since
  */
-static void run();
+static int findClient(const Shard_s *shard, uint64_t userData);
 
+/**
+ * @brief Cancels the receives of the ring and keeps the bytes already received
+ *
+ * @param shard The event loop
+ * @param ring The ring of the event loop
+ */
+static void drainRing(Shard_s *shard, Ring_s *ring);
+#endif
+
+static Shard_s a_shards[MAX_SHARDS];
+static int shardCount = 1;
+static struct sockaddr_in adresse;
 static bool_e work;
-static VelocityVector_s vectorDefault = {D_STOP, 0};
+static bool_e threadsStarted = FALSE;
+#ifdef IO_URING
+static bool_e useRing = FALSE;
+#endif
+static time_t lastActivity; // Last connection or frame received, all event loops
+static unsigned long ordersShed = 0;    // Orders over the rate of the client
+static unsigned long ordersRefused = 0; // Movements asked by an observer
+static unsigned long ordersLost = 0;    // Orders lost, the pilot was saturated
+static volatile sig_atomic_t statsRequested = 0;
+static bool_e resuming = FALSE;       // Takes over a running commando
+static ControlSnapshot_s snapshot;    // Pilot received from the running commando
+static int handoffListener = -1;      // Where a replacing commando connects
+static int handoffSocket = -1;        // The replacing commando, during a handoff
+static bool_e handedOver = FALSE;
 
-extern void Server_new()
+extern void Server_setShardCount(int count)
 {
-    TRACE("The server is created\n");
-    socket_ecoute = socket(AF_INET, SOCK_STREAM, 0);
-    if (socket_ecoute == -1)
+    if (count <= 0)
     {
-        perror("Erreur dans la création du socket");
-        exit(socket_ecoute);
+        count = (int)sysconf(_SC_NPROCESSORS_ONLN);
     }
+    shardCount = (count > MAX_SHARDS) ? MAX_SHARDS : count;
+}
+
+extern bool_e Server_useRing()
+{
+#ifdef IO_URING
+    useRing = TRUE;
+    Telemetry_useRing();
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+extern void Server_resume()
+{
+    resuming = TRUE;
+}
+
+extern void Server_new()
+{
+    const int enable = 1;
+
+    TRACE("The server is created\n");
     adresse.sin_family = AF_INET;
     adresse.sin_port = htons(PORT_SERVER);
     adresse.sin_addr.s_addr = htonl(INADDR_ANY);
-    Pilot_new();
+
+    Telemetry_new();
+    Control_new();
+    if (resuming == TRUE)
+    {
+        takeOver();
+        return;
+    }
+    for (int i = 0; i < shardCount; i++)
+    {
+        Shard_s *p_shard = &a_shards[i];
+
+        p_shard->id = i;
+        p_shard->connectionCount = 0;
+        p_shard->socket_ecoute = socket(AF_INET, SOCK_STREAM, 0);
+        if (p_shard->socket_ecoute == -1)
+        {
+            perror("Erreur dans la création du socket");
+            exit(p_shard->socket_ecoute);
+        }
+        // The kernel spreads the connections between the event loops
+        if (setsockopt(p_shard->socket_ecoute, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) != 0)
+        {
+            perror("Erreur lors du partage du port");
+        }
+    }
 }
 
 extern void Server_start()
 {
-    printf("%sLe serveur est sur le port %d à l'adresse %s%s\n\n", "\033[32m", PORT_SERVER, IP_SERVER, "\033[0m");
-    bind(socket_ecoute, (struct sockaddr *)&adresse, sizeof(adresse));
+    printf("%sLe serveur est sur le port %d à l'adresse %s (%d boucle(s))%s\n\n", "\033[32m", PORT_SERVER, IP_SERVER, shardCount, "\033[0m");
 
-    if (listen(socket_ecoute, MAX_PENDING) != 0)
+    for (int i = 0; i < shardCount && resuming == FALSE; i++)
     {
-        printf("%sErreur durant l'écoute du port%s\n", "\033[41m", "\033[0m");
-        Server_stop();
-        return;
+        bind(a_shards[i].socket_ecoute, (struct sockaddr *)&adresse, sizeof(adresse));
+        if (listen(a_shards[i].socket_ecoute, MAX_PENDING) != 0)
+        {
+            printf("%sErreur durant l'écoute du port%s\n", "\033[41m", "\033[0m");
+            Server_stop();
+            return;
+        }
     }
-    Pilot_start();
-    work = TRUE;
-    run();
+    Telemetry_start();
+    if (resuming == TRUE)
+    {
+        for (int i = 0; i < shardCount; i++)
+        {
+            for (int j = 0; j < a_shards[i].connectionCount; j++)
+            {
+                Connection_s *p_connection = &a_shards[i].a_connections[j];
+
+                p_connection->generation = Telemetry_attach(p_connection->socket);
+                if (p_connection->observer == TRUE)
+                {
+                    Telemetry_observe(p_connection->socket, p_connection->generation);
+                }
+            }
+        }
+        Control_resume(&snapshot); // The robot goes on as it was
+    }
+    else
+    {
+        Control_start(); // The pilot runs in its own thread, away from the sockets
+    }
+    threadsStarted = TRUE;
+    handoffListener = Handoff_listen();
+    if (handoffListener < 0)
+    {
+        perror("Relève impossible");
+    }
+
+    struct sigaction action = {0};
+    action.sa_handler = &onStatsSignal;
+    sigaction(SIGUSR1, &action, NULL);
+
+    do
+    {
+        serve();
+    } while (handoffSocket >= 0 && handOff() == FALSE);
 }
 
 extern void Server_stop()
 {
+    if (handedOver == TRUE)
+    {
+        Control_stop(); // Nothing left to stop, the robot is driven by the other commando
+        for (int i = 0; i < shardCount; i++)
+        {
+            // The other commando holds its own copies of the sockets
+            for (int j = 0; j < a_shards[i].connectionCount; j++)
+            {
+                close(a_shards[i].a_connections[j].socket);
+            }
+            a_shards[i].connectionCount = 0;
+            close(a_shards[i].socket_ecoute);
+            a_shards[i].socket_ecoute = -1;
+        }
+        threadsStarted = FALSE;
+        printStats();
+        printf("%sLe service est repris par le nouveau commando%s\n", "\033[32m", "\033[0m");
+        return;
+    }
+    if (handoffListener >= 0)
+    {
+        Handoff_close(handoffListener);
+        handoffListener = -1;
+    }
+    if (threadsStarted == TRUE)
+    {
+        // The pilot first, its last states can still be sent
+        Control_stop();
+    }
+    for (int i = 0; i < shardCount; i++)
+    {
+        while (a_shards[i].connectionCount > 0)
+        {
+            closeClient(&a_shards[i], 0);
+        }
+        if (a_shards[i].socket_ecoute >= 0)
+        {
+            close(a_shards[i].socket_ecoute);
+            a_shards[i].socket_ecoute = -1;
+        }
+    }
+    if (threadsStarted == TRUE)
+    {
+        Telemetry_stop(); // Closes the client connections
+        threadsStarted = FALSE;
+        printStats();
+    }
     printf("%sLe serveur est arrêté%s\n", "\033[31m", "\033[0m");
-    close(socket_ecoute);
 }
 
-static void sendMsg(const PilotState_s pilot)
+static void serve()
 {
-    Data_s data = convertDataSend(0, 0, pilot.speed, pilot.collision, pilot.luminosity);
-    int quantityWritten = 0;
-    int quantityToWrite = sizeof(data);
+    work = TRUE;
+    lastActivity = (time_t)(Clock_monotonic() / 1000000);
+    handoffSocket = -1;
+
+    for (int i = 1; i < shardCount; i++)
+    {
+        if (pthread_create(&a_shards[i].thread, NULL, &runShard, &a_shards[i]) != 0)
+        {
+            printf("%sErreur lors du lancement de la boucle %d%s\n", "\033[41m", i, "\033[0m");
+            shardCount = i;
+            break;
+        }
+        pinToCore(a_shards[i].thread, i);
+    }
+    if (shardCount > 1)
+    {
+        pinToCore(pthread_self(), 0);
+    }
+    run(&a_shards[0]); // The first event loop is the main thread
 
-    quantityWritten = write(socket_donnees, &data + quantityWritten, quantityToWrite);
+    __atomic_store_n(&work, FALSE, __ATOMIC_RELAXED);
+    for (int i = 1; i < shardCount; i++)
+    {
+        pthread_join(a_shards[i].thread, NULL);
+    }
+}
 
-    if (quantityWritten < 0)
+static void acceptHandoff()
+{
+    handoffSocket = Handoff_accept(handoffListener);
+    if (handoffSocket >= 0)
     {
-        printf("%sErreur lors de l'envoi du message%s\n", "\033[41m", "\033[0m");
+        printf("%sUn nouveau commando demande la relève%s\n", "\033[33m", "\033[0m");
+        __atomic_store_n(&work, FALSE, __ATOMIC_RELAXED); // The bytes not read yet stay in the sockets
     }
-    TRACE("Send data:\tDirection: %d - Event: %d - Speed: %d - Collision: %d - Luminosity: %d\n", data.direction, data.order, data.speed, data.collision, data.luminosity);
 }
 
-static void readMsg()
+static bool_e handOff()
 {
-    Data_s data = {0, 0, 0, 0, 0};
-    int quantityToRead = sizeof(Data_s);
-    int quantityReaddean = 0;
+    HandoffHeader_s header;
+    HandoffConnection_s record;
+    bool_e sent;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HANDOFF_MAGIC, sizeof(header.magic));
+    header.version = HANDOFF_VERSION;
+    header.snapshotSize = sizeof(ControlSnapshot_s);
+    header.connectionSize = sizeof(HandoffConnection_s);
 
-    while (quantityToRead > 0)
+    // The event loops are stopped: every order received is already with the pilot
+    if (Control_suspend(&header.control) == FALSE)
     {
-        quantityReaddean = read(socket_donnees, &data + quantityReaddean, quantityToRead);
+        header.accepted = FALSE;
+        Handoff_send(handoffSocket, &header, sizeof(header), -1);
+        close(handoffSocket);
+        handoffSocket = -1;
+        printf("%sRelève refusée, une mission est en cours%s\n", "\033[41m", "\033[0m");
+        return FALSE;
+    }
+    Handoff_close(handoffListener);
+    handoffListener = -1;
+    Telemetry_suspend();
 
-        if (quantityReaddean < 0)
+    header.accepted = TRUE;
+    header.shardCount = shardCount;
+    for (int i = 0; i < shardCount; i++)
+    {
+        for (int j = 0; j < a_shards[i].connectionCount; j++)
         {
-            printf("%sErreur lors de la réception du message%s\n", "\033[41m", "\033[0m");
-            break;
+            // A frame cut in the middle would garble the stream for the other commando, it is left out
+            header.connectionCount += (Telemetry_isIntact(a_shards[i].a_connections[j].socket) == TRUE) ? 1 : 0;
+        }
+    }
+
+    sent = Handoff_send(handoffSocket, &header, sizeof(header), -1);
+    for (int i = 0; i < shardCount && sent == TRUE; i++)
+    {
+        sent = Handoff_send(handoffSocket, &i, sizeof(i), a_shards[i].socket_ecoute);
+    }
+    for (int i = 0; i < shardCount && sent == TRUE; i++)
+    {
+        for (int j = 0; j < a_shards[i].connectionCount && sent == TRUE; j++)
+        {
+            const Connection_s *p_connection = &a_shards[i].a_connections[j];
+
+            if (Telemetry_isIntact(p_connection->socket) == FALSE)
+            {
+                continue; // Closed with the others once the handoff is done
+            }
+            record.shard = i;
+            record.observer = p_connection->observer;
+            record.direction = p_connection->direction;
+            record.tokens = p_connection->tokens;
+            record.filled = (int)p_connection->filled;
+            record.expected = (int)p_connection->expected;
+            memcpy(record.buffer, p_connection->buffer, p_connection->filled);
+            sent = Handoff_send(handoffSocket, &record, offsetof(HandoffConnection_s, buffer) + p_connection->filled, p_connection->socket);
+        }
+    }
+
+    // The new commando confirms it has everything, then it waits for our answer before serving
+    if (sent == TRUE)
+    {
+        int done = 0;
+        int fd = -1;
+
+        sent = (Handoff_receive(handoffSocket, &done, sizeof(done), &fd, HANDOFF_TIMEOUT) == (int)sizeof(done) && done == HANDOFF_DONE);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        done = HANDOFF_DONE;
+        sent = (sent == TRUE && Handoff_send(handoffSocket, &done, sizeof(done), -1) == TRUE) ? TRUE : FALSE;
+    }
+    close(handoffSocket);
+    handoffSocket = -1;
+    if (sent == FALSE)
+    {
+        // Nothing is lost: this commando drives the robot and serves the clients again
+        printf("%sRelève interrompue, le service continue%s\n", "\033[41m", "\033[0m");
+        Telemetry_resume();
+        Control_resume(&header.control);
+        handoffListener = Handoff_listen();
+        if (handoffListener < 0)
+        {
+            perror("Relève impossible");
+        }
+        return FALSE;
+    }
+    handedOver = TRUE;
+    return TRUE;
+}
+
+static void takeOver()
+{
+    HandoffHeader_s header;
+    HandoffConnection_s record;
+    int channel;
+    int fd;
+    int size;
+    int taken = 0;
+
+    channel = Handoff_connect();
+    if (channel < 0)
+    {
+        printf("%sAucun commando à relever%s\n", "\033[41m", "\033[0m");
+        exit(EXIT_FAILURE);
+    }
+    size = Handoff_receive(channel, &header, sizeof(header), &fd, HANDOFF_TIMEOUT);
+    if (size != (int)sizeof(header) || memcmp(header.magic, HANDOFF_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != HANDOFF_VERSION || header.snapshotSize != (int)sizeof(ControlSnapshot_s) ||
+        header.connectionSize != (int)sizeof(HandoffConnection_s))
+    {
+        printf("%sLe commando en cours n'est pas compatible%s\n", "\033[41m", "\033[0m");
+        exit(EXIT_FAILURE);
+    }
+    if (header.accepted == FALSE)
+    {
+        printf("%sRelève refusée, une mission est en cours%s\n", "\033[41m", "\033[0m");
+        exit(EXIT_FAILURE);
+    }
+    if (header.shardCount <= 0 || header.shardCount > MAX_SHARDS)
+    {
+        printf("%sRelève invalide%s\n", "\033[41m", "\033[0m");
+        exit(EXIT_FAILURE);
+    }
+
+    // The event loops of the running commando, whatever -j says
+    shardCount = header.shardCount;
+    snapshot = header.control;
+    for (int i = 0; i < shardCount; i++)
+    {
+        int shard = -1;
+
+        a_shards[i].id = i;
+        a_shards[i].connectionCount = 0;
+        size = Handoff_receive(channel, &shard, sizeof(shard), &a_shards[i].socket_ecoute, HANDOFF_TIMEOUT);
+        if (size != (int)sizeof(shard) || shard != i || a_shards[i].socket_ecoute < 0)
+        {
+            printf("%sRelève interrompue%s\n", "\033[41m", "\033[0m");
+            exit(EXIT_FAILURE);
         }
-        else
+    }
+    for (int i = 0; i < header.connectionCount; i++)
+    {
+        size = Handoff_receive(channel, &record, sizeof(record), &fd, HANDOFF_TIMEOUT);
+        if (size < (int)offsetof(HandoffConnection_s, buffer) || fd < 0)
+        {
+            printf("%sRelève interrompue%s\n", "\033[41m", "\033[0m");
+            exit(EXIT_FAILURE);
+        }
+
+        Shard_s *p_shard = &a_shards[record.shard % shardCount];
+        if (p_shard->connectionCount == MAX_CLIENTS || fd >= FD_SETSIZE || record.filled < 0 || record.expected < (int)sizeof(Data_s) ||
+            record.expected > (int)sizeof(record.buffer) || record.filled > record.expected ||
+            size != (int)offsetof(HandoffConnection_s, buffer) + record.filled)
+        {
+            close(fd);
+            continue;
+        }
+
+        Connection_s *p_connection = &p_shard->a_connections[p_shard->connectionCount++];
+        p_connection->socket = fd;
+        p_connection->filled = record.filled;
+        p_connection->expected = record.expected;
+        memcpy(p_connection->buffer, record.buffer, record.filled);
+        p_connection->observer = (record.observer == TRUE) ? TRUE : FALSE;
+        p_connection->tokens = record.tokens;
+        p_connection->lastRefill = Clock_milliseconds();
+        p_connection->direction = (Direction_e)record.direction;
+        taken++;
+    }
+
+    // The running commando lets go only when it has our confirmation and we have its answer
+    int done = HANDOFF_DONE;
+    if (Handoff_send(channel, &done, sizeof(done), -1) == FALSE ||
+        Handoff_receive(channel, &done, sizeof(done), &fd, HANDOFF_TIMEOUT) != (int)sizeof(done) || done != HANDOFF_DONE)
+    {
+        printf("%sRelève interrompue, le commando en cours continue%s\n", "\033[41m", "\033[0m");
+        exit(EXIT_FAILURE);
+    }
+    close(channel);
+    printf("%sRelève réussie : %d client(s) repris%s\n", "\033[32m", taken, "\033[0m");
+}
+
+static bool_e readMsg(Connection_s *connection)
+{
+    unsigned char buffer[READ_SIZE];
+    ProfileMark_s mark;
+
+    Profile_enter(&mark);
+    const int quantityReaddean = read(connection->socket, buffer, sizeof(buffer));
+    Profile_leave(PR_SOCKET, &mark);
+
+    if (quantityReaddean < 0)
+    {
+        if (errno == EINTR || errno == EAGAIN)
         {
-            quantityToRead -= quantityReaddean;
+            return TRUE;
         }
+        printf("%sErreur lors de la réception du message%s\n", "\033[41m", "\033[0m");
+        return FALSE;
     }
+    else if (quantityReaddean == 0)
+    {
+        return FALSE; // End of the connection
+    }
+
+    return receive(connection, buffer, quantityReaddean);
+}
 
-    if (quantityToRead == 0)
+static bool_e receive(Connection_s *connection, const unsigned char *bytes, size_t length)
+{
+    ProfileMark_s mark;
+
+    Profile_enter(&mark); // The orders posted to the control loop are counted too
+    __atomic_store_n(&lastActivity, (time_t)(Clock_monotonic() / 1000000), __ATOMIC_RELAXED);
+    while (length > 0)
     {
-        data = convertDataReception(data.order, data.direction, 0, 0, 0);
-        TRACE("Receive data:\tDirection: %d - Event: %d\n", data.direction, data.order);
-        if (data.order == O_ASK_LOG)
+        size_t quantity = connection->expected - connection->filled;
+
+        if (quantity > length)
         {
-            sendMsg(Pilot_getState());
+            quantity = length;
         }
-        else if (data.order == O_CHANGE_MVT)
+        memcpy(connection->buffer + connection->filled, bytes, quantity);
+        connection->filled += quantity;
+        bytes += quantity;
+        length -= quantity;
+
+        if (connection->filled < connection->expected)
+        {
+            break;
+        }
+
+        Data_s data;
+        memcpy(&data, connection->buffer, sizeof(Data_s));
+        Codec_decodeFrames(&data, &data, 1);
+        if (connection->expected == sizeof(Data_s) && data.size != 0)
         {
-            Pilot_setVelocity(translate(data.direction));
+            if (data.size < 0 || data.size > MAX_PAYLOAD || data.size % sizeof(int32_t) != 0)
+            {
+                printf("%sTrame invalide, client déconnecté%s\n", "\033[41m", "\033[0m");
+                Profile_leave(PR_DECODE, &mark);
+                return FALSE;
+            }
+            connection->expected += data.size; // The payload follows
+            continue;
         }
-        else
+
+        const bool_e open = handleFrame(connection, data, connection->buffer + sizeof(Data_s));
+        connection->filled = 0;
+        connection->expected = sizeof(Data_s);
+        if (open == FALSE)
+        {
+            Profile_leave(PR_DECODE, &mark);
+            return FALSE; // The bytes after O_STOP are not read
+        }
+    }
+    Profile_leave(PR_DECODE, &mark);
+
+    return TRUE;
+}
+
+static bool_e handleFrame(Connection_s *connection, Data_s data, const unsigned char *payload)
+{
+    TRACE("Receive data:\tDirection: %d - Event: %d - Payload: %d\n", data.direction, data.order, data.size);
+
+    if ((int)data.order < 0 || data.order >= O_NB_ORDER)
+    {
+        // The values after O_NB_ORDER are the internal orders of the control loop
+        __atomic_fetch_add(&ordersRefused, 1, __ATOMIC_RELAXED);
+        TRACE("Unknown order %d dropped\n", data.order);
+        return TRUE;
+    }
+    if (data.order == O_PING)
+    {
+        // Answered at once by the telemetry thread, the pilot is not involved
+        const uint32_t receive = Clock_now();
+        PingRequest_s request = {0, 0, 0, 0, 0};
+        const int size = (data.size < (int)sizeof(request)) ? data.size : (int)sizeof(request);
+
+        memcpy(&request, payload, size);
+        Codec_decodeWords((int32_t *)&request, (const int32_t *)&request, size / sizeof(int32_t));
+        Telemetry_ping(connection->socket, connection->generation, &request, size, receive);
+        return TRUE;
+    }
+    if (data.order == O_ACK)
+    {
+        return TRUE; // Only sent by commando
+    }
+    if (admit(connection, &data) == FALSE)
+    {
+        // Acknowledged by the pilot after the orders before it, the window of the client moves on
+        const Command_s skip = {ORDER_SKIP, D_STOP, connection->socket, NULL, 0, data.sequence, connection->generation};
+
+        if (data.sequence != 0 && Control_post(skip) == FALSE)
         {
-            work = FALSE;
-            Pilot_stop(vectorDefault);
-            Pilot_free();
+            __atomic_fetch_add(&ordersLost, 1, __ATOMIC_RELAXED);
         }
+        return (data.order == O_STOP) ? FALSE : TRUE;
+    }
+
+    const Command_s command = {data.order, data.direction, connection->socket, convertPayloadReception(payload, data.size), data.size, data.sequence, connection->generation};
+
+    // Whatever the event loop, the orders go to the single owner of the robot
+    if (Control_post(command) == FALSE)
+    {
+        free(command.p_payload);
+        __atomic_fetch_add(&ordersLost, 1, __ATOMIC_RELAXED);
+        printf("%sOrdre perdu, le pilote est saturé%s\n", "\033[41m", "\033[0m");
+    }
+
+    return (data.order == O_STOP) ? FALSE : TRUE;
+}
+
+static void acceptClient(Shard_s *shard)
+{
+    const int socket_donnees = accept(shard->socket_ecoute, NULL, 0); // Connection
+
+    if (socket_donnees >= 0) // Verification
+    {
+        addClient(shard, socket_donnees);
+    }
+}
+
+static bool_e addClient(Shard_s *shard, int socket_donnees)
+{
+    if (shard->connectionCount == MAX_CLIENTS || socket_donnees >= FD_SETSIZE)
+    {
+        printf("%sTrop de clients, connexion refusée%s\n", "\033[41m", "\033[0m");
+        close(socket_donnees);
+        return FALSE;
+    }
+
+    Connection_s *p_connection = &shard->a_connections[shard->connectionCount++];
+    p_connection->socket = socket_donnees;
+    p_connection->filled = 0;
+    p_connection->expected = sizeof(Data_s);
+    p_connection->observer = FALSE;
+    p_connection->tokens = ORDER_BURST;
+    p_connection->lastRefill = Clock_milliseconds();
+    p_connection->direction = D_STOP;
+    p_connection->generation = Telemetry_attach(socket_donnees); // The answers are written by the telemetry thread
+    __atomic_store_n(&lastActivity, (time_t)(Clock_monotonic() / 1000000), __ATOMIC_RELAXED);
+    printf("%s%s%sConnexion réussite%s\n", "\033[1A", "\033[K", "\033[33m", "\033[0m");
+
+    return TRUE;
+}
+
+static bool_e admit(Connection_s *connection, const Data_s *data)
+{
+    const long time = Clock_milliseconds();
+
+    connection->tokens += (time - connection->lastRefill) * ORDER_RATE / 1000.0;
+    connection->lastRefill = time;
+    if (connection->tokens > ORDER_BURST)
+    {
+        connection->tokens = ORDER_BURST;
+    }
+
+    if (data->order == O_OBSERVE)
+    {
+        connection->observer = TRUE;
+        Telemetry_observe(connection->socket, connection->generation);
+        return FALSE; // Nothing to do for the pilot
+    }
+    const bool_e query = (data->order == O_ASK_LOG || data->order == O_POSE || data->order == O_MAP || data->order == O_HISTORY || data->order == O_PROFILE);
+    if (connection->observer == TRUE && query == FALSE)
+    {
+        __atomic_fetch_add(&ordersRefused, 1, __ATOMIC_RELAXED);
+        return FALSE;
+    }
+
+    // A setpoint may be the last one of a stream, it is never shed
+    const bool_e change = (data->order == O_SETPOINT || (data->order == O_CHANGE_MVT && data->direction != connection->direction));
+    if (data->order == O_CHANGE_MVT)
+    {
+        connection->direction = data->direction;
+    }
+    if (connection->tokens >= 1)
+    {
+        connection->tokens -= 1;
+    }
+    else if (query == TRUE || (data->order == O_CHANGE_MVT && change == FALSE))
+    {
+        __atomic_fetch_add(&ordersShed, 1, __ATOMIC_RELAXED);
+        return FALSE;
     }
+
+    return TRUE;
 }
 
-static VelocityVector_s translate(const Direction_e direction)
+static void printStats()
 {
-    VelocityVector_s velocityVector = {direction, POWER};
-    return velocityVector;
+    const TelemetryStats_s telemetry = Telemetry_getStats();
+    const HalStats_s hal = Robot_getHalStats();
+
+    printf("%sOrdres délestés : %lu - refusés : %lu - perdus : %lu%s\n", "\033[36m",
+           __atomic_load_n(&ordersShed, __ATOMIC_RELAXED), __atomic_load_n(&ordersRefused, __ATOMIC_RELAXED),
+           __atomic_load_n(&ordersLost, __ATOMIC_RELAXED), "\033[0m");
+    printf("%sTrames envoyées : %lu - réponses perdues : %lu - télémétrie perdue : %lu, fusionnée : %lu - observateurs : %d%s\n", "\033[36m",
+           telemetry.framesSent, telemetry.repliesDropped, telemetry.telemetryDropped, telemetry.telemetryCoalesced, telemetry.observers, "\033[0m");
+    if (telemetry.pings > 0)
+    {
+        printf("%sPings : %lu - dernier client : décalage d'horloge %.1f ms, dérive %d ppm, latence montante %.1f ms, descendante %.1f ms%s\n", "\033[36m",
+               telemetry.pings, telemetry.clockOffset / 1000.0, telemetry.clockDrift, telemetry.uplink / 1000.0, telemetry.downlink / 1000.0, "\033[0m");
+    }
+    if (hal.submitted > 0)
+    {
+        printf("%sAccès au robot : %lu - fusionnés : %lu - lots : %lu - échecs : %lu - latence moyenne %.1f ms, max %.1f ms%s\n", "\033[36m",
+               hal.submitted, hal.coalesced, hal.batches, hal.failures, hal.meanLatency / 1000.0, hal.maxLatency / 1000.0, "\033[0m");
+    }
+    Profile_print();
 }
 
-static Data_s convertDataReception(const Order_e order, const Direction_e direction, const int speed, const bool_e collision, const int luminosity)
+static void onStatsSignal(int signal)
 {
-    Data_s data;
-    data.direction = ntohl(direction);
-    data.order = ntohl(order);
-    data.collision = ntohl(collision);
-    data.luminosity = ntohl(luminosity);
-    data.speed = ntohl(speed);
-    return data;
+    statsRequested = 1;
 }
 
-static Data_s convertDataSend(const Order_e order, const Direction_e direction, const int speed, const bool_e collision, const int luminosity)
+static void closeClient(Shard_s *shard, int index)
 {
-    Data_s data;
-    data.direction = htonl(direction);
-    data.order = htonl(order);
-    data.collision = htonl(collision);
-    data.luminosity = htonl(luminosity);
-    data.speed = htonl(speed);
-    return data;
+#ifdef IO_URING
+    if (useRing == TRUE)
+    {
+        // Ends the multishot receive, which holds the socket open after its close
+        shutdown(shard->a_connections[index].socket, SHUT_RD);
+    }
+#endif
+    Telemetry_detach(shard->a_connections[index].socket, shard->a_connections[index].generation); // Closed once nothing is written on it any more
+    shard->a_connections[index] = shard->a_connections[--shard->connectionCount];
+    printf("%sClient déconnecté%s\n", "\033[31m", "\033[0m");
 }
 
-static void run()
+static void pinToCore(pthread_t thread, int core)
 {
-    bool_e clientConnect = FALSE;
-    int timeoutCount = 0;
-    fd_set readFd;
-    FD_ZERO(&readFd); // Initialization of the file descriptor
+    cpu_set_t cpuSet;
+    const long coreCount = sysconf(_SC_NPROCESSORS_ONLN);
+
+    CPU_ZERO(&cpuSet);
+    CPU_SET(core % (coreCount > 0 ? coreCount : 1), &cpuSet);
+    if (pthread_setaffinity_np(thread, sizeof(cpuSet), &cpuSet) != 0)
+    {
+        TRACE("Event loop %d not pinned\n", core);
+    }
+}
 
-    while (work == TRUE && timeoutCount < MAX_CONNECTION_ATTEMPT)
+static void *runShard(void *arg)
+{
+    run((Shard_s *)arg);
+    return NULL;
+}
+
+static int32_t *convertPayloadReception(const unsigned char *payload, int size)
+{
+    int32_t *p_copy = NULL;
+
+    if (size > 0)
+    {
+        p_copy = (int32_t *)malloc(size);
+        if (p_copy == NULL)
+        {
+            return NULL;
+        }
+        memcpy(p_copy, payload, size); // The payload may be unaligned in the receive buffer
+        Codec_decodeWords(p_copy, p_copy, size / sizeof(int32_t));
+    }
+
+    return p_copy;
+}
+
+static void run(Shard_s *shard)
+{
+    // Only the first event loop watches the terminal and the inactivity
+    const bool_e isMain = (shard->id == 0);
+    struct termios oldt, newt;
+
+    if (isMain)
     {
-        struct termios oldt, newt;
         // Write stdin parameters to old
         tcgetattr(STDIN_FILENO, &oldt);
         newt = oldt;
@@ -225,63 +1077,325 @@ static void run()
 
         // Change the attributes immediately
         tcsetattr(STDIN_FILENO, TCSANOW, &newt);
+        printf("%s%s%sTentative de connexion...%s\n", "\033[1A", "\033[K", "\033[33m", "\033[0m");
+    }
 
-        FD_SET(STDIN_FILENO, &readFd);  // The terminal
-        FD_SET(socket_ecoute, &readFd); // Server Socket
-        struct timeval timeout = {60, 0}; //Time out for select()
-        
-        if (clientConnect) // We check if we are connected
+#ifdef IO_URING
+    if (useRing == FALSE || runRing(shard) == FALSE)
+#endif
+    {
+        runSelect(shard);
+    }
+
+    if (isMain)
+    {
+        // We put back the old parameters
+        tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
+    }
+}
+
+static void watch(const Shard_s *shard, bool_e idle)
+{
+    if (shard->id != 0)
+    {
+        return;
+    }
+    if (statsRequested)
+    {
+        statsRequested = 0;
+        printStats();
+    }
+    if (idle && (time_t)(Clock_monotonic() / 1000000) - __atomic_load_n(&lastActivity, __ATOMIC_RELAXED) >= INACTIVITY_TIMEOUT)
+    {
+        TRACE("Client not connected or inactive")
+        __atomic_store_n(&work, FALSE, __ATOMIC_RELAXED);
+    }
+}
+
+static void runSelect(Shard_s *shard)
+{
+    const bool_e isMain = (shard->id == 0);
+    fd_set readFd;
+
+    while (__atomic_load_n(&work, __ATOMIC_RELAXED) == TRUE)
+    {
+        FD_ZERO(&readFd); // Initialization of the file descriptor
+        FD_SET(shard->socket_ecoute, &readFd); // Server Socket
+        if (isMain)
         {
-            FD_SET(socket_donnees, &readFd); // Client socket
+            FD_SET(STDIN_FILENO, &readFd); // The terminal
+            if (handoffListener >= 0)
+            {
+                FD_SET(handoffListener, &readFd); // A replacing commando
+            }
         }
-        else // We are not connected
+        for (int i = 0; i < shard->connectionCount; i++)
         {
-            printf("%s%s%sTentative de connexion...%s\n", "\033[1A", "\033[K", "\033[33m", "\033[0m");
+            FD_SET(shard->a_connections[i].socket, &readFd); // Client sockets
         }
+        struct timeval timeout = {POLL_PERIOD, 0}; //Time out for select()
 
         int rc = select(FD_SETSIZE, &readFd, NULL, NULL, &timeout);
         // We monitor a descriptor
         if (rc == -1)
         {
+            if (errno == EINTR)
+            {
+                watch(shard, FALSE);
+                continue;
+            }
             printf("%sError with %sselect()%s\n", "\033[41m", "\033[21m", "\033[0m");
             break; // Error
         }
-        else if (rc == 0)
+        watch(shard, rc == 0);
+        if (rc == 0)
+        {
+            continue;
+        }
+
+        // We check if the descriptors are present
+        if (FD_ISSET(shard->socket_ecoute, &readFd))
         {
-            TRACE("Client not connected or inactive")
-            work = FALSE;
+            acceptClient(shard);
         }
-        else
+        for (int i = shard->connectionCount - 1; i >= 0; i--)
         {
-            // We check if the descriptors are present
-            if (FD_ISSET(socket_ecoute, &readFd))
+            if (FD_ISSET(shard->a_connections[i].socket, &readFd) && readMsg(&shard->a_connections[i]) == FALSE)
             {
-                socket_donnees = accept(socket_ecoute, NULL, 0); // Connection
+                closeClient(shard, i);
+            }
+        }
+        if (isMain && handoffListener >= 0 && FD_ISSET(handoffListener, &readFd))
+        {
+            acceptHandoff();
+        }
+        if (isMain && FD_ISSET(STDIN_FILENO, &readFd))
+        {
+            TRACE("Utilisation du terminal");
+            break;
+        }
+    }
+}
+
+#ifdef IO_URING
+static bool_e runRing(Shard_s *shard)
+{
+    Ring_s *p_ring = Ring_new(RING_ENTRIES);
+    struct io_uring_cqe *p_cqe;
+    bool_e running = TRUE;
+
+    if (p_ring == NULL || Ring_provideBuffers(p_ring, RING_BUFFER_COUNT, RING_BUFFER_SIZE) == FALSE)
+    {
+        printf("%sio_uring indisponible, retour à select()%s\n", "\033[41m", "\033[0m");
+        Ring_free(p_ring);
+        return FALSE;
+    }
+
+    armRing(p_ring, EV_ACCEPT, shard->socket_ecoute, 0);
+    for (int i = 0; i < shard->connectionCount; i++)
+    {
+        // Taken over, or kept after a refused handoff
+        armRing(p_ring, EV_RECV, shard->a_connections[i].socket, shard->a_connections[i].generation);
+    }
+    if (shard->id == 0)
+    {
+        armRing(p_ring, EV_TERMINAL, STDIN_FILENO, 0);
+        if (handoffListener >= 0)
+        {
+            armRing(p_ring, EV_HANDOFF, handoffListener, 0);
+        }
+    }
+
+    while (running == TRUE && __atomic_load_n(&work, __ATOMIC_RELAXED) == TRUE)
+    {
+        bool_e idle = TRUE;
+        ProfileMark_s mark;
 
-                if (socket_donnees < 0) // Verification
+        // Submits the new requests and waits for completions in the same call. The kernel
+        // receives the frames within it: a call which brings completions counts as the
+        // reads of select() do, the time spent waiting is not on a core and not counted
+        Profile_enter(&mark);
+        if (Ring_submit(p_ring, 1, POLL_PERIOD * 1000) < 0)
+        {
+            printf("%sError with %sio_uring_enter()%s\n", "\033[41m", "\033[21m", "\033[0m");
+            break;
+        }
+        if (Ring_peek(p_ring) != NULL)
+        {
+            Profile_leave(PR_SOCKET, &mark);
+        }
+
+        while ((p_cqe = Ring_peek(p_ring)) != NULL)
+        {
+            const RingEvent_e event = (RingEvent_e)(p_cqe->user_data >> 56);
+            const uint64_t userData = p_cqe->user_data;
+            const int result = p_cqe->res;
+            const unsigned flags = p_cqe->flags;
+
+            Ring_seen(p_ring);
+            idle = FALSE;
+
+            if (event == EV_ACCEPT)
+            {
+                if (result >= 0 && addClient(shard, result) == TRUE)
                 {
-                    clientConnect = FALSE;
+                    armRing(p_ring, EV_RECV, result, shard->a_connections[shard->connectionCount - 1].generation);
                 }
-                else
+                if ((flags & IORING_CQE_F_MORE) == 0)
                 {
-                    clientConnect = TRUE;
-                    timeoutCount = 0;
-                    printf("%s%s%sConnexion réussite%s\n", "\033[1A", "\033[K", "\033[33m", "\033[0m");
+                    armRing(p_ring, EV_ACCEPT, shard->socket_ecoute, 0);
                 }
             }
-            else if (FD_ISSET(socket_donnees, &readFd))
+            else if (event == EV_RECV)
             {
-                readMsg();
+                // A closed connection may still complete, its socket possibly given to a new one since
+                int index = findClient(shard, userData);
+
+                if (flags & IORING_CQE_F_BUFFER)
+                {
+                    const unsigned id = flags >> IORING_CQE_BUFFER_SHIFT;
+
+                    if (index >= 0 && result > 0 && receive(&shard->a_connections[index], Ring_getBuffer(p_ring, id), result) == FALSE)
+                    {
+                        closeClient(shard, index);
+                        index = -1; // Its multishot receive ends with the shutdown
+                    }
+                    Ring_recycleBuffer(p_ring, id);
+                }
+                if (index < 0)
+                {
+                    continue; // Completion of a connection already closed
+                }
+                if (result == 0 || (result < 0 && result != -ENOBUFS))
+                {
+                    closeClient(shard, index); // End of the connection
+                }
+                else if ((flags & IORING_CQE_F_MORE) == 0)
+                {
+                    armRing(p_ring, EV_RECV, shard->a_connections[index].socket, shard->a_connections[index].generation);
+                }
             }
-            else if (FD_ISSET(STDIN_FILENO, &readFd))
+            else if (event == EV_TERMINAL)
             {
                 TRACE("Utilisation du terminal");
-                break;
+                running = FALSE;
+            }
+            else if (event == EV_HANDOFF)
+            {
+                acceptHandoff();
+                if (handoffSocket < 0)
+                {
+                    armRing(p_ring, EV_HANDOFF, handoffListener, 0);
+                }
             }
         }
-        // We put back the old parameters
-        tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
+        watch(shard, idle);
     }
-    close(socket_donnees);
-    printf("%sClient déconnecté%s\n", "\033[31m", "\033[0m");
+
+    drainRing(shard, p_ring);
+    Ring_free(p_ring);
+    return TRUE;
+}
+
+static void armRing(Ring_s *ring, RingEvent_e event, int socket, uint32_t generation)
+{
+    struct io_uring_sqe *p_sqe = Ring_getSqe(ring);
+
+    if (p_sqe == NULL)
+    {
+        Ring_submit(ring, 0, 0); // Makes room in the submission queue
+        p_sqe = Ring_getSqe(ring);
+    }
+    p_sqe->fd = socket;
+    p_sqe->user_data = ((uint64_t)event << 56) | ((uint64_t)(generation & RING_GENERATION_MASK) << 32) | (uint32_t)socket;
+
+    switch (event)
+    {
+    case EV_ACCEPT:
+        // One request for all the connections to come
+        p_sqe->opcode = IORING_OP_ACCEPT;
+        p_sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        break;
+    case EV_RECV:
+        // One request for all the frames to come, in buffers chosen by the kernel
+        p_sqe->opcode = IORING_OP_RECV;
+        p_sqe->ioprio = IORING_RECV_MULTISHOT;
+        p_sqe->flags = IOSQE_BUFFER_SELECT;
+        p_sqe->buf_group = 0;
+        break;
+    case EV_CANCEL:
+        // All the requests of the ring, whatever their descriptor
+        p_sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        p_sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+        p_sqe->fd = -1;
+        break;
+    default:
+        p_sqe->opcode = IORING_OP_POLL_ADD;
+        p_sqe->poll32_events = POLLIN;
+        break;
+    }
+}
+
+static void drainRing(Shard_s *shard, Ring_s *ring)
+{
+    struct io_uring_cqe *p_cqe;
+    bool_e cancelled = FALSE;
+
+    // The kernel may already have received bytes into the buffers: they go to the
+    // connections, a replacing commando resumes the frames where they stopped
+    armRing(ring, EV_CANCEL, -1, 0);
+    while (cancelled == FALSE && Ring_submit(ring, 1, POLL_PERIOD * 1000) >= 0)
+    {
+        bool_e seen = FALSE;
+
+        while ((p_cqe = Ring_peek(ring)) != NULL)
+        {
+            const RingEvent_e event = (RingEvent_e)(p_cqe->user_data >> 56);
+            const uint64_t userData = p_cqe->user_data;
+            const int result = p_cqe->res;
+            const unsigned flags = p_cqe->flags;
+
+            Ring_seen(ring);
+            seen = TRUE;
+            if (event == EV_CANCEL)
+            {
+                cancelled = TRUE; // Posted once every request is cancelled
+            }
+            else if (event == EV_RECV && (flags & IORING_CQE_F_BUFFER))
+            {
+                const unsigned id = flags >> IORING_CQE_BUFFER_SHIFT;
+                const int index = findClient(shard, userData);
+
+                if (index >= 0 && result > 0 && receive(&shard->a_connections[index], Ring_getBuffer(ring, id), result) == FALSE)
+                {
+                    closeClient(shard, index);
+                }
+                Ring_recycleBuffer(ring, id);
+            }
+            else if (event == EV_ACCEPT && result >= 0)
+            {
+                addClient(shard, result); // Read by the next event loop
+            }
+        }
+        if (seen == FALSE)
+        {
+            break; // Old kernel, the cancel never completes
+        }
+    }
+}
+
+static int findClient(const Shard_s *shard, uint64_t userData)
+{
+    const int socket = (int)(userData & 0xFFFFFFFFu);
+    const uint32_t generation = (uint32_t)(userData >> 32) & RING_GENERATION_MASK;
+
+    for (int i = 0; i < shard->connectionCount; i++)
+    {
+        if (shard->a_connections[i].socket == socket && (shard->a_connections[i].generation & RING_GENERATION_MASK) == generation)
+        {
+            return i;
+        }
+    }
+    return -1;
 }
+#endif /* IO_URING */
@@ -0,0 +1,443 @@
+/**
+ * @file simulation.c
+ *
+ * @see simulation.h
+ *
+ * The events wait in a binary heap ordered by time, then by creation: two
+ * events at the same time always run in the same order. The control loop,
+ * the missions, the planner and the telemetry only see the virtual clock,
+ * which jumps from one event to the next. A paced run only waits for the
+ * wall clock between the events, the virtual clock still drives it: it says
+ * nothing of how the real-time control loop would behave.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "../../common.h"
+#include "../../codec/codec.h"
+#include "../../clock/clock.h"
+#include "../../grammar/grammar.h"
+#include "../robot/robot.h"
+#include "../control/control.h"
+#include "../telemetry/telemetry.h"
+#include "simulation.h"
+
+/**
+ * @brief Maximum number of events waiting
+ */
+#define MAX_EVENTS (16)
+
+/**
+ * @brief Maximum length of a line of the script
+ */
+#define MAX_LINE (256)
+
+typedef enum
+{
+    EV_TICK = 0, // Period of the control loop
+    EV_SCRIPT    // Next commands of the script
+} EventKind_e;
+
+/**
+ * @brief An event of the scheduler
+ */
+typedef struct
+{
+    int64_t time;     // Virtual time (µs)
+    uint64_t order;   // Creation, breaks the ties
+    EventKind_e kind;
+} Event_s;
+
+/**
+ * @brief Adds an event
+ *
+ * @param time Virtual time of the event (µs)
+ * @param kind The kind of event
+ */
+static void schedule(int64_t time, EventKind_e kind);
+
+/**
+ * @brief Takes the first event out of the heap
+ *
+ * @param event Where to write the event
+ * @return bool_e FALSE if no event is left
+ */
+static bool_e nextEvent(Event_s *event);
+
+/**
+ * @brief Tells whether an event comes before another one
+ *
+ * @param first The first event
+ * @param second The second event
+ * @return bool_e TRUE if first runs before second
+ */
+static bool_e before(const Event_s *first, const Event_s *second);
+
+/**
+ * @brief Executes the lines of the script up to the next wait
+ */
+static void runScript();
+
+/**
+ * @brief Executes a line of the script
+ *
+ * @param line The line, modified
+ * @return long Time to wait before the next line (ms), -1 for none
+ */
+static long execute(char *line);
+
+/**
+ * @brief Gives an order to the control loop, as the server would
+ *
+ * @param order The type of order
+ * @param direction The direction, for O_CHANGE_MVT
+ * @param payload The payload, in host byte order
+ * @param size Bytes of payload
+ */
+static void post(Order_e order, Direction_e direction, const void *payload, int size);
+
+/**
+ * @brief Applies the orders posted, at the same virtual time, and prints the answers
+ */
+static void settle();
+
+/**
+ * @brief Reads and prints the frames written by the telemetry
+ */
+static void readAnswers();
+
+/**
+ * @brief Waits until the wall clock reaches a virtual time
+ *
+ * @param time Virtual time (µs)
+ */
+static void pace(int64_t time);
+
+/**
+ * @brief Gives the virtual time
+ *
+ * @return long Time in milliseconds
+ */
+static long elapsed();
+
+static FILE *p_script = NULL;
+static bool_e endOfScript = FALSE;
+static bool_e paced = FALSE;
+static struct timespec wallStart;
+static Event_s a_events[MAX_EVENTS];
+static int eventCount = 0;
+static uint64_t createdCount = 0;
+static int a_sockets[2] = {-1, -1}; // Written by the telemetry, read by the simulation
+static uint32_t generation = 0; // Of the simulated connection, see Telemetry_attach()
+static int32_t a_incoming[(sizeof(Data_s) + MAX_PAYLOAD) / sizeof(int32_t) * 2];
+static size_t received = 0;
+static Collision_e bump = NO_BUMP;
+static float light = 0;
+
+extern void Simulation_new(const char *path)
+{
+    p_script = fopen(path, "r");
+    if (p_script == NULL)
+    {
+        fprintf(stderr, "Impossible d'ouvrir le script %s : %s\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    Clock_useVirtual();
+    Robot_useStub();
+    Telemetry_new();
+    Control_new();
+}
+
+extern void Simulation_setPaced(bool_e isPaced)
+{
+    paced = isPaced;
+}
+
+extern void Simulation_start()
+{
+    struct timespec wallEnd;
+    unsigned long tickCount = 0;
+    Event_s event;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, a_sockets) != 0)
+    {
+        perror("Erreur lors de la création de la liaison simulée");
+        exit(EXIT_FAILURE);
+    }
+    fcntl(a_sockets[1], F_SETFL, fcntl(a_sockets[1], F_GETFL) | O_NONBLOCK);
+    generation = Telemetry_attach(a_sockets[0]);
+    Telemetry_process();
+    Control_startStepped();
+
+    clock_gettime(CLOCK_MONOTONIC, &wallStart);
+    schedule(0, EV_SCRIPT);
+    schedule((int64_t)Control_step() * 1000, EV_TICK);
+    while (endOfScript == FALSE && nextEvent(&event))
+    {
+        if (paced == TRUE)
+        {
+            pace(event.time);
+        }
+        Clock_advance(event.time);
+        if (event.kind == EV_SCRIPT)
+        {
+            runScript();
+        }
+
+        const long nextTick = Control_step();
+        if (event.kind == EV_TICK)
+        {
+            tickCount++;
+            schedule((int64_t)nextTick * 1000, EV_TICK);
+        }
+        Telemetry_process();
+        readAnswers();
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+    const double duration = (wallEnd.tv_sec - wallStart.tv_sec) * 1000.0 + (wallEnd.tv_nsec - wallStart.tv_nsec) / 1000000.0;
+    printf("done %ld %lu\n", elapsed(), tickCount);
+    fflush(stdout);
+    fprintf(stderr, "%ld ms simulées en %.1f ms\n", elapsed(), duration);
+}
+
+extern void Simulation_stop()
+{
+    Control_stop();
+    Telemetry_process();
+    Telemetry_stop(); // Closes its end of the link
+    if (a_sockets[1] >= 0)
+    {
+        close(a_sockets[1]);
+        a_sockets[1] = -1;
+    }
+    if (p_script != NULL)
+    {
+        fclose(p_script);
+        p_script = NULL;
+    }
+}
+
+static void schedule(int64_t time, EventKind_e kind)
+{
+    int child = eventCount;
+
+    if (eventCount == MAX_EVENTS)
+    {
+        fprintf(stderr, "Trop d'événements simulés\n");
+        exit(EXIT_FAILURE);
+    }
+    a_events[eventCount].time = time;
+    a_events[eventCount].order = createdCount++;
+    a_events[eventCount].kind = kind;
+    eventCount++;
+
+    // Up the heap while the parent comes later
+    while (child > 0 && before(&a_events[child], &a_events[(child - 1) / 2]) == TRUE)
+    {
+        const Event_s swap = a_events[child];
+
+        a_events[child] = a_events[(child - 1) / 2];
+        a_events[(child - 1) / 2] = swap;
+        child = (child - 1) / 2;
+    }
+}
+
+static bool_e nextEvent(Event_s *event)
+{
+    int parent = 0;
+
+    if (eventCount == 0)
+    {
+        return FALSE;
+    }
+    *event = a_events[0];
+    a_events[0] = a_events[--eventCount];
+
+    // Down the heap while a child comes first
+    for (;;)
+    {
+        const int left = 2 * parent + 1;
+        int first = parent;
+
+        if (left < eventCount && before(&a_events[left], &a_events[first]) == TRUE)
+        {
+            first = left;
+        }
+        if (left + 1 < eventCount && before(&a_events[left + 1], &a_events[first]) == TRUE)
+        {
+            first = left + 1;
+        }
+        if (first == parent)
+        {
+            return TRUE;
+        }
+
+        const Event_s swap = a_events[parent];
+        a_events[parent] = a_events[first];
+        a_events[first] = swap;
+        parent = first;
+    }
+}
+
+static bool_e before(const Event_s *first, const Event_s *second)
+{
+    if (first->time != second->time)
+    {
+        return (first->time < second->time) ? TRUE : FALSE;
+    }
+    return (first->order < second->order) ? TRUE : FALSE;
+}
+
+static void runScript()
+{
+    char line[MAX_LINE];
+
+    while (endOfScript == FALSE)
+    {
+        if (fgets(line, sizeof(line), p_script) == NULL)
+        {
+            endOfScript = TRUE;
+            return;
+        }
+
+        const long wait = execute(line);
+        if (wait >= 0)
+        {
+            schedule(Clock_monotonic() + (int64_t)wait * 1000, EV_SCRIPT);
+            return;
+        }
+    }
+}
+
+static long execute(char *line)
+{
+    Statement_s statement;
+
+    Grammar_parse(line, &statement);
+    if (statement.kind == ST_WAIT)
+    {
+        return statement.wait;
+    }
+    if (statement.kind == ST_ORDER || statement.kind == ST_QUIT)
+    {
+        post(statement.order, statement.direction, statement.a_payload, statement.size);
+        endOfScript = (statement.kind == ST_QUIT) ? TRUE : endOfScript;
+    }
+    else if (statement.kind == ST_OTHER && strcmp(statement.p_command, "observe") == 0)
+    {
+        Telemetry_observe(a_sockets[0], generation);
+    }
+    else if (statement.kind == ST_OTHER && strcmp(statement.p_command, "bump") == 0 && statement.p_argument != NULL)
+    {
+        settle(); // The orders before see the previous state
+        bump = (strcmp(statement.p_argument, "on") == 0) ? BUMPED : NO_BUMP;
+        Robot_setStubSensors(bump, light);
+    }
+    else if (statement.kind == ST_OTHER && strcmp(statement.p_command, "light") == 0 && statement.p_argument != NULL)
+    {
+        settle();
+        light = atof(statement.p_argument);
+        Robot_setStubSensors(bump, light);
+    }
+    else if (statement.kind == ST_OTHER)
+    {
+        Grammar_reject(statement.p_command);
+    }
+    return -1;
+}
+
+static void post(Order_e order, Direction_e direction, const void *payload, int size)
+{
+    Command_s command = {order, direction, a_sockets[0], NULL, size, 0, generation};
+
+    if (size > 0)
+    {
+        command.p_payload = (int32_t *)malloc(size);
+        if (command.p_payload == NULL)
+        {
+            perror("Erreur lors de la copie d'un ordre");
+            exit(EXIT_FAILURE);
+        }
+        memcpy(command.p_payload, payload, size);
+    }
+    while (Control_post(command) == FALSE)
+    {
+        settle(); // The queue is full
+    }
+}
+
+static void settle()
+{
+    Control_step();
+    Telemetry_process();
+    readAnswers();
+}
+
+static void readAnswers()
+{
+    int32_t a_words[MAX_PAYLOAD / sizeof(int32_t)];
+    char *p_bytes = (char *)a_incoming;
+    ssize_t quantityRead;
+
+    do
+    {
+        quantityRead = recv(a_sockets[1], p_bytes + received, sizeof(a_incoming) - received, 0);
+        if (quantityRead > 0)
+        {
+            received += quantityRead;
+        }
+
+        // The complete frames, a frame may be cut by the end of the buffer
+        while (received >= sizeof(Data_s))
+        {
+            Data_s frame;
+
+            Codec_decodeFrames(&frame, (const Data_s *)p_bytes, 1);
+            if (frame.size < 0 || frame.size > MAX_PAYLOAD || frame.size % sizeof(int32_t) != 0)
+            {
+                fprintf(stderr, "Réponse invalide de la télémétrie\n");
+                exit(EXIT_FAILURE);
+            }
+            if (received < sizeof(Data_s) + frame.size)
+            {
+                break;
+            }
+            Codec_decodeWords(a_words, (const int32_t *)(p_bytes + sizeof(Data_s)), frame.size / sizeof(int32_t));
+            Grammar_printAnswer(elapsed(), &frame, a_words);
+            received -= sizeof(Data_s) + frame.size;
+            memmove(p_bytes, p_bytes + sizeof(Data_s) + frame.size, received);
+        }
+    } while (quantityRead > 0);
+}
+
+static void pace(int64_t time)
+{
+    struct timespec deadline = wallStart;
+
+    deadline.tv_sec += time / 1000000;
+    deadline.tv_nsec += (time % 1000000) * 1000;
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+    {
+        // Woken by a signal, the deadline stays the same
+    }
+}
+
+static long elapsed()
+{
+    return (long)(Clock_monotonic() / 1000);
+}
@@ -0,0 +1,77 @@
+/**
+ * @file  simulation.h
+ *
+ * @brief  Faster than real time runs of the control loop, driven by a discrete-event scheduler
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+
+#ifndef _SIMULATION_
+#define _SIMULATION_
+
+#include "../../common.h"
+
+/**
+ * @brief Opens the script, makes the time virtual and replaces Intox by a robot in memory
+ *
+ * The script takes the commands of telco (see script.h) but map, plus:
+ *  - bump on|off : presses or releases the contact sensors
+ *  - light <mV> : sets the light sensor
+ *  - observe : receives the states broadcast by the control loop
+ *
+ * The answers are printed like telco -s does, stamped with the virtual time.
+ * The simulation ends with the script: "wait" lets the robot run.
+ *
+ * @param path Path of the script
+ */
+extern void Simulation_new(const char *path);
+
+/**
+ * @brief Follows the wall clock instead of running as fast as possible, to be called before Simulation_start()
+ *
+ * The virtual clock still drives the run, only its duration changes: this is
+ * no comparison with the real-time control loop.
+ *
+ * @param paced TRUE to wait for the time of each event
+ */
+extern void Simulation_setPaced(bool_e paced);
+
+/**
+ * @brief Runs the script, the control loop and the telemetry in the calling thread
+ */
+extern void Simulation_start();
+
+/**
+ * @brief Stops the control loop and closes the script
+ */
+extern void Simulation_stop();
+
+#endif // _SIMULATION_
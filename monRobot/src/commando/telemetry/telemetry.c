@@ -0,0 +1,1125 @@
+/**
+ * @file telemetry.c
+ *
+ * @see telemetry.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/uio.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "../../common.h"
+#include "../queue/queue.h"
+#include "../ring/ring.h"
+#include "../profile/profile.h"
+#include "../../codec/codec.h"
+#include "../../clock/clock.h"
+#include "telemetry.h"
+
+/**
+ * @brief Maximum number of requests waiting for the telemetry thread
+ */
+#define REPORT_QUEUE_SIZE (256)
+
+/**
+ * @brief Maximum number of frames waiting to be written on one connection
+ */
+#define OUTGOING_QUEUE_SIZE (16)
+
+/**
+ * @brief Number of encoded frames shared by all the connections
+ */
+#define FRAME_POOL_SIZE (4096)
+
+/**
+ * @brief Payloads up to this size travel inside the requests and the frames (bytes)
+ */
+#define INLINE_PAYLOAD (64)
+
+/**
+ * @brief Time to wait for new requests while frames are still to be written (ms)
+ */
+#define FLUSH_PERIOD (10)
+
+/**
+ * @brief Longest time given to the waiting frames before a handoff (ms)
+ */
+#define DRAIN_TIMEOUT (500)
+
+#ifdef IO_URING
+/**
+ * @brief Maximum number of connections written by one io_uring call
+ */
+#define RING_ENTRIES (256)
+#endif
+
+/**
+ * @brief The requests handled by the telemetry thread
+ */
+typedef enum
+{
+    R_ATTACH = 0,
+    R_DETACH,
+    R_OBSERVE,
+    R_REPLY,
+    R_PAYLOAD,
+    R_PUBLISH,
+    R_PING,
+    R_ACK,
+    R_DRAIN, // Writes the waiting frames and ends the thread, the connections stay open
+    R_QUIT
+} Request_e;
+
+/**
+ * @brief A request and the client it is meant for
+ */
+typedef struct
+{
+    Request_e request;
+    int socket;
+    uint32_t generation; // Of the connection meant, see Telemetry_attach()
+    PilotState_s state;
+    Order_e order; // Answer with a payload
+    int size;      // Bytes of payload
+    int32_t a_inline[INLINE_PAYLOAD / sizeof(int32_t)];
+    int32_t *p_payload; // Larger payload, allocated by the sender, freed by the thread
+    uint32_t sequence;  // Order answered or acknowledged, 0 if none
+} Report_s;
+
+/**
+ * @brief A frame encoded once and shared by the connections which send it
+ */
+typedef struct Frame
+{
+    Data_s data;         // Already in network byte order
+    int32_t a_inline[INLINE_PAYLOAD / sizeof(int32_t)];
+    int32_t *p_payload;  // Payload in network byte order (a_inline or allocated)
+    int size;            // Bytes of payload
+    int refCount;        // Connections still holding the frame
+    bool_e telemetry;    // Broadcast state, can be dropped or coalesced
+    struct Frame *p_next; // Next free frame of the pool
+} Frame_s;
+
+/**
+ * @brief The outgoing side of a client connection
+ */
+typedef struct
+{
+    bool_e used;
+    uint32_t generation; // Of the connection using the socket
+    bool_e observer;
+    Frame_s *a_outgoing[OUTGOING_QUEUE_SIZE];
+    int head;      // First frame to write
+    int count;     // Frames waiting
+    size_t offset; // Bytes of the first frame already written
+    struct iovec a_iov[2 * OUTGOING_QUEUE_SIZE]; // Header and payload of each frame
+    struct msghdr message; // The waiting frames, ready to be written
+    ClockEstimate_s clock; // Clock of the client, from its pings
+    uint32_t ack;          // Last numbered order applied or shed
+    uint32_t ackSent;      // Last acknowledgement queued towards the client
+    bool_e acking;         // In the list of the connections to acknowledge
+} Link_s;
+
+/**
+ * @brief A connection with an acknowledgement to send
+ */
+typedef struct
+{
+    int socket;
+    uint32_t generation; // Of the connection when the acknowledgement was due
+} Acking_s;
+
+/**
+ * @brief Body of the telemetry thread
+ *
+ * @param arg Not used
+ * @return void* Not used
+ */
+static void *run(void *arg);
+
+/**
+ * @brief Handles a request
+ *
+ * @param report The request
+ * @return FALSE if the thread must end, otherwise TRUE
+ */
+static bool_e handle(Report_s *report);
+
+/**
+ * @brief Queues a request, waits for room if it cannot be lost
+ *
+ * @param report The request
+ */
+static void postReliably(const Report_s *report);
+
+/**
+ * @brief Encodes a state into a frame of the pool
+ *
+ * @param state State of the pilot
+ * @param telemetry TRUE for a broadcast state, FALSE for an answer
+ * @param sequence Order answered, 0 for a broadcast state
+ * @param ack Last order acknowledged on the connection, 0 for a broadcast state
+ * @return Frame_s* The frame (one reference), NULL if the pool is empty
+ */
+static Frame_s *encode(PilotState_s state, bool_e telemetry, uint32_t sequence, uint32_t ack);
+
+/**
+ * @brief Encodes an answer with a payload into a frame of the pool
+ *
+ * @param report The request, its allocated payload (if any) goes to the frame
+ * @param ack Last order acknowledged on the connection
+ * @return Frame_s* The frame (one reference), NULL if the pool is empty
+ */
+static Frame_s *encodePayload(Report_s *report, uint32_t ack);
+
+/**
+ * @brief Encodes the answer to a ping, stamped with its departure
+ *
+ * @param report The request, its payload is the PingRequest_s then the arrival
+ * @param ack Last order acknowledged on the connection
+ * @return Frame_s* The frame (one reference), NULL if the pool is empty
+ */
+static Frame_s *encodePing(const Report_s *report, uint32_t ack);
+
+/**
+ * @brief Encodes an acknowledgement without answer
+ *
+ * @param ack Last order acknowledged on the connection
+ * @return Frame_s* The frame (one reference), NULL if the pool is empty
+ */
+static Frame_s *encodeAck(uint32_t ack);
+
+/**
+ * @brief Notes that the numbered orders of a connection are done up to a number
+ *
+ * @param socket Connection of the client
+ * @param link The connection
+ * @param sequence Number of the order, 0 for none
+ */
+static void advance(int socket, Link_s *link, uint32_t sequence);
+
+/**
+ * @brief Queues an O_ACK frame on the connections whose acknowledgement no answer carried
+ */
+static void acknowledge();
+
+/**
+ * @brief Measures the clock of a client from its ping
+ *
+ * @param link The connection
+ * @param report The request, its payload is the PingRequest_s then the arrival
+ */
+static void measure(Link_s *link, const Report_s *report);
+
+/**
+ * @brief Gives the number of bytes of a frame on the wire
+ *
+ * @param frame The frame
+ * @return size_t Header and payload
+ */
+static size_t frameLength(const Frame_s *frame);
+
+/**
+ * @brief Drops a reference to a frame, gives it back to the pool with the last one
+ *
+ * @param frame The frame
+ */
+static void release(Frame_s *frame);
+
+/**
+ * @brief Queues a frame on a connection, the broadcast states give way to the answers
+ *
+ * @param link The connection
+ * @param frame The frame (a reference is taken if it is queued)
+ * @return bool_e TRUE if the frame is queued
+ */
+static bool_e enqueue(Link_s *link, Frame_s *frame);
+
+/**
+ * @brief Writes as many waiting frames as the socket accepts, in a single call
+ *
+ * @param socket Connection of the client
+ * @param link The connection
+ */
+static void flush(int socket, Link_s *link);
+
+/**
+ * @brief Writes the waiting frames of all the connections
+ */
+static void flushAll();
+
+/**
+ * @brief Writes the waiting frames of all the connections, for DRAIN_TIMEOUT at most
+ */
+static void drain();
+
+/**
+ * @brief Describes the waiting frames of a connection in its message
+ *
+ * @param link The connection
+ */
+static void prepare(Link_s *link);
+
+/**
+ * @brief Releases the frames written on a connection
+ *
+ * @param link The connection
+ * @param result Bytes written, or negative errno
+ */
+static void complete(Link_s *link, ssize_t result);
+
+/**
+ * @brief Forgets a connection and closes it
+ *
+ * @param socket Connection of the client
+ */
+static void forget(int socket);
+
+static Queue_s *p_reports = NULL;
+static pthread_t thread;
+static bool_e threaded = FALSE; // Started by Telemetry_start(), otherwise driven by Telemetry_process()
+static Link_s a_links[FD_SETSIZE]; // Indexed by socket
+static int a_observers[FD_SETSIZE];
+static int observerCount = 0;
+static Frame_s a_framePool[FRAME_POOL_SIZE];
+static Frame_s *p_freeFrames = NULL;
+static int pendingCount = 0; // Connections with frames waiting
+static Acking_s a_acking[FD_SETSIZE]; // Connections with an acknowledgement to send
+static int ackingCount = 0;
+static uint32_t lastGeneration = 0; // Given by the threads of the server
+static TelemetryStats_s stats;
+#ifdef IO_URING
+static bool_e useRing = FALSE;
+static Ring_s *p_ring = NULL;
+#endif
+
+extern void Telemetry_new()
+{
+    p_reports = Queue_new(REPORT_QUEUE_SIZE, sizeof(Report_s));
+    if (p_reports == NULL)
+    {
+        perror("Erreur lors de la création de la file de télémétrie");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < FRAME_POOL_SIZE; i++)
+    {
+        a_framePool[i].p_next = (i + 1 < FRAME_POOL_SIZE) ? &a_framePool[i + 1] : NULL;
+    }
+    p_freeFrames = &a_framePool[0];
+}
+
+extern void Telemetry_useRing()
+{
+#ifdef IO_URING
+    useRing = TRUE;
+#endif
+}
+
+extern void Telemetry_start()
+{
+#ifdef IO_URING
+    if (useRing == TRUE)
+    {
+        p_ring = Ring_new(RING_ENTRIES);
+    }
+#endif
+    if (pthread_create(&thread, NULL, &run, NULL) != 0)
+    {
+        printf("%sErreur lors du lancement de la télémétrie%s\n", "\033[41m", "\033[0m");
+        exit(EXIT_FAILURE);
+    }
+    threaded = TRUE;
+}
+
+extern void Telemetry_process()
+{
+    Report_s report;
+
+    while (Queue_pop(p_reports, &report))
+    {
+        handle(&report);
+    }
+    acknowledge();
+    flushAll();
+}
+
+extern void Telemetry_stop()
+{
+    const Report_s quit = {R_QUIT, -1};
+
+    if (threaded == TRUE)
+    {
+        postReliably(&quit);
+        pthread_join(thread, NULL);
+        threaded = FALSE;
+    }
+#ifdef IO_URING
+    Ring_free(p_ring);
+    p_ring = NULL;
+#endif
+    for (int socket = 0; socket < FD_SETSIZE; socket++)
+    {
+        if (a_links[socket].used == TRUE)
+        {
+            forget(socket);
+        }
+    }
+    Queue_free(p_reports);
+    p_reports = NULL;
+}
+
+extern void Telemetry_suspend()
+{
+    const Report_s drain = {R_DRAIN, -1};
+
+    postReliably(&drain);
+    pthread_join(thread, NULL);
+    threaded = FALSE;
+#ifdef IO_URING
+    Ring_free(p_ring);
+    p_ring = NULL;
+#endif
+    Queue_free(p_reports);
+    p_reports = NULL;
+}
+
+extern void Telemetry_resume()
+{
+    p_reports = Queue_new(REPORT_QUEUE_SIZE, sizeof(Report_s));
+    if (p_reports == NULL)
+    {
+        perror("Erreur lors de la création de la file de télémétrie");
+        exit(EXIT_FAILURE);
+    }
+    Telemetry_start();
+}
+
+extern bool_e Telemetry_isIntact(int socket)
+{
+    return (a_links[socket].used == TRUE && a_links[socket].offset == 0) ? TRUE : FALSE;
+}
+
+extern uint32_t Telemetry_attach(int socket)
+{
+    uint32_t generation = __atomic_add_fetch(&lastGeneration, 1, __ATOMIC_RELAXED);
+
+    if (generation == 0)
+    {
+        generation = __atomic_add_fetch(&lastGeneration, 1, __ATOMIC_RELAXED); // 0 is kept for the requests of no connection
+    }
+
+    const Report_s report = {R_ATTACH, socket, generation};
+    postReliably(&report);
+    return generation;
+}
+
+extern void Telemetry_detach(int socket, uint32_t generation)
+{
+    const Report_s report = {R_DETACH, socket, generation};
+    postReliably(&report);
+}
+
+extern void Telemetry_observe(int socket, uint32_t generation)
+{
+    const Report_s report = {R_OBSERVE, socket, generation};
+    postReliably(&report);
+}
+
+extern bool_e Telemetry_reply(int socket, uint32_t generation, uint32_t sequence, PilotState_s state)
+{
+    Report_s report = {R_REPLY, socket, generation, state};
+
+    report.sequence = sequence;
+    return Queue_push(p_reports, &report);
+}
+
+extern bool_e Telemetry_replyPayload(int socket, uint32_t generation, uint32_t sequence, Order_e order, const void *payload, int size)
+{
+    Report_s report = {R_PAYLOAD, socket, generation, {0, 0, 0}, order, size};
+
+    report.sequence = sequence;
+    if (size > INLINE_PAYLOAD)
+    {
+        report.p_payload = (int32_t *)malloc(size);
+        if (report.p_payload == NULL)
+        {
+            return FALSE;
+        }
+        memcpy(report.p_payload, payload, size);
+    }
+    else
+    {
+        memcpy(report.a_inline, payload, size);
+    }
+
+    if (Queue_push(p_reports, &report) == FALSE)
+    {
+        free(report.p_payload);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+extern void Telemetry_ping(int socket, uint32_t generation, const PingRequest_s *request, int size, uint32_t receive)
+{
+    Report_s report = {R_PING, socket, generation, {0, 0, 0}, O_PING, size};
+
+    memcpy(report.a_inline, request, sizeof(PingRequest_s));
+    report.a_inline[sizeof(PingRequest_s) / sizeof(int32_t)] = receive;
+    if (Queue_push(p_reports, &report) == FALSE)
+    {
+        __atomic_fetch_add(&stats.repliesDropped, 1, __ATOMIC_RELAXED); // The next ping will do
+    }
+}
+
+extern bool_e Telemetry_acknowledge(int socket, uint32_t generation, uint32_t sequence)
+{
+    Report_s report = {R_ACK, socket, generation};
+
+    report.sequence = sequence;
+    return Queue_push(p_reports, &report);
+}
+
+extern bool_e Telemetry_publish(PilotState_s state)
+{
+    const Report_s report = {R_PUBLISH, -1, 0, state};
+    return Queue_push(p_reports, &report);
+}
+
+extern int Telemetry_getObserverCount()
+{
+    return __atomic_load_n(&stats.observers, __ATOMIC_RELAXED);
+}
+
+extern TelemetryStats_s Telemetry_getStats()
+{
+    TelemetryStats_s copy;
+
+    copy.framesSent = __atomic_load_n(&stats.framesSent, __ATOMIC_RELAXED);
+    copy.repliesDropped = __atomic_load_n(&stats.repliesDropped, __ATOMIC_RELAXED);
+    copy.telemetryDropped = __atomic_load_n(&stats.telemetryDropped, __ATOMIC_RELAXED);
+    copy.telemetryCoalesced = __atomic_load_n(&stats.telemetryCoalesced, __ATOMIC_RELAXED);
+    copy.observers = __atomic_load_n(&stats.observers, __ATOMIC_RELAXED);
+    copy.pings = __atomic_load_n(&stats.pings, __ATOMIC_RELAXED);
+    copy.clockOffset = __atomic_load_n(&stats.clockOffset, __ATOMIC_RELAXED);
+    copy.clockDrift = __atomic_load_n(&stats.clockDrift, __ATOMIC_RELAXED);
+    copy.uplink = __atomic_load_n(&stats.uplink, __ATOMIC_RELAXED);
+    copy.downlink = __atomic_load_n(&stats.downlink, __ATOMIC_RELAXED);
+    return copy;
+}
+
+static void *run(void *arg)
+{
+    Report_s report;
+    bool_e work = TRUE;
+
+    while (work == TRUE)
+    {
+        // Without frames waiting, nothing to do until the next request
+        const int timeout = (pendingCount > 0) ? FLUSH_PERIOD : -1;
+
+        if (Queue_waitPop(p_reports, &report, timeout))
+        {
+            work = handle(&report);
+            while (work == TRUE && Queue_pop(p_reports, &report))
+            {
+                work = handle(&report);
+            }
+        }
+        acknowledge(); // Once per batch, an answer may have carried it meanwhile
+        flushAll();
+    }
+
+    return NULL;
+}
+
+static bool_e handle(Report_s *report)
+{
+    Link_s *p_link = (report->socket >= 0 && report->socket < FD_SETSIZE) ? &a_links[report->socket] : NULL;
+    // The socket may have gone to a new connection since the request was made
+    const bool_e current = (p_link != NULL && p_link->used == TRUE && p_link->generation == report->generation) ? TRUE : FALSE;
+    Frame_s *p_frame;
+
+    switch (report->request)
+    {
+    case R_ATTACH:
+        p_link->used = TRUE;
+        p_link->generation = report->generation;
+        p_link->observer = FALSE;
+        p_link->head = 0;
+        p_link->count = 0;
+        p_link->offset = 0;
+        p_link->ack = 0;
+        p_link->ackSent = 0;
+        p_link->acking = FALSE;
+        Clock_reset(&p_link->clock);
+        // A slow reader must never block the thread
+        fcntl(report->socket, F_SETFL, fcntl(report->socket, F_GETFL) | O_NONBLOCK);
+        break;
+    case R_DETACH:
+        if (current == FALSE)
+        {
+            break;
+        }
+        if (p_link->count > 0)
+        {
+            flush(report->socket, p_link); // Last chance for the pending answers, without waiting
+        }
+        forget(report->socket);
+        break;
+    case R_OBSERVE:
+        if (current == TRUE && p_link->observer == FALSE)
+        {
+            p_link->observer = TRUE;
+            a_observers[observerCount++] = report->socket;
+            __atomic_store_n(&stats.observers, observerCount, __ATOMIC_RELAXED);
+        }
+        break;
+    case R_REPLY:
+        if (current == TRUE)
+        {
+            // The pilot answers an order while applying it, after the previous ones
+            advance(report->socket, p_link, report->sequence);
+            p_frame = encode(report->state, FALSE, report->sequence, p_link->ack);
+            if (p_frame == NULL)
+            {
+                __atomic_fetch_add(&stats.repliesDropped, 1, __ATOMIC_RELAXED);
+                break;
+            }
+            if (enqueue(p_link, p_frame) == TRUE)
+            {
+                p_link->ackSent = p_link->ack;
+            }
+            release(p_frame);
+        }
+        break;
+    case R_PAYLOAD:
+        if (current == FALSE)
+        {
+            free(report->p_payload);
+            break;
+        }
+        advance(report->socket, p_link, report->sequence);
+        p_frame = encodePayload(report, p_link->ack);
+        if (p_frame == NULL)
+        {
+            free(report->p_payload);
+            __atomic_fetch_add(&stats.repliesDropped, 1, __ATOMIC_RELAXED);
+            break;
+        }
+        if (enqueue(p_link, p_frame) == TRUE)
+        {
+            p_link->ackSent = p_link->ack;
+        }
+        release(p_frame);
+        break;
+    case R_PING:
+        if (current == TRUE)
+        {
+            measure(p_link, report);
+            p_frame = encodePing(report, p_link->ack);
+            if (p_frame == NULL)
+            {
+                __atomic_fetch_add(&stats.repliesDropped, 1, __ATOMIC_RELAXED);
+                break;
+            }
+            if (enqueue(p_link, p_frame) == TRUE)
+            {
+                p_link->ackSent = p_link->ack;
+            }
+            release(p_frame);
+            __atomic_fetch_add(&stats.pings, 1, __ATOMIC_RELAXED);
+        }
+        break;
+    case R_ACK:
+        if (current == TRUE)
+        {
+            advance(report->socket, p_link, report->sequence);
+        }
+        break;
+    case R_PUBLISH:
+        if (observerCount > 0)
+        {
+            // Encoded once, each observer only holds a reference
+            p_frame = encode(report->state, TRUE, 0, 0);
+            if (p_frame == NULL)
+            {
+                __atomic_fetch_add(&stats.telemetryDropped, observerCount, __ATOMIC_RELAXED);
+                break;
+            }
+            for (int i = 0; i < observerCount; i++)
+            {
+                enqueue(&a_links[a_observers[i]], p_frame);
+            }
+            release(p_frame);
+        }
+        break;
+    case R_DRAIN:
+        drain();
+        return FALSE;
+    default:
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void postReliably(const Report_s *report)
+{
+    while (Queue_push(p_reports, report) == FALSE)
+    {
+        sched_yield(); // The queue is full, the thread will empty it
+    }
+}
+
+static Frame_s *encode(PilotState_s state, bool_e telemetry, uint32_t sequence, uint32_t ack)
+{
+    Frame_s *p_frame = p_freeFrames;
+
+    if (p_frame != NULL)
+    {
+        p_freeFrames = p_frame->p_next;
+        const Data_s data = {O_ASK_LOG, 0, state.speed, state.collision, state.luminosity, sizeof(StateStamp_s), sequence, ack};
+        const StateStamp_s stamp = {Clock_now()};
+
+        Codec_encodeFrames(&p_frame->data, &data, 1);
+        Codec_encodeWords(p_frame->a_inline, (const int32_t *)&stamp, sizeof(stamp) / sizeof(int32_t));
+        p_frame->p_payload = p_frame->a_inline;
+        p_frame->size = sizeof(stamp);
+        p_frame->refCount = 1;
+        p_frame->telemetry = telemetry;
+    }
+
+    return p_frame;
+}
+
+static Frame_s *encodePayload(Report_s *report, uint32_t ack)
+{
+    Frame_s *p_frame = p_freeFrames;
+
+    if (p_frame != NULL)
+    {
+        p_freeFrames = p_frame->p_next;
+        const Data_s data = {report->order, 0, 0, 0, 0, report->size, report->sequence, ack};
+
+        Codec_encodeFrames(&p_frame->data, &data, 1);
+        if (report->p_payload != NULL)
+        {
+            p_frame->p_payload = report->p_payload; // Taken over by the frame
+        }
+        else
+        {
+            memcpy(p_frame->a_inline, report->a_inline, report->size);
+            p_frame->p_payload = p_frame->a_inline;
+        }
+        Codec_encodeWords(p_frame->p_payload, p_frame->p_payload, report->size / sizeof(int32_t));
+        p_frame->size = report->size;
+        p_frame->refCount = 1;
+        p_frame->telemetry = FALSE;
+    }
+
+    return p_frame;
+}
+
+static Frame_s *encodePing(const Report_s *report, uint32_t ack)
+{
+    Frame_s *p_frame = p_freeFrames;
+
+    if (p_frame != NULL)
+    {
+        p_freeFrames = p_frame->p_next;
+        const PingRequest_s *p_request = (const PingRequest_s *)report->a_inline;
+        const Data_s data = {O_PING, 0, 0, 0, 0, sizeof(PingReply_s), 0, ack};
+        const PingReply_s reply = {p_request->origin, report->a_inline[sizeof(PingRequest_s) / sizeof(int32_t)], Clock_now()};
+
+        Codec_encodeFrames(&p_frame->data, &data, 1);
+        Codec_encodeWords(p_frame->a_inline, (const int32_t *)&reply, sizeof(reply) / sizeof(int32_t));
+        p_frame->p_payload = p_frame->a_inline;
+        p_frame->size = sizeof(reply);
+        p_frame->refCount = 1;
+        p_frame->telemetry = FALSE;
+    }
+
+    return p_frame;
+}
+
+static Frame_s *encodeAck(uint32_t ack)
+{
+    Frame_s *p_frame = p_freeFrames;
+
+    if (p_frame != NULL)
+    {
+        p_freeFrames = p_frame->p_next;
+        const Data_s data = {O_ACK, 0, 0, 0, 0, 0, 0, ack};
+
+        Codec_encodeFrames(&p_frame->data, &data, 1);
+        p_frame->p_payload = p_frame->a_inline;
+        p_frame->size = 0;
+        p_frame->refCount = 1;
+        p_frame->telemetry = FALSE;
+    }
+
+    return p_frame;
+}
+
+static void advance(int socket, Link_s *link, uint32_t sequence)
+{
+    // Modulo 2^32, an older number is behind by less than half the range
+    if (sequence == 0 || (int32_t)(sequence - link->ack) <= 0)
+    {
+        return;
+    }
+    link->ack = sequence;
+    if (link->acking == FALSE)
+    {
+        link->acking = TRUE;
+        a_acking[ackingCount].socket = socket;
+        a_acking[ackingCount].generation = link->generation;
+        ackingCount++;
+    }
+}
+
+static void acknowledge()
+{
+    for (int i = 0; i < ackingCount; i++)
+    {
+        Link_s *p_link = &a_links[a_acking[i].socket];
+
+        if (p_link->used == FALSE || p_link->generation != a_acking[i].generation)
+        {
+            continue; // Acknowledgement of a connection since closed, not of the one now on the socket
+        }
+        p_link->acking = FALSE;
+        if (p_link->ack == p_link->ackSent)
+        {
+            continue;
+        }
+
+        Frame_s *p_frame = encodeAck(p_link->ack);
+        if (p_frame == NULL)
+        {
+            continue; // The next answer or acknowledgement carries it
+        }
+        if (enqueue(p_link, p_frame) == TRUE)
+        {
+            p_link->ackSent = p_link->ack;
+        }
+        release(p_frame);
+    }
+    ackingCount = 0;
+}
+
+static void measure(Link_s *link, const Report_s *report)
+{
+    const PingRequest_s *p_request = (const PingRequest_s *)report->a_inline;
+    const uint32_t receive = report->a_inline[sizeof(PingRequest_s) / sizeof(int32_t)];
+
+    if (report->size >= (int)sizeof(PingRequest_s))
+    {
+        // The client has the arrival of the previous answer, the exchange is complete
+        Clock_sample(&link->clock, p_request->previousOrigin, p_request->previousReceive, p_request->previousTransmit, p_request->previousArrival);
+        __atomic_store_n(&stats.clockDrift, (int)link->clock.drift, __ATOMIC_RELAXED);
+        __atomic_store_n(&stats.downlink, link->clock.downlink, __ATOMIC_RELAXED);
+    }
+    if (link->clock.count > 0)
+    {
+        __atomic_store_n(&stats.uplink, Clock_noteUplink(&link->clock, p_request->origin, receive), __ATOMIC_RELAXED);
+        __atomic_store_n(&stats.clockOffset, Clock_getOffset(&link->clock, p_request->origin), __ATOMIC_RELAXED);
+    }
+}
+
+static size_t frameLength(const Frame_s *frame)
+{
+    return sizeof(Data_s) + frame->size;
+}
+
+static void release(Frame_s *frame)
+{
+    if (--frame->refCount == 0)
+    {
+        if (frame->p_payload != frame->a_inline)
+        {
+            free(frame->p_payload);
+        }
+        frame->p_next = p_freeFrames;
+        p_freeFrames = frame;
+    }
+}
+
+static bool_e enqueue(Link_s *link, Frame_s *frame)
+{
+    if (link->count == OUTGOING_QUEUE_SIZE)
+    {
+        flush((int)(link - a_links), link); // Makes room if the socket accepts it
+    }
+
+    // The first frame may be partly written, it cannot be replaced
+    const int first = (link->offset > 0) ? 1 : 0;
+
+    if (frame->telemetry == TRUE)
+    {
+        // Only the latest state matters to an observer
+        for (int i = first; i < link->count; i++)
+        {
+            const int index = (link->head + i) % OUTGOING_QUEUE_SIZE;
+
+            if (link->a_outgoing[index]->telemetry == TRUE)
+            {
+                release(link->a_outgoing[index]);
+                frame->refCount++;
+                link->a_outgoing[index] = frame;
+                __atomic_fetch_add(&stats.telemetryCoalesced, 1, __ATOMIC_RELAXED);
+                return TRUE;
+            }
+        }
+        if (link->count == OUTGOING_QUEUE_SIZE)
+        {
+            __atomic_fetch_add(&stats.telemetryDropped, 1, __ATOMIC_RELAXED);
+            return FALSE;
+        }
+    }
+    else if (link->count == OUTGOING_QUEUE_SIZE)
+    {
+        // An answer takes the place of a broadcast state
+        int victim = -1;
+
+        for (int i = first; i < link->count && victim < 0; i++)
+        {
+            if (link->a_outgoing[(link->head + i) % OUTGOING_QUEUE_SIZE]->telemetry == TRUE)
+            {
+                victim = i;
+            }
+        }
+        if (victim < 0)
+        {
+            __atomic_fetch_add(&stats.repliesDropped, 1, __ATOMIC_RELAXED);
+            return FALSE;
+        }
+        release(link->a_outgoing[(link->head + victim) % OUTGOING_QUEUE_SIZE]);
+        for (int i = victim; i + 1 < link->count; i++)
+        {
+            link->a_outgoing[(link->head + i) % OUTGOING_QUEUE_SIZE] = link->a_outgoing[(link->head + i + 1) % OUTGOING_QUEUE_SIZE];
+        }
+        link->count--;
+        __atomic_fetch_add(&stats.telemetryDropped, 1, __ATOMIC_RELAXED);
+    }
+
+    if (link->count == 0)
+    {
+        pendingCount++;
+    }
+    frame->refCount++;
+    link->a_outgoing[(link->head + link->count) % OUTGOING_QUEUE_SIZE] = frame;
+    link->count++;
+
+    return TRUE;
+}
+
+static void flush(int socket, Link_s *link)
+{
+    ProfileMark_s mark;
+
+    prepare(link);
+    Profile_enter(&mark);
+    const ssize_t quantityWritten = sendmsg(socket, &link->message, MSG_NOSIGNAL | MSG_DONTWAIT);
+    Profile_leave(PR_SOCKET, &mark);
+    complete(link, (quantityWritten < 0) ? -errno : quantityWritten);
+}
+
+static void flushAll()
+{
+#ifdef IO_URING
+    if (p_ring != NULL)
+    {
+        int socket = 0;
+
+        while (socket < FD_SETSIZE && pendingCount > 0)
+        {
+            struct io_uring_sqe *p_sqe;
+            struct io_uring_cqe *p_cqe;
+            unsigned submitted = 0;
+
+            // One send per connection, all of them given to the kernel at once
+            for (; socket < FD_SETSIZE && submitted < RING_ENTRIES; socket++)
+            {
+                if (a_links[socket].used == FALSE || a_links[socket].count == 0)
+                {
+                    continue;
+                }
+                p_sqe = Ring_getSqe(p_ring);
+                if (p_sqe == NULL)
+                {
+                    break;
+                }
+                prepare(&a_links[socket]);
+                p_sqe->opcode = IORING_OP_SENDMSG;
+                p_sqe->fd = socket;
+                p_sqe->addr = (uint64_t)(uintptr_t)&a_links[socket].message;
+                p_sqe->len = 1;
+                p_sqe->msg_flags = MSG_NOSIGNAL | MSG_DONTWAIT;
+                p_sqe->user_data = (uint64_t)socket;
+                submitted++;
+            }
+            if (submitted == 0 || Ring_submit(p_ring, submitted, -1) < 0)
+            {
+                break;
+            }
+            while (submitted > 0 && (p_cqe = Ring_peek(p_ring)) != NULL)
+            {
+                const int done = (int)p_cqe->user_data;
+                const int result = p_cqe->res;
+
+                Ring_seen(p_ring);
+                complete(&a_links[done], result);
+                submitted--;
+            }
+        }
+        return;
+    }
+#endif
+    for (int socket = 0; socket < FD_SETSIZE && pendingCount > 0; socket++)
+    {
+        if (a_links[socket].used == TRUE && a_links[socket].count > 0)
+        {
+            flush(socket, &a_links[socket]);
+        }
+    }
+}
+
+static void drain()
+{
+    acknowledge();
+    flushAll();
+    for (int waited = 0; pendingCount > 0 && waited < DRAIN_TIMEOUT; waited++)
+    {
+        poll(NULL, 0, 1); // The slow readers make room
+        flushAll();
+    }
+}
+
+static void prepare(Link_s *link)
+{
+    size_t skip = link->offset; // Already written
+    int count = 0;
+
+    for (int i = 0; i < link->count; i++)
+    {
+        Frame_s *p_frame = link->a_outgoing[(link->head + i) % OUTGOING_QUEUE_SIZE];
+        unsigned char *a_parts[2] = {(unsigned char *)&p_frame->data, (unsigned char *)p_frame->p_payload};
+        const size_t a_lengths[2] = {sizeof(Data_s), (size_t)p_frame->size};
+
+        for (int part = 0; part < 2; part++)
+        {
+            if (skip >= a_lengths[part])
+            {
+                skip -= a_lengths[part];
+                continue;
+            }
+            link->a_iov[count].iov_base = a_parts[part] + skip;
+            link->a_iov[count].iov_len = a_lengths[part] - skip;
+            skip = 0;
+            count++;
+        }
+    }
+    memset(&link->message, 0, sizeof(link->message));
+    link->message.msg_iov = link->a_iov;
+    link->message.msg_iovlen = count;
+}
+
+static void complete(Link_s *link, ssize_t result)
+{
+    ssize_t quantityWritten = result;
+
+    if (quantityWritten < 0)
+    {
+        if (quantityWritten != -EAGAIN && quantityWritten != -EWOULDBLOCK && quantityWritten != -EINTR)
+        {
+            // The client is gone, its event loop will detach it
+            printf("%sErreur lors de l'envoi du message%s\n", "\033[41m", "\033[0m");
+            quantityWritten = 0;
+            for (int i = 0; i < link->count; i++)
+            {
+                quantityWritten += frameLength(link->a_outgoing[(link->head + i) % OUTGOING_QUEUE_SIZE]);
+            }
+            quantityWritten -= link->offset;
+        }
+        else
+        {
+            return;
+        }
+    }
+
+    quantityWritten += link->offset;
+    while (link->count > 0 && quantityWritten >= (ssize_t)frameLength(link->a_outgoing[link->head]))
+    {
+        quantityWritten -= frameLength(link->a_outgoing[link->head]);
+        release(link->a_outgoing[link->head]);
+        link->head = (link->head + 1) % OUTGOING_QUEUE_SIZE;
+        link->count--;
+        __atomic_fetch_add(&stats.framesSent, 1, __ATOMIC_RELAXED);
+    }
+    link->offset = (link->count > 0) ? (size_t)quantityWritten : 0;
+    if (link->count == 0)
+    {
+        pendingCount--;
+    }
+}
+
+static void forget(int socket)
+{
+    Link_s *p_link = &a_links[socket];
+
+    if (p_link->used == FALSE)
+    {
+        return;
+    }
+    if (p_link->count > 0)
+    {
+        pendingCount--;
+    }
+    while (p_link->count > 0)
+    {
+        release(p_link->a_outgoing[p_link->head]);
+        p_link->head = (p_link->head + 1) % OUTGOING_QUEUE_SIZE;
+        p_link->count--;
+    }
+    if (p_link->observer == TRUE)
+    {
+        for (int i = 0; i < observerCount; i++)
+        {
+            if (a_observers[i] == socket)
+            {
+                a_observers[i] = a_observers[--observerCount];
+                break;
+            }
+        }
+        __atomic_store_n(&stats.observers, observerCount, __ATOMIC_RELAXED);
+    }
+    if (p_link->acking == TRUE)
+    {
+        for (int i = 0; i < ackingCount; i++)
+        {
+            if (a_acking[i].socket == socket)
+            {
+                a_acking[i] = a_acking[--ackingCount];
+                break;
+            }
+        }
+        p_link->acking = FALSE;
+    }
+    p_link->used = FALSE;
+    close(socket);
+}
@@ -0,0 +1,213 @@
+/**
+ * @file  telemetry.h
+ *
+ * @brief  Telemetry thread, encodes and sends the state of the pilot
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "../../common.h"
+
+/**
+ * @brief Counters of the telemetry thread
+ */
+typedef struct
+{
+    unsigned long framesSent;         // Frames written on the sockets
+    unsigned long repliesDropped;     // Answers lost, the client did not read them
+    unsigned long telemetryDropped;   // Broadcast states lost, the observer is too slow
+    unsigned long telemetryCoalesced; // Broadcast states replaced by a newer one
+    int observers;                    // Connections receiving the broadcast states
+    unsigned long pings;              // Pings answered
+    int clockOffset;                  // Last client pinging: clock of commando minus its clock (µs)
+    int clockDrift;                   // Its drift (ppm)
+    int uplink;                       // Its last one-way latency towards commando (µs)
+    int downlink;                     // Its last one-way latency from commando (µs)
+} TelemetryStats_s;
+
+/**
+ * @brief Initializes the telemetry thread
+ */
+extern void Telemetry_new();
+
+/**
+ * @brief Writes the frames of all the connections with one io_uring call, to be called before Telemetry_start()
+ *
+ * Without IO_URING support, the frames are written with one sendmsg() per connection.
+ */
+extern void Telemetry_useRing();
+
+/**
+ * @brief Starts the telemetry thread
+ */
+extern void Telemetry_start();
+
+/**
+ * @brief Handles the waiting requests and writes the frames in the calling thread, instead of Telemetry_start()
+ *
+ * For a simulation, called after each step of the control loop.
+ */
+extern void Telemetry_process();
+
+/**
+ * @brief Stops the telemetry thread and waits for its end
+ *
+ * The sockets still attached are closed.
+ */
+extern void Telemetry_stop();
+
+/**
+ * @brief Writes the waiting frames and stops the thread, without closing the connections
+ *
+ * Used before a handoff: the connections go on in another process.
+ */
+extern void Telemetry_suspend();
+
+/**
+ * @brief Starts the thread again after Telemetry_suspend(), when the handoff failed
+ *
+ * The connections attached before are still there.
+ */
+extern void Telemetry_resume();
+
+/**
+ * @brief Tells if a connection can be handed over after Telemetry_suspend()
+ *
+ * @param socket Connection of the client
+ * @return bool_e FALSE if a frame was only partly written on it
+ */
+extern bool_e Telemetry_isIntact(int socket);
+
+/**
+ * @brief Hands a new client connection to the telemetry thread, which writes on it
+ *
+ * Once the connection is closed, the system may give its socket to a new one: the
+ * requests for the connection carry its generation, those of an older one are dropped.
+ *
+ * @param socket Connection of the client
+ * @return uint32_t Generation of the connection, never 0
+ */
+extern uint32_t Telemetry_attach(int socket);
+
+/**
+ * @brief Forgets a client connection, the telemetry thread closes it
+ *
+ * @param socket Connection of the client
+ * @param generation Generation of the connection, from Telemetry_attach()
+ */
+extern void Telemetry_detach(int socket, uint32_t generation);
+
+/**
+ * @brief Subscribes a client connection to the broadcast states
+ *
+ * @param socket Connection of the client
+ * @param generation Generation of the connection, from Telemetry_attach()
+ */
+extern void Telemetry_observe(int socket, uint32_t generation);
+
+/**
+ * @brief Gives the answer to a request of a client, never blocks
+ *
+ * The answer acknowledges its order and the previous ones.
+ *
+ * @param socket Connection of the client
+ * @param generation Generation of the connection, from Telemetry_attach()
+ * @param sequence Number of the order answered, 0 if it is not numbered
+ * @param state State of the pilot
+ * @return TRUE if the state was queued, FALSE if the queue is full
+ */
+extern bool_e Telemetry_reply(int socket, uint32_t generation, uint32_t sequence, PilotState_s state);
+
+/**
+ * @brief Gives an answer carrying a payload to a client, never blocks
+ *
+ * @param socket Connection of the client
+ * @param generation Generation of the connection, from Telemetry_attach()
+ * @param sequence Number of the order answered, 0 if it is not numbered or for a progress report
+ * @param order Order answered
+ * @param payload The payload, 32-bit integers in host byte order (copied)
+ * @param size Bytes of payload, multiple of 4 and at most MAX_PAYLOAD
+ * @return TRUE if the answer was queued, FALSE if the queue is full
+ */
+extern bool_e Telemetry_replyPayload(int socket, uint32_t generation, uint32_t sequence, Order_e order, const void *payload, int size);
+
+/**
+ * @brief Acknowledges the numbered orders of a client up to a number, never blocks
+ *
+ * The acknowledgement goes with the next answer to the client, or in an O_ACK frame.
+ *
+ * @param socket Connection of the client
+ * @param generation Generation of the connection, from Telemetry_attach()
+ * @param sequence Number of the last order applied or shed
+ * @return TRUE if queued, FALSE if the queue is full (the next acknowledgement covers it)
+ */
+extern bool_e Telemetry_acknowledge(int socket, uint32_t generation, uint32_t sequence);
+
+/**
+ * @brief Answers a ping, the departure of the answer is stamped just before it is written
+ *
+ * The timestamps of the previous exchange, if any, update the estimate of the clock of the client.
+ *
+ * @param socket Connection of the client
+ * @param generation Generation of the connection, from Telemetry_attach()
+ * @param request The ping, in host byte order
+ * @param size Bytes of the ping, only the origin if less than a PingRequest_s
+ * @param receive Arrival of the ping
+ */
+extern void Telemetry_ping(int socket, uint32_t generation, const PingRequest_s *request, int size, uint32_t receive);
+
+/**
+ * @brief Gives a state to broadcast to all the observers, never blocks
+ *
+ * The state is encoded once and shared by all the observers.
+ *
+ * @param state State of the pilot
+ * @return TRUE if the state was queued, FALSE if the queue is full
+ */
+extern bool_e Telemetry_publish(PilotState_s state);
+
+/**
+ * @brief Gives the number of observers
+ *
+ * @return int Number of connections subscribed to the broadcast states
+ */
+extern int Telemetry_getObserverCount();
+
+/**
+ * @brief Gives the counters of the telemetry thread
+ *
+ * @return TelemetryStats_s The counters
+ */
+extern TelemetryStats_s Telemetry_getStats();
+
+#endif /* TELEMETRY_H */
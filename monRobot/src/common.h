@@ -2,6 +2,7 @@
 #define _CONFIG_
 
 #include <termios.h>
+#include <stdint.h>
 
 #include "../../infox_prose-x86_64-v0.3/include/infox/prose/prose.h"
 #include "util.h"
@@ -33,9 +34,36 @@ typedef enum
     O_CHANGE_MVT = 0,
     O_ASK_LOG,
     O_STOP,
+    O_OBSERVE, // The connection only receives the telemetry, it can no longer drive
+    O_MISSION, // Payload: MissionStep_s[], answers: MissionProgress_s
+    O_ABORT,   // Aborts the mission in progress
+    O_SETPOINT, // Payload: Setpoint_s, reached with the acceleration limits of the server
+    O_BEHAVIOUR, // Payload: BehaviourOrder_s, the robot drives on its own
+    O_POSE,      // Answer: PoseReport_s
+    O_MAP,       // Payload: MapRegion_s, answer: MapRegion_s then the cells (see MapRegion_s)
+    O_GOTO,      // Payload: GoalOrder_s, answers: NavigationProgress_s
+    O_HISTORY,   // Payload: HistoryQuery_s, answer: HistoryHeader_s then the samples
+    O_PING,      // Payload: PingRequest_s, answer: PingReply_s
+    O_ACK,       // Sent by commando only: acknowledges the numbered orders, see Data_s
+    O_PROFILE,   // Answer: ProfileReport_s[], empty if commando runs without -P
     O_NB_ORDER
 } Order_e;
 
+/**
+ * @brief Maximum size of the payload following a frame (bytes)
+ *
+ * A payload is made of 32-bit integers only, each one in network byte order.
+ */
+#define MAX_PAYLOAD (4096)
+
+/**
+ * @brief Header of every frame
+ *
+ * A client may number its orders (1, 2, ... modulo 2^32, 0 skipped) to keep several
+ * of them in flight. The answers carry the number of their order, the frames of
+ * commando the last acknowledged order of the connection; O_ACK frames are sent
+ * when no answer carries it. The pings are not numbered.
+ */
 typedef struct
 {
     Order_e order;
@@ -43,6 +71,239 @@ typedef struct
     int speed;
     bool_e collision;
     int luminosity;
+    int size; // Bytes of payload following the frame
+    uint32_t sequence; // Number of an order (0: not numbered), copied into its answer
+    uint32_t ack;      // From commando: every numbered order up to this one is applied or shed (0: none)
 } Data_s;
 
+/**
+ * @brief A step of a mission: a velocity vector held for a duration
+ */
+typedef struct
+{
+    int direction; // Direction_e
+    int power;     // Between 0 and 100
+    int duration;  // Milliseconds
+} MissionStep_s;
+
+#define MAX_MISSION_STEPS ((int)(MAX_PAYLOAD / sizeof(MissionStep_s)))
+
+typedef enum
+{
+    SP_TWIST = 0, // Linear and angular velocities
+    SP_WHEELS     // Left and right wheel speeds
+} SetpointKind_e;
+
+/**
+ * @brief A continuous velocity setpoint, velocities between -100 and 100 (%)
+ */
+typedef struct
+{
+    int kind;   // SetpointKind_e
+    int first;  // Linear velocity or left wheel
+    int second; // Angular velocity (positive turns like D_LEFT) or right wheel
+} Setpoint_s;
+
+typedef enum
+{
+    B_MANUAL = 0, // Only the orders of the clients
+    B_AVOID,      // Goes ahead, moves back and turns when it bumps into an obstacle
+    B_SEEK_LIGHT, // Goes ahead while the light increases, turns otherwise, avoids the obstacles
+    B_NB_BEHAVIOUR
+} Behaviour_e;
+
+typedef struct
+{
+    int behaviour; // Behaviour_e
+    int power;     // Cruising power, between 0 and 100
+} BehaviourOrder_s;
+
+/**
+ * @brief Estimated pose, the robot starts at (0, 0) heading along x
+ */
+typedef struct
+{
+    int x;       // mm
+    int y;       // mm
+    int heading; // mrad, counterclockwise, turning like D_LEFT increases it
+} PoseReport_s;
+
+/**
+ * @brief Side of a cell of the map (mm)
+ */
+#define MAP_CELL (50)
+
+/**
+ * @brief Cells per side of the map, the robot starts in the middle
+ */
+#define MAP_SIZE (256)
+
+typedef enum
+{
+    C_UNKNOWN = 0,
+    C_FREE,
+    C_OCCUPIED
+} Cell_e;
+
+/**
+ * @brief A region of the map, in cells
+ *
+ * The answer gives the region actually sent, followed by its cells row by
+ * row, 2 bits (Cell_e) per cell and 16 cells per 32-bit word, the first
+ * cell in the low bits.
+ */
+typedef struct
+{
+    int column;
+    int row;
+    int width;
+    int height;
+} MapRegion_s;
+
+/**
+ * @brief A goal to reach, in the frame of the pose
+ */
+typedef struct
+{
+    int x;     // mm
+    int y;     // mm
+    int power; // Cruising power, between 0 and 100
+} GoalOrder_s;
+
+/**
+ * @brief A state of the robot kept by the server
+ */
+typedef struct
+{
+    int time; // ms since the start of the server
+    int speed;
+    int collision;
+    int luminosity;
+} HistorySample_s;
+
+/**
+ * @brief Request of the last samples kept by the server
+ */
+typedef struct
+{
+    int count; // Maximum number of samples, the most recent ones of the window
+    int from;  // Oldest time wanted (ms), 0 for no limit
+    int to;    // Only the samples before this time (ms), 0 for no limit, to go back page by page
+} HistoryQuery_s;
+
+/**
+ * @brief Header of the answer, followed by the samples from the oldest to the newest
+ */
+typedef struct
+{
+    int now;   // Time of the server (ms)
+    int count; // Number of samples
+} HistoryHeader_s;
+
+#define MAX_HISTORY_REPLY ((int)((MAX_PAYLOAD - sizeof(HistoryHeader_s)) / sizeof(HistorySample_s)))
+
+/**
+ * @brief A state recorded by telco -r, in host byte order, read by logbook
+ */
+typedef struct
+{
+    int64_t time; // ms since the epoch
+    int32_t speed;
+    int32_t collision;
+    int32_t luminosity;
+    int32_t reserved; // Keeps the records aligned on 8 bytes
+} TelemetryRecord_s;
+
+typedef enum
+{
+    M_RUNNING = 0,
+    M_DONE,
+    M_ABORTED, // By an order of a client
+    M_BUMPED,  // A collision stopped the robot
+    M_REFUSED  // Empty or invalid mission
+} MissionStatus_e;
+
+/**
+ * @brief Progress of a mission, sent at each step and at the end
+ */
+typedef struct
+{
+    int step;   // Index of the current step
+    int count;  // Number of steps
+    int status; // MissionStatus_e
+} MissionProgress_s;
+
+/**
+ * @brief Progress towards a goal, sent at each plan, each waypoint and at the end
+ *
+ * M_REFUSED: the goal can not be reached, M_BUMPED: too many obstacles on the way.
+ */
+typedef struct
+{
+    int status;       // MissionStatus_e
+    int waypoint;     // Index of the waypoint driven to
+    int count;        // Number of waypoints of the plan
+    int planningTime; // Duration of the last planning (µs)
+    int replans;      // Plans made again after a collision
+} NavigationProgress_s;
+
+/**
+ * @brief A ping of telco, to estimate the offset of the clocks (timestamps: µs modulo 2^32)
+ *
+ * The timestamps of the previous exchange let commando make the estimate too.
+ * The first ping of a connection only holds the origin.
+ */
+typedef struct
+{
+    uint32_t origin;           // Departure of this ping (telco)
+    uint32_t previousOrigin;   // Previous exchange, as received in its answer
+    uint32_t previousReceive;
+    uint32_t previousTransmit;
+    uint32_t previousArrival;  // Arrival of the previous answer (telco)
+} PingRequest_s;
+
+/**
+ * @brief Answer to a ping
+ */
+typedef struct
+{
+    uint32_t origin;   // Copied from the ping
+    uint32_t receive;  // Arrival of the ping (commando)
+    uint32_t transmit; // Departure of the answer (commando)
+} PingReply_s;
+
+/**
+ * @brief Sections of commando measured by the counters of the processor
+ */
+typedef enum
+{
+    PR_PILOT = 0, // Transition of the state machine of the pilot
+    PR_SENSORS,   // Reading of the sensors by the control loop
+    PR_DECODE,    // Decoding of the frames received
+    PR_SOCKET,    // Reads and writes on the sockets of the clients, io_uring_enter() bringing completions with -u
+    PR_NB_REGION
+} ProfileRegion_e;
+
+/**
+ * @brief Counters of a section since the start of commando, means per pass
+ */
+typedef struct
+{
+    int region;            // ProfileRegion_e
+    uint32_t calls;        // Passes through the section
+    uint32_t nanoseconds;  // Time of the thread on a core
+    uint32_t cycles;       // The hardware counters are 0 where the processor has none (virtual machine)
+    uint32_t instructions;
+    uint32_t cacheMisses;
+    uint32_t branchMisses;
+} ProfileReport_s;
+
+/**
+ * @brief Payload of the states (O_ASK_LOG) sent by commando
+ */
+typedef struct
+{
+    uint32_t transmit; // Departure (commando, µs modulo 2^32), gives the one-way latency
+} StateStamp_s;
+
 #endif // _CONFIG_
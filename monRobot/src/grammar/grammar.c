@@ -0,0 +1,298 @@
+/**
+ * @file grammar.c
+ *
+ * @see grammar.h
+ *
+ * A script runs the same on a real commando through telco -s and on the
+ * simulated one of commando -s: both programs read it here, and print the
+ * answers here, so that their outputs can be compared line by line.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "grammar.h"
+
+/**
+ * @brief Fills a statement with an order
+ *
+ * @param p_statement The statement
+ * @param order The type of order
+ * @param direction The direction, for O_CHANGE_MVT
+ * @param payload The payload, in host byte order
+ * @param size Bytes of payload
+ */
+static void setOrder(Statement_s *p_statement, Order_e order, Direction_e direction, const void *payload, int size);
+
+/**
+ * @brief Adds a step to the mission being written
+ *
+ * @param direction Name of the direction
+ * @param power Power, between 0 and 100
+ * @param duration Duration of the step (ms)
+ */
+static void addStep(const char *direction, const char *power, const char *duration);
+
+static const char *const a_directions[D_NB_DIRECTION] = {"stop", "forward", "backward", "left", "right"};
+static int lineNumber = 0;
+static MissionStep_s a_mission[MAX_MISSION_STEPS]; // Steps written since the last "mission"
+static int missionSize = 0;
+
+extern void Grammar_parse(char *line, Statement_s *p_statement)
+{
+    char *p_command;
+    char *p_argument;
+
+    p_statement->kind = ST_NONE;
+    p_statement->size = 0;
+    p_statement->answered = FALSE;
+    lineNumber++;
+
+    line[strcspn(line, "#\r\n")] = '\0'; // Comments
+    p_command = strtok(line, " \t");
+    if (p_command == NULL)
+    {
+        return; // Empty line
+    }
+    p_argument = strtok(NULL, " \t");
+
+    for (int i = 0; i < D_NB_DIRECTION; i++)
+    {
+        if (strcmp(p_command, a_directions[i]) == 0)
+        {
+            setOrder(p_statement, O_CHANGE_MVT, i, NULL, 0);
+            return;
+        }
+    }
+    if (strcmp(p_command, "wait") == 0 && p_argument != NULL)
+    {
+        p_statement->kind = ST_WAIT;
+        p_statement->wait = (atol(p_argument) > 0) ? atol(p_argument) : 0;
+    }
+    else if (strcmp(p_command, "status") == 0)
+    {
+        setOrder(p_statement, O_ASK_LOG, D_STOP, NULL, 0);
+    }
+    else if (strcmp(p_command, "pose") == 0)
+    {
+        setOrder(p_statement, O_POSE, D_STOP, NULL, 0);
+    }
+    else if (strcmp(p_command, "profile") == 0)
+    {
+        setOrder(p_statement, O_PROFILE, D_STOP, NULL, 0);
+    }
+    else if (strcmp(p_command, "step") == 0)
+    {
+        char *p_power = strtok(NULL, " \t");
+
+        addStep(p_argument, p_power, strtok(NULL, " \t"));
+    }
+    else if (strcmp(p_command, "mission") == 0)
+    {
+        setOrder(p_statement, O_MISSION, D_STOP, a_mission, missionSize * sizeof(MissionStep_s));
+        missionSize = 0;
+    }
+    else if ((strcmp(p_command, "twist") == 0 || strcmp(p_command, "wheels") == 0) && p_argument != NULL)
+    {
+        const char *p_second = strtok(NULL, " \t");
+        const Setpoint_s setpoint = {(p_command[0] == 't') ? SP_TWIST : SP_WHEELS, atoi(p_argument), (p_second != NULL) ? atoi(p_second) : 0};
+
+        setOrder(p_statement, O_SETPOINT, D_STOP, &setpoint, sizeof(setpoint));
+    }
+    else if (strcmp(p_command, "behaviour") == 0 && p_argument != NULL)
+    {
+        static const char *const a_behaviours[B_NB_BEHAVIOUR] = {"manual", "avoid", "light"};
+        const char *p_power = strtok(NULL, " \t");
+        BehaviourOrder_s behaviour = {B_NB_BEHAVIOUR, (p_power != NULL) ? atoi(p_power) : 50};
+
+        for (int i = 0; i < B_NB_BEHAVIOUR; i++)
+        {
+            if (strcmp(p_argument, a_behaviours[i]) == 0)
+            {
+                behaviour.behaviour = i;
+            }
+        }
+        if (behaviour.behaviour == B_NB_BEHAVIOUR)
+        {
+            fprintf(stderr, "Ligne %d : comportement inconnu \"%s\"\n", lineNumber, p_argument);
+            return;
+        }
+        setOrder(p_statement, O_BEHAVIOUR, D_STOP, &behaviour, sizeof(behaviour));
+    }
+    else if (strcmp(p_command, "goto") == 0 && p_argument != NULL)
+    {
+        const char *p_y = strtok(NULL, " \t");
+        const char *p_power = strtok(NULL, " \t");
+        const GoalOrder_s goal = {atoi(p_argument), (p_y != NULL) ? atoi(p_y) : 0, (p_power != NULL) ? atoi(p_power) : 50};
+
+        setOrder(p_statement, O_GOTO, D_STOP, &goal, sizeof(goal));
+    }
+    else if (strcmp(p_command, "history") == 0 && p_argument != NULL)
+    {
+        const char *p_from = strtok(NULL, " \t");
+        const char *p_to = (p_from != NULL) ? strtok(NULL, " \t") : NULL;
+        const HistoryQuery_s query = {atoi(p_argument), (p_from != NULL) ? atoi(p_from) : 0, (p_to != NULL) ? atoi(p_to) : 0};
+
+        setOrder(p_statement, O_HISTORY, D_STOP, &query, sizeof(query));
+    }
+    else if (strcmp(p_command, "map") == 0 && p_argument != NULL)
+    {
+        MapRegion_s region = {atoi(p_argument), 0, 1, 1};
+        char *p_value;
+
+        if ((p_value = strtok(NULL, " \t")) != NULL)
+        {
+            region.row = atoi(p_value);
+        }
+        if ((p_value = strtok(NULL, " \t")) != NULL)
+        {
+            region.width = atoi(p_value);
+        }
+        if ((p_value = strtok(NULL, " \t")) != NULL)
+        {
+            region.height = atoi(p_value);
+        }
+        setOrder(p_statement, O_MAP, D_STOP, &region, sizeof(region));
+    }
+    else if (strcmp(p_command, "abort") == 0)
+    {
+        setOrder(p_statement, O_ABORT, D_STOP, NULL, 0);
+    }
+    else if (strcmp(p_command, "quit") == 0)
+    {
+        setOrder(p_statement, O_STOP, D_STOP, NULL, 0);
+        p_statement->kind = ST_QUIT;
+    }
+    else
+    {
+        p_statement->kind = ST_OTHER;
+        p_statement->p_command = p_command;
+        p_statement->p_argument = p_argument;
+    }
+}
+
+extern void Grammar_reject(const char *p_command)
+{
+    fprintf(stderr, "Ligne %d : commande inconnue \"%s\"\n", lineNumber, p_command);
+}
+
+extern void Grammar_printState(long time, const Data_s *p_frame)
+{
+    printf("state %ld %d %d %d\n", time, p_frame->speed, p_frame->collision, p_frame->luminosity);
+}
+
+extern void Grammar_printAnswer(long time, const Data_s *p_frame, const int32_t *p_words)
+{
+    if (p_frame->order == O_ASK_LOG)
+    {
+        Grammar_printState(time, p_frame);
+    }
+    else if (p_frame->order == O_MISSION && p_frame->size == sizeof(MissionProgress_s))
+    {
+        const MissionProgress_s *p_progress = (const MissionProgress_s *)p_words;
+
+        printf("mission %ld %d %d %d\n", time, p_progress->step, p_progress->count, p_progress->status);
+    }
+    else if (p_frame->order == O_GOTO && p_frame->size == sizeof(NavigationProgress_s))
+    {
+        const NavigationProgress_s *p_progress = (const NavigationProgress_s *)p_words;
+
+        printf("goto %ld %d %d %d %d %d\n", time, p_progress->status, p_progress->waypoint, p_progress->count, p_progress->planningTime, p_progress->replans);
+    }
+    else if (p_frame->order == O_POSE && p_frame->size == sizeof(PoseReport_s))
+    {
+        const PoseReport_s *p_pose = (const PoseReport_s *)p_words;
+
+        printf("pose %ld %d %d %d\n", time, p_pose->x, p_pose->y, p_pose->heading);
+    }
+    else if (p_frame->order == O_HISTORY && p_frame->size >= (int)sizeof(HistoryHeader_s))
+    {
+        const HistoryHeader_s *p_header = (const HistoryHeader_s *)p_words;
+        const HistorySample_s *p_samples = (const HistorySample_s *)(p_header + 1);
+
+        if ((int)sizeof(HistoryHeader_s) + p_header->count * (int)sizeof(HistorySample_s) > p_frame->size)
+        {
+            return; // Truncated answer
+        }
+        printf("history %ld %d %d\n", time, p_header->now, p_header->count);
+        for (int i = 0; i < p_header->count; i++)
+        {
+            printf("sample %d %d %d %d\n", p_samples[i].time, p_samples[i].speed, p_samples[i].collision, p_samples[i].luminosity);
+        }
+    }
+    else if (p_frame->order == O_PROFILE)
+    {
+        const ProfileReport_s *p_reports = (const ProfileReport_s *)p_words;
+        const int count = p_frame->size / (int)sizeof(ProfileReport_s);
+
+        printf("profile %ld %d\n", time, count);
+        for (int i = 0; i < count; i++)
+        {
+            printf("region %d %u %u %u %u %u %u\n", p_reports[i].region, p_reports[i].calls, p_reports[i].nanoseconds,
+                   p_reports[i].cycles, p_reports[i].instructions, p_reports[i].cacheMisses, p_reports[i].branchMisses);
+        }
+    }
+    else if (p_frame->order == O_MAP && p_frame->size >= (int)sizeof(MapRegion_s))
+    {
+        static const char a_symbols[] = {'?', '.', '#', '!'};
+        const MapRegion_s *p_region = (const MapRegion_s *)p_words;
+        const uint32_t *p_cells = (const uint32_t *)(p_region + 1);
+        const int count = p_region->width * p_region->height;
+
+        if ((int)sizeof(MapRegion_s) + (count + 15) / 16 * (int)sizeof(uint32_t) > p_frame->size)
+        {
+            return; // Truncated answer
+        }
+        printf("map %ld %d %d %d %d ", time, p_region->column, p_region->row, p_region->width, p_region->height);
+        for (int i = 0; i < count; i++)
+        {
+            putchar(a_symbols[(p_cells[i / 16] >> (2 * (i % 16))) & 3]);
+        }
+        putchar('\n');
+    }
+}
+
+static void setOrder(Statement_s *p_statement, Order_e order, Direction_e direction, const void *payload, int size)
+{
+    p_statement->kind = ST_ORDER;
+    p_statement->order = order;
+    p_statement->direction = direction;
+    p_statement->size = size;
+    if (size > 0)
+    {
+        memcpy(p_statement->a_payload, payload, size);
+    }
+    p_statement->answered = (order == O_ASK_LOG || order == O_POSE || order == O_PROFILE || order == O_MISSION ||
+                             order == O_GOTO || order == O_HISTORY || order == O_MAP)
+                                ? TRUE
+                                : FALSE;
+}
+
+static void addStep(const char *direction, const char *power, const char *duration)
+{
+    if (direction == NULL || power == NULL || duration == NULL)
+    {
+        fprintf(stderr, "Ligne %d : step <direction> <puissance> <durée>\n", lineNumber);
+        return;
+    }
+    if (missionSize == MAX_MISSION_STEPS)
+    {
+        fprintf(stderr, "Ligne %d : mission trop longue (%d étapes au plus)\n", lineNumber, MAX_MISSION_STEPS);
+        return;
+    }
+    for (int i = 0; i < D_NB_DIRECTION; i++)
+    {
+        if (strcmp(direction, a_directions[i]) == 0)
+        {
+            a_mission[missionSize].direction = i;
+            a_mission[missionSize].power = atoi(power);
+            a_mission[missionSize].duration = atoi(duration);
+            missionSize++;
+            return;
+        }
+    }
+    fprintf(stderr, "Ligne %d : direction inconnue \"%s\"\n", lineNumber, direction);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file  grammar.h
+ *
+ * @brief  Commands of the scripts of telco -s and commando -s, and the printing of the answers
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _GRAMMAR_
+#define _GRAMMAR_
+
+#include <stdint.h>
+
+#include "../common.h"
+
+typedef enum
+{
+    ST_NONE = 0, // Empty line, comment, step of a mission or error already reported
+    ST_ORDER,    // An order to send
+    ST_WAIT,     // A wait before the next line
+    ST_QUIT,     // The last order, the script ends with it
+    ST_OTHER     // A command left to the program
+} StatementKind_e;
+
+/**
+ * @brief A line of a script
+ */
+typedef struct
+{
+    StatementKind_e kind;
+    Order_e order;                                    // ST_ORDER and ST_QUIT
+    Direction_e direction;                            // For O_CHANGE_MVT
+    int32_t a_payload[MAX_PAYLOAD / sizeof(int32_t)]; // Host byte order
+    int size;                                         // Bytes of payload
+    bool_e answered;                                  // An answer, or a final status, is awaited
+    long wait;                                        // ST_WAIT (ms)
+    const char *p_command;                            // ST_OTHER, its next arguments are left to strtok(NULL, ...)
+    const char *p_argument;                           // ST_OTHER, NULL without argument
+} Statement_s;
+
+/**
+ * @brief Reads a line of a script
+ *
+ * The steps of a mission are kept until the "mission" line which sends them.
+ *
+ * @param line The line, modified
+ * @param p_statement Where to write what the line asks for
+ */
+extern void Grammar_parse(char *line, Statement_s *p_statement);
+
+/**
+ * @brief Reports a command known neither by the grammar nor by the program
+ *
+ * @param p_command The command
+ */
+extern void Grammar_reject(const char *p_command);
+
+/**
+ * @brief Prints a state like the scripts do
+ *
+ * @param time Time of the script (ms)
+ * @param p_frame The frame, in host byte order
+ */
+extern void Grammar_printState(long time, const Data_s *p_frame);
+
+/**
+ * @brief Prints a state or an answer like the scripts do, other frames are left out
+ *
+ * @param time Time of the script (ms)
+ * @param p_frame The frame, in host byte order
+ * @param p_words Its payload, in host byte order
+ */
+extern void Grammar_printAnswer(long time, const Data_s *p_frame, const int32_t *p_words);
+
+#endif // _GRAMMAR_
@@ -0,0 +1,177 @@
+/**
+ * @file link.c
+ *
+ * @see link.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "../codec/codec.h"
+#include "link.h"
+
+/**
+ * @brief 32-bit words of a record
+ */
+#define RECORD_WORDS ((int)(sizeof(LinkRecord_s) / sizeof(int32_t)))
+
+extern void Link_parseAddress(const char *text, char *p_host, size_t size, int *p_port)
+{
+    const char *p_colon = strrchr(text, ':');
+    const int length = (p_colon != NULL) ? (int)(p_colon - text) : (int)strlen(text);
+
+    snprintf(p_host, size, "%.*s", length, text);
+    if (p_colon != NULL)
+    {
+        *p_port = atoi(p_colon + 1);
+    }
+}
+
+extern int Link_connect(const char *host, int port)
+{
+    struct addrinfo hints;
+    struct addrinfo *p_addresses;
+    char a_port[16];
+    int linkSocket = -1;
+    const int noDelay = 1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    snprintf(a_port, sizeof(a_port), "%d", port);
+    if (getaddrinfo(host, a_port, &hints, &p_addresses) != 0)
+    {
+        return -1;
+    }
+    for (struct addrinfo *p_address = p_addresses; p_address != NULL && linkSocket < 0; p_address = p_address->ai_next)
+    {
+        linkSocket = socket(p_address->ai_family, p_address->ai_socktype, p_address->ai_protocol);
+        if (linkSocket >= 0 && connect(linkSocket, p_address->ai_addr, p_address->ai_addrlen) != 0)
+        {
+            close(linkSocket);
+            linkSocket = -1;
+        }
+    }
+    freeaddrinfo(p_addresses);
+    if (linkSocket >= 0)
+    {
+        setsockopt(linkSocket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay)); // A frame is a batch already
+    }
+    return linkSocket;
+}
+
+extern int Link_listen(int port)
+{
+    struct sockaddr_in address;
+    const int reuse = 1;
+    const int listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (listenSocket < 0)
+    {
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(listenSocket, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listenSocket, SOMAXCONN) != 0)
+    {
+        close(listenSocket);
+        return -1;
+    }
+    return listenSocket;
+}
+
+extern void Link_attach(LinkPeer_s *p_peer, int socket)
+{
+    const int noDelay = 1;
+
+    p_peer->socket = socket;
+    p_peer->length = 0;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+}
+
+extern bool_e Link_send(int socket, const LinkRecord_s a_records[], int count)
+{
+    int32_t a_words[1 + MAX_LINK_RECORDS * RECORD_WORDS];
+    const int32_t header = count;
+    size_t length = (1 + count * RECORD_WORDS) * sizeof(int32_t);
+    const unsigned char *p_bytes = (const unsigned char *)a_words;
+
+    Codec_encodeWords(a_words, &header, 1);
+    Codec_encodeWords(a_words + 1, (const int32_t *)a_records, count * RECORD_WORDS);
+    while (length > 0)
+    {
+        const ssize_t written = send(socket, p_bytes, length, MSG_NOSIGNAL);
+
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            return FALSE;
+        }
+        p_bytes += written;
+        length -= written;
+    }
+    return TRUE;
+}
+
+extern bool_e Link_read(LinkPeer_s *p_peer)
+{
+    ssize_t received;
+
+    do
+    {
+        received = recv(p_peer->socket, p_peer->a_buffer + p_peer->length, sizeof(p_peer->a_buffer) - p_peer->length, 0);
+    } while (received < 0 && errno == EINTR);
+
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+        return TRUE; // Nothing yet
+    }
+    if (received <= 0)
+    {
+        return FALSE;
+    }
+    p_peer->length += received;
+    return TRUE;
+}
+
+extern int Link_next(LinkPeer_s *p_peer, LinkRecord_s a_records[], int size)
+{
+    int32_t count;
+
+    if (p_peer->length < sizeof(int32_t))
+    {
+        return 0;
+    }
+    memcpy(&count, p_peer->a_buffer, sizeof(int32_t));
+    Codec_decodeWords(&count, &count, 1);
+    if (count < 1 || count > MAX_LINK_RECORDS)
+    {
+        return -1;
+    }
+
+    const size_t length = sizeof(int32_t) + count * sizeof(LinkRecord_s);
+    if (p_peer->length < length || count > size)
+    {
+        return 0; // The rest of the frame is on its way, or the caller has no room yet
+    }
+    memcpy(a_records, p_peer->a_buffer + sizeof(int32_t), count * sizeof(LinkRecord_s));
+    Codec_decodeWords((int32_t *)a_records, (const int32_t *)a_records, count * RECORD_WORDS);
+    p_peer->length -= length;
+    memmove(p_peer->a_buffer, p_peer->a_buffer + length, p_peer->length);
+    return count;
+}
@@ -0,0 +1,161 @@
+/**
+ * @file  link.h
+ *
+ * @brief  Batched link between the commandos, the relay and a simulator of robots
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _LINK_
+#define _LINK_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../common.h"
+
+/**
+ * @brief Port of the relay for the commandos
+ */
+#define LINK_PORT (12350)
+
+/**
+ * @brief Port of the simulator for the relay
+ */
+#define SIMULATOR_PORT (12351)
+
+/**
+ * @brief Most records in a frame
+ */
+#define MAX_LINK_RECORDS (256)
+
+/**
+ * @brief Bytes kept for the frames not read completely yet
+ */
+#define LINK_BUFFER (4 * (1 + MAX_LINK_RECORDS * 8))
+
+typedef enum
+{
+    LK_SET_WHEELS = 0, // Applies right and left
+    LK_READ,           // Answered with luminosity, front and floor
+    LK_NB_OP
+} LinkOp_e;
+
+/**
+ * @brief A request or its answer, 32-bit integers in network byte order on the link
+ *
+ * A frame is the number of records, from 1 to MAX_LINK_RECORDS, followed by the records.
+ */
+typedef struct
+{
+    int32_t op;         // LinkOp_e
+    int32_t robot;      // Set by the relay toward the simulator, 0 from a commando
+    int32_t tag;        // Chosen by the sender, copied into the answer
+    int32_t status;     // Answer: 0, or -1 if the request failed
+    int32_t right;      // Motor commands
+    int32_t left;
+    int32_t luminosity; // Answer of LK_READ: light sensor (µV)
+    int32_t contacts;   // Answer of LK_READ: front in bit 0, floor in bit 1
+} LinkRecord_s;
+
+/**
+ * @brief One end of a link and the bytes received but not decoded yet
+ */
+typedef struct
+{
+    int socket;
+    size_t length;
+    unsigned char a_buffer[LINK_BUFFER];
+} LinkPeer_s;
+
+/**
+ * @brief Splits an address given as host[:port]
+ *
+ * @param text The address
+ * @param p_host Where to write the host
+ * @param size Room in p_host
+ * @param p_port Where to write the port, left as it is if the address has none
+ */
+extern void Link_parseAddress(const char *text, char *p_host, size_t size, int *p_port);
+
+/**
+ * @brief Connects to a relay or a simulator
+ *
+ * @param host Name or address
+ * @param port Port
+ * @return int The socket, -1 on failure
+ */
+extern int Link_connect(const char *host, int port);
+
+/**
+ * @brief Opens a listening socket on every address
+ *
+ * @param port Port
+ * @return int The socket, -1 on failure
+ */
+extern int Link_listen(int port);
+
+/**
+ * @brief Prepares a peer for a connected socket
+ *
+ * @param p_peer The peer
+ * @param socket The socket
+ */
+extern void Link_attach(LinkPeer_s *p_peer, int socket);
+
+/**
+ * @brief Sends records in one frame and one write
+ *
+ * @param socket The socket
+ * @param a_records The records, in host byte order
+ * @param count Number of records, at most MAX_LINK_RECORDS
+ * @return bool_e FALSE if the link is broken, or if a non-blocking socket has no room left (errno EAGAIN)
+ */
+extern bool_e Link_send(int socket, const LinkRecord_s a_records[], int count);
+
+/**
+ * @brief Reads the bytes waiting on the socket of a peer, blocks if it is blocking and nothing waits
+ *
+ * @param p_peer The peer
+ * @return bool_e FALSE if the link is closed or broken
+ */
+extern bool_e Link_read(LinkPeer_s *p_peer);
+
+/**
+ * @brief Takes the next complete frame out of the bytes read
+ *
+ * @param p_peer The peer
+ * @param a_records Where to write the records, in host byte order
+ * @param size Room in a_records, a larger frame is left where it is
+ * @return int Number of records, 0 if no frame is complete or fits, -1 if the frame is malformed
+ */
+extern int Link_next(LinkPeer_s *p_peer, LinkRecord_s a_records[], int size);
+
+#endif // _LINK_
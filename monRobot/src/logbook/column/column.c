@@ -0,0 +1,344 @@
+/**
+ * @file column.c
+ *
+ * @see column.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "column.h"
+
+/**
+ * @brief Identifies the columnar files, and their version
+ */
+#define MAGIC "ROBOLOG1"
+
+/**
+ * @brief Longest varint of a 64-bit value (bytes)
+ */
+#define MAX_VARINT (10)
+
+/**
+ * @brief Head of the file
+ */
+typedef struct
+{
+    char magic[8];
+    int64_t rows;
+    int32_t blockCount;
+    int32_t reserved[3]; // Up to COLUMN_ALIGN bytes
+} FileHeader_s;
+
+/**
+ * @brief Head of a block, followed by the columns, each one aligned on COLUMN_ALIGN
+ */
+typedef struct
+{
+    uint32_t rows;
+    uint32_t size; // Bytes of the whole block, header included
+    uint32_t timeBytes;
+    uint32_t reserved;
+    int64_t firstTime;
+    int64_t lastTime;
+} BlockHeader_s;
+
+/**
+ * @brief Bytes of a block of a number of rows, header included
+ *
+ * @param rows Number of rows
+ * @param timeBytes Bytes of the encoded timestamps
+ * @return size_t The size
+ */
+static size_t blockSize(size_t rows, size_t timeBytes);
+
+/**
+ * @brief Rounds a size up to COLUMN_ALIGN
+ *
+ * @param size The size
+ * @return size_t The rounded size
+ */
+static size_t align(size_t size);
+
+/**
+ * @brief Writes a complete block of the columns being built
+ *
+ * @param file The file
+ * @param rows Number of rows
+ * @return TRUE if written
+ */
+static bool_e writeBlock(FILE *file, int rows);
+
+/**
+ * @brief Writes bytes followed by the padding up to COLUMN_ALIGN
+ *
+ * @param file The file
+ * @param data The bytes
+ * @param size Number of bytes
+ * @return TRUE if written
+ */
+static bool_e writePadded(FILE *file, const void *data, size_t size);
+
+// Columns of the block being exported
+static int64_t a_times[COLUMN_BLOCK_ROWS];
+static uint8_t a_encodedTimes[COLUMN_BLOCK_ROWS * MAX_VARINT];
+static int16_t a_speeds[COLUMN_BLOCK_ROWS];
+static uint8_t a_collisions[COLUMN_BLOCK_ROWS];
+static int32_t a_luminosities[COLUMN_BLOCK_ROWS];
+
+extern int64_t Column_export(const char *recordPath, const char *columnPath)
+{
+    FILE *p_records = fopen(recordPath, "rb");
+    FILE *p_columns;
+    FileHeader_s header;
+    TelemetryRecord_s record;
+    int rows = 0;
+    bool_e ok = TRUE;
+
+    if (p_records == NULL)
+    {
+        fprintf(stderr, "Impossible d'ouvrir %s : %s\n", recordPath, strerror(errno));
+        return -1;
+    }
+    p_columns = fopen(columnPath, "wb");
+    if (p_columns == NULL)
+    {
+        fprintf(stderr, "Impossible de créer %s : %s\n", columnPath, strerror(errno));
+        fclose(p_records);
+        return -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(header.magic));
+    ok = (fwrite(&header, sizeof(header), 1, p_columns) == 1); // Completed at the end
+
+    while (ok == TRUE && fread(&record, sizeof(record), 1, p_records) == 1)
+    {
+        a_times[rows] = record.time;
+        a_speeds[rows] = (int16_t)record.speed;
+        a_collisions[rows] = (record.collision != 0);
+        a_luminosities[rows] = record.luminosity;
+        header.rows++;
+        if (++rows == COLUMN_BLOCK_ROWS)
+        {
+            ok = writeBlock(p_columns, rows);
+            header.blockCount++;
+            rows = 0;
+        }
+    }
+    if (ok == TRUE && rows > 0)
+    {
+        ok = writeBlock(p_columns, rows);
+        header.blockCount++;
+    }
+    if (ok == TRUE)
+    {
+        ok = (fseek(p_columns, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, p_columns) == 1);
+    }
+
+    fclose(p_records);
+    if (fclose(p_columns) != 0 || ok == FALSE)
+    {
+        fprintf(stderr, "Erreur lors de l'écriture de %s\n", columnPath);
+        return -1;
+    }
+    return header.rows;
+}
+
+extern bool_e Column_open(ColumnFile_s *file, const char *path)
+{
+    const int fd = open(path, O_RDONLY);
+    const FileHeader_s *p_header;
+    struct stat status;
+    size_t offset;
+    int64_t rows = 0; // Sum of the rows of the blocks
+
+    memset(file, 0, sizeof(*file));
+    if (fd < 0 || fstat(fd, &status) != 0 || (size_t)status.st_size < sizeof(FileHeader_s))
+    {
+        fprintf(stderr, "Impossible de lire %s\n", path);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return FALSE;
+    }
+    file->size = status.st_size;
+    file->p_map = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays
+    if (file->p_map == MAP_FAILED)
+    {
+        fprintf(stderr, "Impossible de projeter %s : %s\n", path, strerror(errno));
+        file->p_map = NULL;
+        return FALSE;
+    }
+    madvise((void *)file->p_map, file->size, MADV_SEQUENTIAL);
+
+    p_header = (const FileHeader_s *)file->p_map;
+    if (memcmp(p_header->magic, MAGIC, sizeof(p_header->magic)) != 0 || p_header->blockCount < 0)
+    {
+        fprintf(stderr, "%s n'est pas un fichier de logbook\n", path);
+        Column_close(file);
+        return FALSE;
+    }
+    file->rows = p_header->rows;
+    file->blockCount = p_header->blockCount;
+    file->p_offsets = (size_t *)malloc(((size_t)file->blockCount + 1) * sizeof(size_t));
+    if (file->p_offsets == NULL)
+    {
+        fprintf(stderr, "Mémoire insuffisante pour %s\n", path);
+        Column_close(file);
+        return FALSE;
+    }
+
+    // Checks that every block lies in the file and holds what its header says, the readers trust them
+    offset = sizeof(FileHeader_s);
+    for (int i = 0; i < file->blockCount; i++)
+    {
+        const BlockHeader_s *p_block;
+
+        if (offset + sizeof(BlockHeader_s) > file->size)
+        {
+            fprintf(stderr, "%s est tronqué (bloc %d)\n", path, i);
+            Column_close(file);
+            return FALSE;
+        }
+        p_block = (const BlockHeader_s *)(file->p_map + offset);
+        if (p_block->rows < 1 || p_block->rows > COLUMN_BLOCK_ROWS || (size_t)p_block->timeBytes > (size_t)p_block->rows * MAX_VARINT ||
+            (size_t)p_block->size < blockSize(p_block->rows, p_block->timeBytes) || offset + p_block->size > file->size)
+        {
+            fprintf(stderr, "%s est tronqué ou corrompu (bloc %d)\n", path, i);
+            Column_close(file);
+            return FALSE;
+        }
+        file->p_offsets[i] = offset;
+        offset += p_block->size;
+        rows += p_block->rows;
+    }
+    if (rows != file->rows)
+    {
+        fprintf(stderr, "%s est corrompu : %ld lignes annoncées, %ld dans les blocs\n", path, (long)file->rows, (long)rows);
+        Column_close(file);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+extern void Column_close(ColumnFile_s *file)
+{
+    if (file->p_map != NULL)
+    {
+        munmap((void *)file->p_map, file->size);
+    }
+    free(file->p_offsets);
+    memset(file, 0, sizeof(*file));
+}
+
+extern ColumnBlock_s Column_getBlock(const ColumnFile_s *file, int index)
+{
+    const uint8_t *p_start = file->p_map + file->p_offsets[index];
+    const BlockHeader_s *p_header = (const BlockHeader_s *)p_start;
+    const uint8_t *p_column = p_start + sizeof(BlockHeader_s);
+    ColumnBlock_s block;
+
+    block.rows = p_header->rows;
+    block.firstTime = p_header->firstTime;
+    block.lastTime = p_header->lastTime;
+    block.p_times = p_column;
+    block.timeBytes = p_header->timeBytes;
+    p_column += align(p_header->timeBytes);
+    block.p_speeds = (const int16_t *)p_column;
+    p_column += align(block.rows * sizeof(int16_t));
+    block.p_collisions = p_column;
+    p_column += align(block.rows);
+    block.p_luminosities = (const int32_t *)p_column;
+    return block;
+}
+
+extern void Column_decodeTimes(const ColumnBlock_s *block, int64_t *times)
+{
+    const uint8_t *p_byte = block->p_times;
+    const uint8_t *p_end = block->p_times + block->timeBytes;
+    int64_t time = block->firstTime;
+
+    for (int i = 0; i < block->rows; i++)
+    {
+        uint64_t value = 0;
+        int shift = 0;
+
+        while (p_byte < p_end && shift < 64)
+        {
+            const uint8_t byte = *p_byte++;
+
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            shift += 7;
+            if ((byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+        time += (int64_t)(value >> 1) ^ -(int64_t)(value & 1); // Zigzag
+        times[i] = time;
+    }
+}
+
+static size_t blockSize(size_t rows, size_t timeBytes)
+{
+    return sizeof(BlockHeader_s) + align(timeBytes) + align(rows * sizeof(int16_t)) + align(rows) + align(rows * sizeof(int32_t));
+}
+
+static size_t align(size_t size)
+{
+    return (size + COLUMN_ALIGN - 1) & ~(size_t)(COLUMN_ALIGN - 1);
+}
+
+static bool_e writeBlock(FILE *file, int rows)
+{
+    BlockHeader_s header;
+    size_t timeBytes = 0;
+    int64_t previous = a_times[0];
+
+    for (int i = 0; i < rows; i++)
+    {
+        const int64_t delta = a_times[i] - previous;
+        uint64_t value = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63); // Zigzag, small when close to 0
+
+        previous = a_times[i];
+        do
+        {
+            a_encodedTimes[timeBytes++] = (value & 0x7F) | ((value > 0x7F) ? 0x80 : 0);
+            value >>= 7;
+        } while (value != 0);
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.rows = rows;
+    header.timeBytes = timeBytes;
+    header.firstTime = a_times[0];
+    header.lastTime = a_times[rows - 1];
+    header.size = blockSize(rows, timeBytes);
+
+    return (fwrite(&header, sizeof(header), 1, file) == 1 &&
+            writePadded(file, a_encodedTimes, timeBytes) &&
+            writePadded(file, a_speeds, rows * sizeof(int16_t)) &&
+            writePadded(file, a_collisions, rows) &&
+            writePadded(file, a_luminosities, rows * sizeof(int32_t)))
+               ? TRUE
+               : FALSE;
+}
+
+static bool_e writePadded(FILE *file, const void *data, size_t size)
+{
+    static const uint8_t a_zeros[COLUMN_ALIGN] = {0};
+    const size_t padding = align(size) - size;
+
+    return (fwrite(data, 1, size, file) == size && fwrite(a_zeros, 1, padding, file) == padding) ? TRUE : FALSE;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file  column.h
+ *
+ * @brief  Columnar file of the recorded telemetry, read through mmap()
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _COLUMN_
+#define _COLUMN_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../../common.h"
+
+/**
+ * @brief Rows per block, the blocks are independent
+ */
+#define COLUMN_BLOCK_ROWS (65536)
+
+/**
+ * @brief Alignment of the blocks and of the columns in the file (bytes)
+ */
+#define COLUMN_ALIGN (32)
+
+/**
+ * @brief A block of the file, the columns point into the mapped file
+ *
+ * The timestamps are zigzag varints of the differences with the previous
+ * row (the first one with firstTime), the values have a fixed width.
+ */
+typedef struct
+{
+    int rows;
+    int64_t firstTime; // ms since the epoch
+    int64_t lastTime;
+    const uint8_t *p_times;
+    size_t timeBytes;
+    const int16_t *p_speeds;
+    const uint8_t *p_collisions;
+    const int32_t *p_luminosities;
+} ColumnBlock_s;
+
+/**
+ * @brief A columnar file mapped in memory
+ */
+typedef struct
+{
+    const uint8_t *p_map;
+    size_t size;
+    int64_t rows;
+    int blockCount;
+    size_t *p_offsets; // Offset of each block
+} ColumnFile_s;
+
+/**
+ * @brief Converts a record of telco -r into a columnar file
+ *
+ * @param recordPath File of TelemetryRecord_s
+ * @param columnPath File to write (replaced)
+ * @return int64_t Number of rows written, -1 on error
+ */
+extern int64_t Column_export(const char *recordPath, const char *columnPath);
+
+/**
+ * @brief Maps a columnar file and checks its blocks
+ *
+ * @param file Where to describe the file
+ * @param path Path of the file
+ * @return TRUE if the file can be read
+ */
+extern bool_e Column_open(ColumnFile_s *file, const char *path);
+
+/**
+ * @brief Unmaps a columnar file
+ *
+ * @param file The file
+ */
+extern void Column_close(ColumnFile_s *file);
+
+/**
+ * @brief Gives a block of the file
+ *
+ * @param file The file
+ * @param index Index of the block
+ * @return ColumnBlock_s The block
+ */
+extern ColumnBlock_s Column_getBlock(const ColumnFile_s *file, int index);
+
+/**
+ * @brief Decodes the timestamps of a block
+ *
+ * @param block The block
+ * @param times Where to write the times (block->rows values)
+ */
+extern void Column_decodeTimes(const ColumnBlock_s *block, int64_t *times);
+
+#endif // _COLUMN_
@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../common.h"
+#include "column/column.h"
+#include "query/query.h"
+
+/**
+ * @brief Widest histogram of the luminosities (values)
+ */
+#define MAX_HISTOGRAM (1 << 24)
+
+/**
+ * @brief Displays the commands of logbook
+ *
+ * @param program Name of the program
+ */
+static void usage(const char *program);
+
+/**
+ * @brief Counts the contacts per hour
+ *
+ * @param file The columnar file
+ */
+static void bumps(const ColumnFile_s *file);
+
+/**
+ * @brief Displays percentiles of the luminosity
+ *
+ * @param file The columnar file
+ * @param percentiles The percentiles asked (0 to 100)
+ * @param count Number of percentiles
+ */
+static void light(const ColumnFile_s *file, const double *percentiles, int count);
+
+/**
+ * @brief Displays the mean speed and the moving time
+ *
+ * @param file The columnar file
+ */
+static void speed(const ColumnFile_s *file);
+
+/**
+ * @brief Displays the hour of a time with its number of contacts
+ *
+ * @param hour Start of the hour (s since the epoch)
+ * @param count Number of contacts
+ */
+static void printHour(time_t hour, int64_t count);
+
+int main(int argc, char *argv[])
+{
+    ColumnFile_s file;
+
+    if (argc == 4 && strcmp(argv[1], "export") == 0)
+    {
+        const int64_t rows = Column_export(argv[2], argv[3]);
+
+        if (rows < 0)
+        {
+            return EXIT_FAILURE;
+        }
+        printf("%ld lignes exportées\n", (long)rows);
+        return EXIT_SUCCESS;
+    }
+    if (argc < 3 || (strcmp(argv[1], "bumps") != 0 && strcmp(argv[1], "light") != 0 && strcmp(argv[1], "speed") != 0))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (Column_open(&file, argv[2]) == FALSE)
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (file.rows == 0)
+    {
+        printf("Aucune ligne\n");
+    }
+    else if (strcmp(argv[1], "bumps") == 0)
+    {
+        bumps(&file);
+    }
+    else if (strcmp(argv[1], "light") == 0)
+    {
+        double a_percentiles[16] = {50, 90, 99};
+        int count = (argc > 3) ? 0 : 3;
+
+        for (int i = 3; i < argc && count < 16; i++)
+        {
+            a_percentiles[count++] = atof(argv[i]);
+        }
+        light(&file, a_percentiles, count);
+    }
+    else
+    {
+        speed(&file);
+    }
+
+    Column_close(&file);
+    return EXIT_SUCCESS;
+}
+
+static void usage(const char *program)
+{
+    printf("Usage : %s <commande>\n", program);
+    printf("  export <enregistrement> <fichier> : convertit un enregistrement de telco -r en colonnes\n");
+    printf("  bumps <fichier>                   : nombre de contacts par heure\n");
+    printf("  light <fichier> [centiles...]     : centiles de la luminosité (par défaut 50 90 99)\n");
+    printf("  speed <fichier>                   : vitesse moyenne et temps en mouvement\n");
+}
+
+static void bumps(const ColumnFile_s *file)
+{
+    int64_t *p_times = (int64_t *)malloc(COLUMN_BLOCK_ROWS * sizeof(int64_t));
+    int *p_edges = (int *)malloc(COLUMN_BLOCK_ROWS * sizeof(int));
+    time_t hour = -1;
+    int64_t count = 0;
+    int64_t total = 0;
+    uint8_t previous = 0;
+
+    if (p_times == NULL || p_edges == NULL)
+    {
+        perror("Mémoire insuffisante");
+        free(p_times);
+        free(p_edges);
+        return;
+    }
+    for (int b = 0; b < file->blockCount; b++)
+    {
+        const ColumnBlock_s block = Column_getBlock(file, b);
+        const int edges = Query_findEdges(block.p_collisions, block.rows, previous, p_edges);
+
+        previous = block.p_collisions[block.rows - 1];
+        if (edges == 0)
+        {
+            continue; // The times are decoded only for the blocks with contacts
+        }
+        Column_decodeTimes(&block, p_times);
+        for (int e = 0; e < edges; e++)
+        {
+            const time_t edgeHour = (time_t)(p_times[p_edges[e]] / 1000) / 3600 * 3600;
+
+            if (edgeHour != hour)
+            {
+                printHour(hour, count);
+                hour = edgeHour;
+                count = 0;
+            }
+            count++;
+            total++;
+        }
+    }
+    printHour(hour, count);
+    printf("Total : %ld contacts\n", (long)total);
+
+    free(p_times);
+    free(p_edges);
+}
+
+static void light(const ColumnFile_s *file, const double *percentiles, int count)
+{
+    int32_t min = INT32_MAX;
+    int32_t max = INT32_MIN;
+    int64_t *p_counts;
+    int64_t size;
+
+    for (int b = 0; b < file->blockCount; b++)
+    {
+        const ColumnBlock_s block = Column_getBlock(file, b);
+        int32_t low;
+        int32_t high;
+
+        Query_range(block.p_luminosities, block.rows, &low, &high);
+        min = (low < min) ? low : min;
+        max = (high > max) ? high : max;
+    }
+    size = (int64_t)max - min + 1;
+    if (size > MAX_HISTOGRAM)
+    {
+        printf("Luminosités trop dispersées (%d à %d)\n", min, max);
+        return;
+    }
+
+    // Exact percentiles: the luminosities are integers in a small range
+    p_counts = (int64_t *)calloc(size, sizeof(int64_t));
+    if (p_counts == NULL)
+    {
+        perror("Mémoire insuffisante");
+        return;
+    }
+    for (int b = 0; b < file->blockCount; b++)
+    {
+        const ColumnBlock_s block = Column_getBlock(file, b);
+
+        Query_count(block.p_luminosities, block.rows, min, p_counts, size);
+    }
+
+    printf("Luminosité : min %d, max %d\n", min, max);
+    for (int p = 0; p < count; p++)
+    {
+        const double percentile = (percentiles[p] < 0) ? 0 : (percentiles[p] > 100) ? 100 : percentiles[p];
+        int64_t rank = (int64_t)(percentile / 100.0 * (file->rows - 1)); // Nearest rank below
+        int64_t value = 0;
+
+        while (rank >= p_counts[value])
+        {
+            rank -= p_counts[value++];
+        }
+        printf("  p%g : %ld\n", percentile, (long)(value + min));
+    }
+    free(p_counts);
+}
+
+static void speed(const ColumnFile_s *file)
+{
+    int64_t sum = 0;
+    int64_t moving = 0;
+    int64_t firstTime = Column_getBlock(file, 0).firstTime;
+    int64_t lastTime = Column_getBlock(file, file->blockCount - 1).lastTime;
+
+    for (int b = 0; b < file->blockCount; b++)
+    {
+        const ColumnBlock_s block = Column_getBlock(file, b);
+
+        sum += Query_sumSpeeds(block.p_speeds, block.rows, &moving);
+    }
+    printf("%ld états sur %.1f s\n", (long)file->rows, (lastTime - firstTime) / 1000.0);
+    printf("Vitesse moyenne : %.1f (en mouvement : %.1f)\n", (double)sum / file->rows, (moving > 0) ? (double)sum / moving : 0.0);
+    printf("En mouvement : %.1f %% des états\n", 100.0 * moving / file->rows);
+}
+
+static void printHour(time_t hour, int64_t count)
+{
+    char a_text[32];
+    struct tm date;
+
+    if (hour < 0)
+    {
+        return;
+    }
+    localtime_r(&hour, &date);
+    strftime(a_text, sizeof(a_text), "%Y-%m-%d %Hh", &date);
+    printf("%s : %ld\n", a_text, (long)count);
+}
@@ -0,0 +1,152 @@
+/**
+ * @file query.c
+ *
+ * @see query.h
+ *
+ * The columns are 32 bytes aligned, the kernels load them with aligned
+ * SSE2 instructions (baseline of x86-64) and finish the rows left with
+ * the scalar code, which is also the whole kernel on other targets.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdlib.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "query.h"
+
+extern int Query_findEdges(const uint8_t *collisions, int rows, uint8_t previous, int *edges)
+{
+    int count = 0;
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 16 <= rows; i += 16)
+    {
+        const __m128i current = _mm_load_si128((const __m128i *)(collisions + i));
+        // Bit n: contact on row i + n, and no contact on row i + n - 1
+        unsigned int pressed = ~_mm_movemask_epi8(_mm_cmpeq_epi8(current, zero)) & 0xFFFF;
+        unsigned int rising = pressed & ~((pressed << 1) | (previous != 0));
+
+        while (rising != 0)
+        {
+            edges[count++] = i + __builtin_ctz(rising);
+            rising &= rising - 1;
+        }
+        previous = collisions[i + 15];
+    }
+#endif
+    for (; i < rows; i++)
+    {
+        if (collisions[i] != 0 && previous == 0)
+        {
+            edges[count++] = i;
+        }
+        previous = collisions[i];
+    }
+    return count;
+}
+
+extern void Query_range(const int32_t *luminosities, int rows, int32_t *min, int32_t *max)
+{
+    int32_t low = luminosities[0];
+    int32_t high = luminosities[0];
+    int i = 0;
+
+#ifdef __SSE2__
+    if (rows >= 4)
+    {
+        __m128i vectorLow = _mm_load_si128((const __m128i *)luminosities);
+        __m128i vectorHigh = vectorLow;
+        int32_t a_lanes[4];
+
+        // SSE2 has no min/max on 32 bits, they are made with a comparison and a blend
+        for (i = 4; i + 4 <= rows; i += 4)
+        {
+            const __m128i value = _mm_load_si128((const __m128i *)(luminosities + i));
+            const __m128i lower = _mm_cmpgt_epi32(vectorLow, value);
+            const __m128i higher = _mm_cmpgt_epi32(value, vectorHigh);
+
+            vectorLow = _mm_or_si128(_mm_and_si128(lower, value), _mm_andnot_si128(lower, vectorLow));
+            vectorHigh = _mm_or_si128(_mm_and_si128(higher, value), _mm_andnot_si128(higher, vectorHigh));
+        }
+        _mm_storeu_si128((__m128i *)a_lanes, vectorLow);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            low = (a_lanes[lane] < low) ? a_lanes[lane] : low;
+        }
+        _mm_storeu_si128((__m128i *)a_lanes, vectorHigh);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            high = (a_lanes[lane] > high) ? a_lanes[lane] : high;
+        }
+    }
+#endif
+    for (; i < rows; i++)
+    {
+        low = (luminosities[i] < low) ? luminosities[i] : low;
+        high = (luminosities[i] > high) ? luminosities[i] : high;
+    }
+    *min = low;
+    *max = high;
+}
+
+extern void Query_count(const int32_t *luminosities, int rows, int32_t min, int64_t *counts, int64_t size)
+{
+    for (int i = 0; i < rows; i++)
+    {
+        const int64_t index = (int64_t)luminosities[i] - min;
+
+        if (index >= 0 && index < size)
+        {
+            counts[index]++;
+        }
+    }
+}
+
+extern int64_t Query_sumSpeeds(const int16_t *speeds, int rows, int64_t *moving)
+{
+    int64_t sum = 0;
+    int64_t count = 0;
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+
+    while (i + 8 <= rows)
+    {
+        __m128i sums = zero;
+        __m128i counts = zero;
+        // 2 * 32767 per lane and per step, the 32-bit lanes are emptied before overflowing
+        const int end = (rows - i > 8 * 16384) ? i + 8 * 16384 : rows - (rows - i) % 8;
+        int32_t a_lanes[4];
+
+        for (; i < end; i += 8)
+        {
+            const __m128i speed = _mm_load_si128((const __m128i *)(speeds + i));
+            // |speed|, -32768 stays -32768 as in the scalar int16 arithmetic, it is out of the robot range
+            const __m128i magnitude = _mm_max_epi16(speed, _mm_sub_epi16(zero, speed));
+
+            sums = _mm_add_epi32(sums, _mm_madd_epi16(magnitude, one));
+            counts = _mm_sub_epi16(counts, _mm_xor_si128(_mm_cmpeq_epi16(speed, zero), _mm_set1_epi16(-1))); // +1 per moving row
+        }
+        _mm_storeu_si128((__m128i *)a_lanes, sums);
+        sum += (int64_t)a_lanes[0] + a_lanes[1] + a_lanes[2] + a_lanes[3];
+        _mm_storeu_si128((__m128i *)a_lanes, _mm_madd_epi16(counts, one));
+        count += (int64_t)a_lanes[0] + a_lanes[1] + a_lanes[2] + a_lanes[3];
+    }
+#endif
+    for (; i < rows; i++)
+    {
+        sum += abs(speeds[i]);
+        count += (speeds[i] != 0);
+    }
+    *moving += count;
+    return sum;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file  query.h
+ *
+ * @brief  Scan kernels of the logbook over the columns of a block
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _QUERY_
+#define _QUERY_
+
+#include <stdint.h>
+
+#include "../column/column.h"
+
+/**
+ * @brief Finds the rows where a contact starts
+ *
+ * @param collisions Column of the contacts (0 or 1)
+ * @param rows Number of rows
+ * @param previous Contact of the row before the first one
+ * @param edges Where to write the indexes of the rising edges (up to rows)
+ * @return int Number of edges found
+ */
+extern int Query_findEdges(const uint8_t *collisions, int rows, uint8_t previous, int *edges);
+
+/**
+ * @brief Gives the extrema of a column of luminosities
+ *
+ * @param luminosities The column
+ * @param rows Number of rows, at least 1
+ * @param min Where to write the minimum
+ * @param max Where to write the maximum
+ */
+extern void Query_range(const int32_t *luminosities, int rows, int32_t *min, int32_t *max);
+
+/**
+ * @brief Counts each luminosity between min and max in a histogram
+ *
+ * @param luminosities The column
+ * @param rows Number of rows
+ * @param min First value of the histogram
+ * @param counts Counters of min, min + 1... increased
+ * @param size Number of counters, the values beyond are ignored
+ */
+extern void Query_count(const int32_t *luminosities, int rows, int32_t min, int64_t *counts, int64_t size);
+
+/**
+ * @brief Sums the absolute speeds and counts the moving rows
+ *
+ * @param speeds The column
+ * @param rows Number of rows
+ * @param moving Where to add the number of rows with a non null speed
+ * @return int64_t Sum of the absolute speeds
+ */
+extern int64_t Query_sumSpeeds(const int16_t *speeds, int rows, int64_t *moving);
+
+#endif // _QUERY_
@@ -0,0 +1,97 @@
+/**
+ * @file intox.c
+ *
+ * @see intox.h
+ *
+ * libinfox is linked once, in the relay: the commandos started with -x
+ * reach Intox through it without linking it themselves. Each call waits
+ * for Intox on the network, a batch takes as long as its records.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../common.h"
+#include "../../link/link.h"
+#include "intox.h"
+
+/**
+ * @brief Wiring of the robot, the same as for a commando on Intox
+ */
+#define LEFT_MOTOR MD
+#define RIGHT_MOTOR MA
+#define LIGHT_SENSOR S1
+#define FRONT_BUMPER S3
+#define FLOOR_SENSOR S2
+
+/**
+ * @brief The robot of Intox, the only one it simulates
+ */
+#define INTOX_ROBOT (1)
+
+static Motor *p_right = NULL;
+static Motor *p_left = NULL;
+static ContactSensor *p_front = NULL;
+static ContactSensor *p_floor = NULL;
+static LightSensor *p_light = NULL;
+
+extern void Intox_open(const char *host, int port)
+{
+    if (ProSE_Intox_init(host, port) != 0)
+    {
+        printf("%sIntox injoignable : %s:%d%s\n", "\033[41m", host, port, "\033[0m");
+        exit(EXIT_FAILURE);
+    }
+    p_right = Motor_open(RIGHT_MOTOR);
+    p_left = Motor_open(LEFT_MOTOR);
+    p_front = ContactSensor_open(FRONT_BUMPER);
+    p_floor = ContactSensor_open(FLOOR_SENSOR);
+    p_light = LightSensor_open(LIGHT_SENSOR);
+    if (p_right == NULL || p_left == NULL || p_front == NULL || p_floor == NULL || p_light == NULL)
+    {
+        PProseError("Problème d'ouverture des moteurs ou des capteurs du robot d'Intox");
+        exit(EXIT_FAILURE);
+    }
+}
+
+extern void Intox_answer(LinkRecord_s a_records[], int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        LinkRecord_s *p_record = &a_records[i];
+
+        p_record->status = -1;
+        if (p_record->robot != INTOX_ROBOT)
+        {
+            continue;
+        }
+        if (p_record->op == LK_SET_WHEELS)
+        {
+            if (Motor_setCmd(p_right, p_record->right) == 0 && Motor_setCmd(p_left, p_record->left) == 0)
+            {
+                p_record->status = 0;
+            }
+        }
+        else if (p_record->op == LK_READ)
+        {
+            p_record->right = Motor_getCmd(p_right);
+            p_record->left = Motor_getCmd(p_left);
+            p_record->luminosity = (int32_t)(LightSensor_getStatus(p_light) * 1000); // mV to µV
+            p_record->contacts = ((ContactSensor_getStatus(p_front) != RELEASED) ? 1 : 0) |
+                                 ((ContactSensor_getStatus(p_floor) != RELEASED) ? 2 : 0);
+            p_record->status = 0;
+        }
+    }
+}
+
+extern void Intox_close()
+{
+    Motor_close(p_right);
+    Motor_close(p_left);
+    ContactSensor_close(p_front);
+    ContactSensor_close(p_floor);
+    LightSensor_close(p_light);
+    ProSE_Intox_close();
+}
@@ -0,0 +1,71 @@
+/**
+ * @file  intox.h
+ *
+ * @brief  Upstream of the relay toward Intox, through libinfox
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _INTOX_
+#define _INTOX_
+
+#include "../../common.h"
+#include "../../link/link.h"
+
+/**
+ * @brief Default port of Intox, as for commando -i
+ */
+#define INTOX_PORT (12345)
+
+/**
+ * @brief Connects to Intox and opens the motors and the sensors of its robot
+ *
+ * @param host Name or address of Intox
+ * @param port Port of Intox
+ */
+extern void Intox_open(const char *host, int port);
+
+/**
+ * @brief Executes the records of a batch on the robot of Intox
+ *
+ * Intox simulates a single robot: only the records of the robot 1, the
+ * first commando of the relay, are executed, the others fail.
+ *
+ * @param a_records The requests, replaced by the answers
+ * @param count Number of records
+ */
+extern void Intox_answer(LinkRecord_s a_records[], int count);
+
+/**
+ * @brief Closes the motors, the sensors and the link with Intox
+ */
+extern void Intox_close();
+
+#endif // _INTOX_
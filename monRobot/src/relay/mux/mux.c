@@ -0,0 +1,542 @@
+/**
+ * @file mux.c
+ *
+ * @see mux.h
+ *
+ * A single batch is with the simulator at a time. The requests arriving
+ * meanwhile wait together and leave in one frame when its answers come
+ * back: the slower the simulator, the larger the batches, and the link
+ * carries one frame per round trip whatever the number of commandos.
+ *
+ * Toward the simulator, the robot of a record is the slot of its commando
+ * plus one and its tag is the number of the batch and its place in it; the
+ * answers are sent back to the commandos with their own tags. A batch whose
+ * answers do not all come back within BATCH_TIMEOUT is given up: its
+ * requests are answered as failed, its late answers are told apart by
+ * their number.
+ *
+ * Toward Intox, the batch is executed through libinfox before the loop
+ * goes on: the requests arriving meanwhile make the next batch all the same.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+
+#include "../../common.h"
+#include "../../link/link.h"
+#include "../../clock/clock.h"
+#include "../intox/intox.h"
+#include "mux.h"
+
+/**
+ * @brief Longest wait for the answers of a batch (ms), the simulator may lose some
+ */
+#define BATCH_TIMEOUT (1000)
+
+/**
+ * @brief Numbers of batches told apart by the tags
+ */
+#define BATCH_NUMBERS (INT32_MAX / MAX_LINK_RECORDS)
+
+/**
+ * @brief A commando served by the relay
+ */
+typedef struct
+{
+    LinkPeer_s peer;     // Socket -1: free slot
+    uint32_t generation; // Changes when the slot is given to another commando
+    unsigned long requests;
+    unsigned long answers;
+    int64_t meanLatency; // µs, from the arrival of the request to its answer
+    int64_t maxLatency;  // µs
+} Commando_s;
+
+/**
+ * @brief Where a record of a batch comes from
+ */
+typedef struct
+{
+    int slot;
+    uint32_t generation;
+    int32_t tag;     // Tag given by the commando
+    int64_t arrival; // µs
+    bool_e answered; // In the batch with the simulator, its answer came back
+} Origin_s;
+
+/**
+ * @brief Takes the frames of the commandos while the next batch has room
+ *
+ * @param time Current time (µs)
+ */
+static void gather(int64_t time);
+
+/**
+ * @brief Sends the waiting requests to the simulator in one frame
+ */
+static void flush();
+
+/**
+ * @brief Answers as failed the requests of the batch still with the simulator
+ *
+ * @param time Current time (µs)
+ */
+static void giveUp(int64_t time);
+
+/**
+ * @brief Sends the answers of the simulator back, one frame per commando
+ *
+ * @param a_answers The answers
+ * @param count Number of answers
+ * @param time Current time (µs)
+ */
+static void dispatch(LinkRecord_s a_answers[], int count, int64_t time);
+
+/**
+ * @brief Accepts a commando in a free slot
+ */
+static void welcome();
+
+/**
+ * @brief Frees the slot of a commando
+ *
+ * @param slot The slot
+ */
+static void dismiss(int slot);
+
+/**
+ * @brief Displays the counters of the relay and of each commando
+ */
+static void printStats();
+
+/**
+ * @brief Asks the loop to stop
+ *
+ * @param signal The signal received
+ */
+static void onSignal(int signal);
+
+/**
+ * @brief Asks the loop to display the counters
+ *
+ * @param signal The signal received
+ */
+static void onStatsSignal(int signal);
+
+static Commando_s a_commandos[MAX_COMMANDOS];
+static LinkPeer_s simulator; // Socket -1 toward Intox
+static bool_e throughIntox = FALSE;
+static int listenSocket = -1;
+static LinkRecord_s a_waiting[MAX_LINK_RECORDS]; // The next batch
+static Origin_s a_waitingOrigins[MAX_LINK_RECORDS];
+static int waitingCount = 0;
+static Origin_s a_inFlight[MAX_LINK_RECORDS]; // The batch with the simulator, by place
+static LinkRecord_s a_inFlightRecords[MAX_LINK_RECORDS];
+static int inFlightCount = 0;
+static int answeredCount = 0;
+static int32_t batchBase = 0;  // Tag of the first place of the batch with the simulator
+static int64_t flushTime = 0;  // µs
+static unsigned long batchesLost = 0;
+static int nextSlot = 0; // First commando gathered, in turn
+static unsigned long batchCount = 0;
+static unsigned long recordCount = 0;
+static volatile sig_atomic_t work;
+static volatile sig_atomic_t statsRequested = 0;
+static int64_t lastStats = 0;             // µs
+static unsigned long lastStatsBatches = 0; // Nothing new, nothing displayed
+
+extern void Mux_new(int port, const char *host, int simulatorPort, bool_e intox)
+{
+    for (int i = 0; i < MAX_COMMANDOS; i++)
+    {
+        a_commandos[i].peer.socket = -1;
+    }
+    listenSocket = Link_listen(port);
+    if (listenSocket < 0)
+    {
+        perror("Erreur lors de l'ouverture du port des commandos");
+        exit(EXIT_FAILURE);
+    }
+
+    throughIntox = intox;
+    if (intox == TRUE)
+    {
+        Intox_open(host, simulatorPort);
+        simulator.socket = -1; // Not polled
+        printf("%sRelais prêt sur le port %d, Intox %s:%d (robot 1 seulement)%s\n", "\033[32m", port, host, simulatorPort, "\033[0m");
+        return;
+    }
+
+    const int simulatorSocket = Link_connect(host, simulatorPort);
+    if (simulatorSocket < 0)
+    {
+        printf("%sSimulateur injoignable : %s:%d%s\n", "\033[41m", host, simulatorPort, "\033[0m");
+        exit(EXIT_FAILURE);
+    }
+    Link_attach(&simulator, simulatorSocket);
+    printf("%sRelais prêt sur le port %d, simulateur %s:%d%s\n", "\033[32m", port, host, simulatorPort, "\033[0m");
+}
+
+extern void Mux_start()
+{
+    struct pollfd a_polls[2 + MAX_COMMANDOS];
+    int a_slots[2 + MAX_COMMANDOS]; // Slot of each commando polled
+    struct sigaction action;
+
+    // Without SA_RESTART, poll() is interrupted and the loop ends
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &onSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    action.sa_handler = &onStatsSignal;
+    sigaction(SIGUSR1, &action, NULL);
+
+    work = TRUE;
+    lastStats = Clock_monotonic();
+    while (work == TRUE)
+    {
+        int pollCount = 2;
+
+        // A single recv() follows each readiness. The commandos are not blocking, one
+        // of them no longer reading cannot hold the others and the simulator back
+        a_polls[0].fd = listenSocket;
+        a_polls[0].events = POLLIN;
+        a_polls[1].fd = simulator.socket;
+        a_polls[1].events = POLLIN;
+        for (int i = 0; i < MAX_COMMANDOS; i++)
+        {
+            // A full buffer holds a whole frame, taken once the batch has room
+            if (a_commandos[i].peer.socket >= 0 && a_commandos[i].peer.length < LINK_BUFFER)
+            {
+                a_polls[pollCount].fd = a_commandos[i].peer.socket;
+                a_polls[pollCount].events = POLLIN;
+                a_slots[pollCount] = i;
+                pollCount++;
+            }
+        }
+        int timeout = STATS_PERIOD;
+        if (inFlightCount > 0)
+        {
+            const int64_t left = flushTime + BATCH_TIMEOUT * 1000LL - Clock_monotonic();
+
+            timeout = (left <= 0) ? 0 : (int)(left / 1000) + 1;
+        }
+        const int ready = poll(a_polls, pollCount, timeout);
+
+        const int64_t time = Clock_monotonic();
+        if (statsRequested || (time - lastStats >= STATS_PERIOD * 1000LL && batchCount != lastStatsBatches))
+        {
+            statsRequested = 0;
+            lastStats = time;
+            lastStatsBatches = batchCount;
+            printStats();
+        }
+        if (inFlightCount > 0 && time - flushTime >= BATCH_TIMEOUT * 1000LL)
+        {
+            giveUp(time);
+        }
+        if (ready <= 0)
+        {
+            if (inFlightCount == 0 && waitingCount > 0)
+            {
+                flush(); // Waiting for a batch given up
+            }
+            continue; // Signal or period
+        }
+        if (a_polls[1].revents != 0)
+        {
+            LinkRecord_s a_answers[MAX_LINK_RECORDS];
+            int count;
+
+            if (Link_read(&simulator) == FALSE)
+            {
+                printf("%sLiaison avec le simulateur perdue%s\n", "\033[41m", "\033[0m");
+                break;
+            }
+            while ((count = Link_next(&simulator, a_answers, MAX_LINK_RECORDS)) > 0)
+            {
+                dispatch(a_answers, count, time);
+            }
+            if (count < 0)
+            {
+                printf("%sTrame du simulateur incomprise%s\n", "\033[41m", "\033[0m");
+                break;
+            }
+        }
+        for (int i = 2; i < pollCount; i++)
+        {
+            if (a_polls[i].revents != 0 && Link_read(&a_commandos[a_slots[i]].peer) == FALSE)
+            {
+                dismiss(a_slots[i]);
+            }
+        }
+        if (a_polls[0].revents != 0)
+        {
+            welcome();
+        }
+        gather(time);
+        if (inFlightCount == 0 && waitingCount > 0)
+        {
+            flush();
+        }
+    }
+}
+
+extern void Mux_stop()
+{
+    printStats();
+    for (int i = 0; i < MAX_COMMANDOS; i++)
+    {
+        if (a_commandos[i].peer.socket >= 0)
+        {
+            close(a_commandos[i].peer.socket);
+        }
+    }
+    if (throughIntox == TRUE)
+    {
+        Intox_close();
+    }
+    else
+    {
+        close(simulator.socket);
+    }
+    close(listenSocket);
+}
+
+static void gather(int64_t time)
+{
+    for (int j = 0; j < MAX_COMMANDOS && waitingCount < MAX_LINK_RECORDS; j++)
+    {
+        const int slot = (nextSlot + j) % MAX_COMMANDOS;
+        Commando_s *p_commando = &a_commandos[slot];
+        int count;
+
+        if (p_commando->peer.socket < 0)
+        {
+            continue;
+        }
+        while ((count = Link_next(&p_commando->peer, a_waiting + waitingCount, MAX_LINK_RECORDS - waitingCount)) > 0)
+        {
+            for (int k = waitingCount; k < waitingCount + count; k++)
+            {
+                const Origin_s origin = {slot, p_commando->generation, a_waiting[k].tag, time};
+
+                a_waitingOrigins[k] = origin;
+                a_waiting[k].robot = slot + 1;
+            }
+            waitingCount += count;
+            p_commando->requests += count;
+        }
+        if (count < 0)
+        {
+            dismiss(slot); // Malformed frame
+        }
+    }
+    nextSlot = (nextSlot + 1) % MAX_COMMANDOS; // No commando is always served last when the batch is full
+}
+
+static void flush()
+{
+    const int count = waitingCount;
+
+    // The number of the batch goes with the place, a late answer of a batch given up is dropped
+    batchBase = (int32_t)(batchCount % BATCH_NUMBERS) * MAX_LINK_RECORDS;
+    for (int k = 0; k < waitingCount; k++)
+    {
+        a_waiting[k].tag = batchBase + k;
+    }
+    memcpy(a_inFlight, a_waitingOrigins, waitingCount * sizeof(Origin_s));
+    memcpy(a_inFlightRecords, a_waiting, waitingCount * sizeof(LinkRecord_s));
+    if (throughIntox == TRUE)
+    {
+        Intox_answer(a_waiting, waitingCount);
+    }
+    else if (Link_send(simulator.socket, a_waiting, waitingCount) == FALSE)
+    {
+        printf("%sLiaison avec le simulateur perdue%s\n", "\033[41m", "\033[0m");
+        work = FALSE;
+        return;
+    }
+    inFlightCount = waitingCount;
+    answeredCount = 0;
+    flushTime = Clock_monotonic();
+    batchCount++;
+    recordCount += waitingCount;
+    waitingCount = 0;
+    if (throughIntox == TRUE)
+    {
+        dispatch(a_waiting, count, Clock_monotonic()); // The answers are already there
+    }
+}
+
+static void dispatch(LinkRecord_s a_answers[], int count, int64_t time)
+{
+    LinkRecord_s a_frame[MAX_LINK_RECORDS];
+    bool_e a_sent[MAX_LINK_RECORDS];
+
+    // An answer the batch does not know, or already has, is left out
+    for (int i = 0; i < count; i++)
+    {
+        const int32_t place = a_answers[i].tag - batchBase;
+
+        a_sent[i] = (place < 0 || place >= inFlightCount || a_inFlight[place].answered == TRUE) ? TRUE : FALSE;
+        if (a_sent[i] == FALSE)
+        {
+            a_inFlight[place].answered = TRUE;
+            a_answers[i].tag = place;
+            answeredCount++;
+        }
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (a_sent[i] == TRUE)
+        {
+            continue;
+        }
+
+        const Origin_s *p_origin = &a_inFlight[a_answers[i].tag];
+        Commando_s *p_commando = &a_commandos[p_origin->slot];
+        const bool_e present = (p_commando->peer.socket >= 0 && p_commando->generation == p_origin->generation) ? TRUE : FALSE;
+        int frameCount = 0;
+
+        // The answers to the same commando leave together
+        for (int k = i; k < count; k++)
+        {
+            if (a_sent[k] == TRUE)
+            {
+                continue;
+            }
+
+            const Origin_s *p_other = &a_inFlight[a_answers[k].tag];
+            if (p_other->slot != p_origin->slot || p_other->generation != p_origin->generation)
+            {
+                continue;
+            }
+            a_sent[k] = TRUE;
+            a_frame[frameCount] = a_answers[k];
+            a_frame[frameCount].robot = 0;
+            a_frame[frameCount].tag = p_other->tag;
+            frameCount++;
+            if (present == TRUE)
+            {
+                const int64_t latency = time - p_other->arrival;
+
+                p_commando->answers++;
+                p_commando->meanLatency += (latency - p_commando->meanLatency) / (int64_t)p_commando->answers;
+                p_commando->maxLatency = (latency > p_commando->maxLatency) ? latency : p_commando->maxLatency;
+            }
+        }
+        if (present == TRUE && Link_send(p_commando->peer.socket, a_frame, frameCount) == FALSE)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                printf("%sRobot %d ne lit plus ses réponses%s\n", "\033[41m", p_origin->slot + 1, "\033[0m");
+            }
+            dismiss(p_origin->slot);
+        }
+    }
+
+    if (answeredCount >= inFlightCount)
+    {
+        inFlightCount = 0; // The next batch may leave
+    }
+}
+
+static void giveUp(int64_t time)
+{
+    LinkRecord_s a_failures[MAX_LINK_RECORDS];
+    int count = 0;
+
+    printf("%sLot %lu : %d réponses sur %d après %d ms, les autres requêtes échouent%s\n", "\033[33m",
+           batchCount, answeredCount, inFlightCount, BATCH_TIMEOUT, "\033[0m");
+    for (int k = 0; k < inFlightCount; k++)
+    {
+        if (a_inFlight[k].answered == FALSE)
+        {
+            a_failures[count] = a_inFlightRecords[k];
+            a_failures[count].status = -1;
+            count++;
+        }
+    }
+    batchesLost++;
+    dispatch(a_failures, count, time);
+}
+
+static void welcome()
+{
+    const int commandoSocket = accept(listenSocket, NULL, NULL);
+
+    if (commandoSocket < 0)
+    {
+        return;
+    }
+    for (int i = 0; i < MAX_COMMANDOS; i++)
+    {
+        Commando_s *p_commando = &a_commandos[i];
+
+        if (p_commando->peer.socket < 0)
+        {
+            const uint32_t generation = p_commando->generation + 1;
+
+            memset(p_commando, 0, sizeof(Commando_s));
+            p_commando->generation = generation;
+            fcntl(commandoSocket, F_SETFL, fcntl(commandoSocket, F_GETFL) | O_NONBLOCK);
+            Link_attach(&p_commando->peer, commandoSocket);
+            if (throughIntox == TRUE && i > 0)
+            {
+                printf("%sRobot %d connecté, ses requêtes échoueront : Intox ne simule que le robot 1%s\n", "\033[33m", i + 1, "\033[0m");
+                return;
+            }
+            printf("%sRobot %d connecté%s\n", "\033[32m", i + 1, "\033[0m");
+            return;
+        }
+    }
+    printf("%sTrop de commandos, connexion refusée%s\n", "\033[41m", "\033[0m");
+    close(commandoSocket);
+}
+
+static void dismiss(int slot)
+{
+    Commando_s *p_commando = &a_commandos[slot];
+
+    close(p_commando->peer.socket);
+    p_commando->peer.socket = -1;
+    p_commando->generation++; // Its answers still with the simulator are dropped
+    printf("%sRobot %d déconnecté%s\n", "\033[31m", slot + 1, "\033[0m");
+}
+
+static void printStats()
+{
+    printf("%sLots : %lu - requêtes : %lu, %.1f par lot - lots sans toutes leurs réponses : %lu%s\n", "\033[36m",
+           batchCount, recordCount, (batchCount > 0) ? (double)recordCount / batchCount : 0.0, batchesLost, "\033[0m");
+    for (int i = 0; i < MAX_COMMANDOS; i++)
+    {
+        const Commando_s *p_commando = &a_commandos[i];
+
+        if (p_commando->requests == 0)
+        {
+            continue;
+        }
+        printf("%sRobot %d%s : requêtes %lu - réponses %lu - latence moyenne %.2f ms, max %.2f ms%s\n", "\033[36m",
+               i + 1, (p_commando->peer.socket < 0) ? " (parti)" : "", p_commando->requests, p_commando->answers,
+               p_commando->meanLatency / 1000.0, p_commando->maxLatency / 1000.0, "\033[0m");
+    }
+}
+
+static void onSignal(int signal)
+{
+    work = FALSE;
+}
+
+static void onStatsSignal(int signal)
+{
+    statsRequested = 1;
+}
@@ -0,0 +1,75 @@
+/**
+ * @file  mux.h
+ *
+ * @brief  Relay merging the requests of many commandos toward one simulator
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _MUX_
+#define _MUX_
+
+#include "../../common.h"
+
+/**
+ * @brief Most commandos served at once
+ */
+#define MAX_COMMANDOS (256)
+
+/**
+ * @brief Period of the counters while batches go (ms)
+ */
+#define STATS_PERIOD (10000)
+
+/**
+ * @brief Listens for the commandos and connects to the simulator
+ *
+ * @param port Port of the commandos
+ * @param host Name or address of the simulator
+ * @param simulatorPort Port of the simulator
+ * @param intox TRUE if the simulator is Intox, reached through libinfox, FALSE if it speaks the link
+ */
+extern void Mux_new(int port, const char *host, int simulatorPort, bool_e intox);
+
+/**
+ * @brief Relays the requests until a signal stops it
+ *
+ * The requests of every commando wait together while a batch is with the
+ * simulator, and leave as the next batch when its answers are back. The
+ * counters are displayed on SIGUSR1, and every few seconds while batches go.
+ */
+extern void Mux_start();
+
+/**
+ * @brief Displays the counters and closes the connections
+ */
+extern void Mux_stop();
+
+#endif // _MUX_
@@ -0,0 +1,75 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../common.h"
+#include "../link/link.h"
+#include "mux/mux.h"
+#include "intox/intox.h"
+#include "standin/standin.h"
+
+/**
+ * @brief Displays the options of relay
+ *
+ * @param program Name of the program
+ */
+static void usage(const char *program);
+
+int main(int argc, char *argv[])
+{
+    int option;
+    int port = -1;
+    char a_host[64] = "127.0.0.1";
+    int simulatorPort = SIMULATOR_PORT;
+    bool_e standIn = FALSE;
+    bool_e intox = FALSE;
+
+    while ((option = getopt(argc, argv, "p:u:i:Sh")) != -1)
+    {
+        switch (option)
+        {
+        case 'p':
+            port = atoi(optarg);
+            break;
+        case 'u':
+            Link_parseAddress(optarg, a_host, sizeof(a_host), &simulatorPort);
+            break;
+        case 'i':
+            simulatorPort = INTOX_PORT;
+            Link_parseAddress(optarg, a_host, sizeof(a_host), &simulatorPort);
+            intox = TRUE;
+            break;
+        case 'S':
+            standIn = TRUE;
+            break;
+        default:
+            usage(argv[0]);
+            return (option == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (standIn == TRUE)
+    {
+        Standin_new((port > 0) ? port : SIMULATOR_PORT);
+        Standin_start();
+        Standin_stop();
+        return EXIT_SUCCESS;
+    }
+
+    Mux_new((port > 0) ? port : LINK_PORT, a_host, simulatorPort, intox);
+    Mux_start();
+    Mux_stop();
+    return EXIT_SUCCESS;
+}
+
+static void usage(const char *program)
+{
+    printf("Usage : %s [options]\n", program);
+    printf("  Relaie les commandos lancés avec -x vers un seul simulateur, en lots\n");
+    printf("  -p <port>         : port d'écoute (%d pour les commandos, %d avec -S)\n", LINK_PORT, SIMULATOR_PORT);
+    printf("  -u <hôte[:port]>  : simulateur (127.0.0.1:%d par défaut)\n", SIMULATOR_PORT);
+    printf("  -i <hôte[:port]>  : Intox par libinfox au lieu du simulateur (port %d par défaut), robot 1 seulement\n", INTOX_PORT);
+    printf("  -S                : simulateur de remplacement de plusieurs robots, pour les essais\n");
+    printf("  -h                : affiche cette aide\n");
+    printf("  Les latences de chaque robot s'affichent sur SIGUSR1, toutes les %d s tant que des lots passent et à l'arrêt.\n", STATS_PERIOD / 1000);
+}
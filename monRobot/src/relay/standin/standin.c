@@ -0,0 +1,232 @@
+/**
+ * @file standin.c
+ *
+ * @see standin.h
+ *
+ * Each frame received is answered by one frame, its records in the same
+ * order: the counters show how many requests the relay merged per frame.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <math.h>
+#include <sys/socket.h>
+
+#include "../../common.h"
+#include "../../link/link.h"
+#include "../../clock/clock.h"
+#include "standin.h"
+
+/**
+ * @brief Most relays or commandos connected at once
+ */
+#define MAX_PEERS (16)
+
+/**
+ * @brief Light around the robots (mV) and its variation
+ */
+#define LIGHT_BASE (400)
+#define LIGHT_SWING (50)
+
+/**
+ * @brief Period of the variation of the light (s)
+ */
+#define LIGHT_PERIOD (20)
+
+/**
+ * @brief A simulated robot
+ */
+typedef struct
+{
+    int right; // Commands of the motors
+    int left;
+} Robot_s;
+
+/**
+ * @brief Answers the records of a frame
+ *
+ * @param a_records The requests, replaced by the answers
+ * @param count Number of records
+ */
+static void answer(LinkRecord_s a_records[], int count);
+
+/**
+ * @brief Asks the loop to stop
+ *
+ * @param signal The signal received
+ */
+static void onSignal(int signal);
+
+static Robot_s a_robots[MAX_ROBOTS];
+static LinkPeer_s a_peers[MAX_PEERS];
+static int listenSocket = -1;
+static unsigned long frameCount = 0;
+static unsigned long recordCount = 0;
+static volatile sig_atomic_t work;
+
+extern void Standin_new(int port)
+{
+    for (int i = 0; i < MAX_PEERS; i++)
+    {
+        a_peers[i].socket = -1;
+    }
+    listenSocket = Link_listen(port);
+    if (listenSocket < 0)
+    {
+        perror("Erreur lors de l'ouverture du port du simulateur");
+        exit(EXIT_FAILURE);
+    }
+    printf("%sSimulateur de remplacement prêt sur le port %d%s\n", "\033[32m", port, "\033[0m");
+}
+
+extern void Standin_start()
+{
+    struct pollfd a_polls[1 + MAX_PEERS];
+    int a_indexes[1 + MAX_PEERS];
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &onSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    work = TRUE;
+    while (work == TRUE)
+    {
+        int pollCount = 1;
+
+        a_polls[0].fd = listenSocket;
+        a_polls[0].events = POLLIN;
+        for (int i = 0; i < MAX_PEERS; i++)
+        {
+            if (a_peers[i].socket >= 0)
+            {
+                a_polls[pollCount].fd = a_peers[i].socket;
+                a_polls[pollCount].events = POLLIN;
+                a_indexes[pollCount] = i;
+                pollCount++;
+            }
+        }
+        if (poll(a_polls, pollCount, -1) < 0)
+        {
+            continue; // Signal
+        }
+
+        for (int i = 1; i < pollCount; i++)
+        {
+            LinkPeer_s *p_peer = &a_peers[a_indexes[i]];
+            LinkRecord_s a_records[MAX_LINK_RECORDS];
+            int count = 0;
+
+            if (a_polls[i].revents == 0)
+            {
+                continue;
+            }
+            if (Link_read(p_peer) == TRUE)
+            {
+                while ((count = Link_next(p_peer, a_records, MAX_LINK_RECORDS)) > 0)
+                {
+                    answer(a_records, count);
+                    if (Link_send(p_peer->socket, a_records, count) == FALSE)
+                    {
+                        count = -1;
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                count = -1;
+            }
+            if (count < 0)
+            {
+                close(p_peer->socket);
+                p_peer->socket = -1;
+            }
+        }
+        if (a_polls[0].revents != 0)
+        {
+            const int peerSocket = accept(listenSocket, NULL, NULL);
+            int index = 0;
+
+            while (index < MAX_PEERS && a_peers[index].socket >= 0)
+            {
+                index++;
+            }
+            if (peerSocket >= 0 && index < MAX_PEERS)
+            {
+                Link_attach(&a_peers[index], peerSocket);
+            }
+            else if (peerSocket >= 0)
+            {
+                close(peerSocket); // No room
+            }
+        }
+    }
+}
+
+extern void Standin_stop()
+{
+    printf("%sTrames : %lu - requêtes : %lu, %.1f par trame%s\n", "\033[36m",
+           frameCount, recordCount, (frameCount > 0) ? (double)recordCount / frameCount : 0.0, "\033[0m");
+    for (int i = 0; i < MAX_PEERS; i++)
+    {
+        if (a_peers[i].socket >= 0)
+        {
+            close(a_peers[i].socket);
+        }
+    }
+    close(listenSocket);
+}
+
+static void answer(LinkRecord_s a_records[], int count)
+{
+    const double seconds = Clock_monotonic() / 1000000.0;
+
+    frameCount++;
+    recordCount += count;
+    for (int i = 0; i < count; i++)
+    {
+        LinkRecord_s *p_record = &a_records[i];
+
+        // The robot 0 is the one of a commando connected without relay
+        if (p_record->robot < 0 || p_record->robot >= MAX_ROBOTS)
+        {
+            p_record->status = -1;
+            continue;
+        }
+
+        Robot_s *p_robot = &a_robots[p_record->robot];
+        p_record->status = 0;
+        if (p_record->op == LK_SET_WHEELS)
+        {
+            p_robot->right = p_record->right;
+            p_robot->left = p_record->left;
+        }
+        else if (p_record->op == LK_READ)
+        {
+            // Each robot sees the light with its own phase
+            const double phase = 2 * M_PI * (seconds / LIGHT_PERIOD + p_record->robot / 16.0);
+
+            p_record->right = p_robot->right;
+            p_record->left = p_robot->left;
+            p_record->luminosity = (int32_t)((LIGHT_BASE + LIGHT_SWING * sin(phase)) * 1000);
+            p_record->contacts = 0;
+        }
+        else
+        {
+            p_record->status = -1;
+        }
+    }
+}
+
+static void onSignal(int signal)
+{
+    work = FALSE;
+}
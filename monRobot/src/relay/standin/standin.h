@@ -0,0 +1,66 @@
+/**
+ * @file  standin.h
+ *
+ * @brief  Stand-in simulator of many robots, for the tests of the relay
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _STANDIN_
+#define _STANDIN_
+
+#include "../../common.h"
+
+/**
+ * @brief Most robots simulated, 0 is the one of a commando connected without relay
+ */
+#define MAX_ROBOTS (4096)
+
+/**
+ * @brief Listens for the relays, or for commandos connected directly
+ *
+ * @param port Port
+ */
+extern void Standin_new(int port);
+
+/**
+ * @brief Answers the requests until a signal stops it
+ *
+ * The motors keep their commands, the light changes slowly with the time
+ * and the contacts stay released.
+ */
+extern void Standin_start();
+
+/**
+ * @brief Displays the counters and closes the connections
+ */
+extern void Standin_stop();
+
+#endif // _STANDIN_
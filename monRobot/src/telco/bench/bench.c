@@ -0,0 +1,341 @@
+/**
+ * @file bench.c
+ *
+ * @see bench.h
+ *
+ * Every connection asks for the state once per BENCH_PERIOD, below the rate
+ * commando admits, and waits for the answer before the next request: the
+ * load grows with the number of connections, not with the speed of the
+ * server. Poll() and not select(), for more than FD_SETSIZE sockets.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "../../common.h"
+#include "../../codec/codec.h"
+#include "../../clock/clock.h"
+#include "bench.h"
+
+/**
+ * @brief Duration of the measure (ms)
+ */
+#define BENCH_DURATION (5000)
+
+/**
+ * @brief Time between two requests of a connection (ms), 20 per second while commando admits ORDER_RATE
+ */
+#define BENCH_PERIOD (50)
+
+/**
+ * @brief Time after which a request without answer is given up (ms)
+ */
+#define ANSWER_TIMEOUT (1000)
+
+/**
+ * @brief Longest frame: the header and the largest payload
+ */
+#define MAX_FRAME ((int)sizeof(Data_s) + MAX_PAYLOAD)
+
+/**
+ * @brief A connection of the load
+ */
+typedef struct
+{
+    uint32_t nextSequence;
+    uint32_t sequence; // Request awaited (0: none)
+    int64_t sentAt;    // µs
+    long nextSend;     // ms
+    unsigned char a_inbox[MAX_FRAME];
+    int inboxSize;
+} Probe_s;
+
+/**
+ * @brief Sends the next request of a connection
+ *
+ * @param index The connection
+ * @param now The present time (ms)
+ */
+static void ask(int index, long now);
+
+/**
+ * @brief Reads what a connection received and takes the complete frames into account
+ *
+ * @param index The connection
+ */
+static void receive(int index);
+
+/**
+ * @brief Stops using a connection closed by the server
+ *
+ * @param index The connection
+ */
+static void drop(int index);
+
+/**
+ * @brief Orders two latencies, for qsort()
+ */
+static int compare(const void *p_first, const void *p_second);
+
+static Probe_s *a_probes = NULL;
+static struct pollfd *a_polls = NULL; // fd < 0: closed, ignored by poll()
+static int probeCount = 0;
+static int openCount = 0;
+static int32_t *a_latencies = NULL; // µs
+static unsigned long answered = 0;
+static unsigned long sent = 0;
+static unsigned long shed = 0;    // Acknowledged without answer
+static unsigned long expired = 0; // Neither answered nor acknowledged in time
+static int closed = 0;
+
+extern void Bench_new(int count)
+{
+    if (count < 1 || count > MAX_BENCH_CONNECTIONS)
+    {
+        fprintf(stderr, "Nombre de connexions invalide, de 1 à %d\n", MAX_BENCH_CONNECTIONS);
+        exit(EXIT_FAILURE);
+    }
+    probeCount = count;
+    a_probes = calloc(count, sizeof(Probe_s));
+    a_polls = calloc(count, sizeof(struct pollfd));
+    a_latencies = malloc(sizeof(int32_t) * count * (BENCH_DURATION / BENCH_PERIOD + 1));
+    if (a_probes == NULL || a_polls == NULL || a_latencies == NULL)
+    {
+        fprintf(stderr, "Mémoire insuffisante pour %d connexions\n", count);
+        exit(EXIT_FAILURE);
+    }
+}
+
+extern void Bench_start()
+{
+    struct sockaddr_in server_address;
+    const int noDelay = 1;
+    int refused = 0;
+
+    memset(&server_address, 0, sizeof(server_address));
+    server_address.sin_family = AF_INET;
+    server_address.sin_port = htons(PORT_SERVER);
+    server_address.sin_addr.s_addr = inet_addr(IP_SERVER);
+
+    for (int i = 0; i < probeCount; i++)
+    {
+        a_polls[i].fd = socket(AF_INET, SOCK_STREAM, 0);
+        a_polls[i].events = POLLIN;
+        if (a_polls[i].fd < 0 || connect(a_polls[i].fd, (struct sockaddr *)&server_address, sizeof(server_address)) != 0)
+        {
+            if (a_polls[i].fd >= 0)
+            {
+                close(a_polls[i].fd);
+            }
+            a_polls[i].fd = -1;
+            refused++;
+            continue;
+        }
+        setsockopt(a_polls[i].fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        fcntl(a_polls[i].fd, F_SETFL, fcntl(a_polls[i].fd, F_GETFL) | O_NONBLOCK);
+        a_probes[i].nextSequence = 1;
+        openCount++;
+    }
+    if (openCount == 0)
+    {
+        fprintf(stderr, "Serveur injoignable\n");
+        return;
+    }
+
+    const long start = Clock_milliseconds();
+    const long end = start + BENCH_DURATION;
+
+    // Spread over the period, the requests do not all leave together
+    for (int i = 0; i < probeCount; i++)
+    {
+        a_probes[i].nextSend = start + (long)i * BENCH_PERIOD / probeCount;
+    }
+
+    long now = start;
+    while (now < end && openCount > 0)
+    {
+        long timeout = end - now;
+
+        for (int i = 0; i < probeCount; i++)
+        {
+            if (a_polls[i].fd < 0)
+            {
+                continue;
+            }
+            if (a_probes[i].sequence != 0 && now - a_probes[i].sentAt / 1000 >= ANSWER_TIMEOUT)
+            {
+                expired++;
+                a_probes[i].sequence = 0;
+            }
+            if (a_probes[i].sequence == 0)
+            {
+                if (now >= a_probes[i].nextSend)
+                {
+                    ask(i, now);
+                }
+                else if (a_probes[i].nextSend - now < timeout)
+                {
+                    timeout = a_probes[i].nextSend - now;
+                }
+            }
+        }
+
+        const int ready = poll(a_polls, probeCount, (int)timeout);
+        if (ready < 0 && errno != EINTR)
+        {
+            break;
+        }
+        for (int i = 0; i < probeCount && ready > 0; i++)
+        {
+            if (a_polls[i].fd >= 0 && a_polls[i].revents != 0)
+            {
+                receive(i);
+            }
+        }
+        now = Clock_milliseconds();
+    }
+
+    const long duration = now - start;
+    qsort(a_latencies, answered, sizeof(int32_t), &compare);
+    printf("%d connexions ouvertes, %d refusées, %d fermées par le serveur\n", probeCount - refused, refused, closed);
+    printf("%lu requêtes en %ld ms : %lu servies (%.0f par seconde), %lu délestées, %lu sans réponse\n",
+           sent, duration, answered, (duration > 0) ? answered * 1000.0 / duration : 0.0, shed, expired);
+    if (answered > 0)
+    {
+        double total = 0;
+
+        for (unsigned long i = 0; i < answered; i++)
+        {
+            total += a_latencies[i];
+        }
+        printf("Latence (µs) : moyenne %.0f, médiane %d, 99 %% %d, max %d\n", total / answered,
+               a_latencies[answered / 2], a_latencies[answered * 99 / 100], a_latencies[answered - 1]);
+    }
+    fflush(stdout);
+}
+
+extern void Bench_stop()
+{
+    for (int i = 0; i < probeCount; i++)
+    {
+        if (a_polls[i].fd >= 0)
+        {
+            close(a_polls[i].fd);
+        }
+    }
+    free(a_probes);
+    free(a_polls);
+    free(a_latencies);
+    a_probes = NULL;
+    a_polls = NULL;
+    a_latencies = NULL;
+    probeCount = 0;
+    openCount = 0;
+}
+
+static void ask(int index, long now)
+{
+    Probe_s *p_probe = &a_probes[index];
+    Data_s data = {O_ASK_LOG, D_STOP, 0, 0, 0, 0, p_probe->nextSequence, 0};
+
+    Codec_encodeFrames(&data, &data, 1);
+    if (send(a_polls[index].fd, &data, sizeof(data), MSG_NOSIGNAL) != sizeof(data))
+    {
+        drop(index); // A frame always fits in an empty socket buffer, the server is gone
+        return;
+    }
+    p_probe->sequence = p_probe->nextSequence;
+    p_probe->nextSequence = (p_probe->nextSequence == UINT32_MAX) ? 1 : p_probe->nextSequence + 1; // 0 means not numbered
+    p_probe->sentAt = Clock_monotonic();
+    p_probe->nextSend = now + BENCH_PERIOD;
+    sent++;
+}
+
+static void receive(int index)
+{
+    Probe_s *p_probe = &a_probes[index];
+    ssize_t count;
+
+    do
+    {
+        count = read(a_polls[index].fd, p_probe->a_inbox + p_probe->inboxSize, MAX_FRAME - p_probe->inboxSize);
+    } while (count < 0 && errno == EINTR);
+
+    if (count == 0 || (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+        drop(index);
+        return;
+    }
+    if (count < 0)
+    {
+        return;
+    }
+    p_probe->inboxSize += count;
+
+    for (;;)
+    {
+        Data_s header;
+
+        if (p_probe->inboxSize < (int)sizeof(Data_s))
+        {
+            return;
+        }
+        memcpy(&header, p_probe->a_inbox, sizeof(header));
+        Codec_decodeFrames(&header, &header, 1);
+        if (header.size < 0 || header.size > MAX_PAYLOAD || header.size % sizeof(int32_t) != 0)
+        {
+            drop(index); // Lost the frames boundaries
+            return;
+        }
+        const int size = (int)sizeof(Data_s) + header.size;
+        if (p_probe->inboxSize < size)
+        {
+            return;
+        }
+        memmove(p_probe->a_inbox, p_probe->a_inbox + size, p_probe->inboxSize - size);
+        p_probe->inboxSize -= size;
+
+        if (p_probe->sequence == 0)
+        {
+            continue;
+        }
+        if (header.order == O_ASK_LOG && header.sequence == p_probe->sequence)
+        {
+            a_latencies[answered++] = (int32_t)(Clock_monotonic() - p_probe->sentAt);
+            p_probe->sequence = 0;
+        }
+        else if (header.ack != 0 && (int32_t)(p_probe->sequence - header.ack) <= 0)
+        {
+            shed++; // Acknowledged, its answer would have come first
+            p_probe->sequence = 0;
+        }
+    }
+}
+
+static void drop(int index)
+{
+    close(a_polls[index].fd);
+    a_polls[index].fd = -1;
+    a_probes[index].sequence = 0;
+    openCount--;
+    closed++;
+}
+
+static int compare(const void *p_first, const void *p_second)
+{
+    const int32_t first = *(const int32_t *)p_first;
+    const int32_t second = *(const int32_t *)p_second;
+
+    return (first > second) - (first < second);
+}
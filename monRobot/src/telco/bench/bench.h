@@ -0,0 +1,63 @@
+/**
+ * @file  bench.h
+ *
+ * @brief  Load generator: many connections ask commando for its state, to compare the event loops
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _BENCH_
+#define _BENCH_
+
+#include "../../common.h"
+
+/**
+ * @brief Most connections opened at once
+ */
+#define MAX_BENCH_CONNECTIONS (4096)
+
+/**
+ * @brief Prepares the connections
+ *
+ * @param count Number of connections to open, from 1 to MAX_BENCH_CONNECTIONS
+ */
+extern void Bench_new(int count);
+
+/**
+ * @brief Loads the server for BENCH_DURATION, then prints the throughput and the latencies
+ */
+extern void Bench_start();
+
+/**
+ * @brief Closes the connections
+ */
+extern void Bench_stop();
+
+#endif // _BENCH_
@@ -7,159 +7,636 @@
 #include <sys/types.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <stdint.h>
 #include <string.h>
+#include <time.h>
+#include <sys/select.h>
+#include <fcntl.h>
 
 #include "../../common.h"
 #include "../util.h"
+#include "../../codec/codec.h"
+#include "../../clock/clock.h"
 #include "client.h"
 
 #define MAX_CONNECTION_ATTEMPT (60)
 
-static int socket_ecoute;
-static struct sockaddr_in server_address;
+/**
+ * @brief Pings exchanged at the connection
+ */
+#define PING_BURST (4)
+
+/**
+ * @brief Period of the pings (ms)
+ */
+#define PING_PERIOD (2000)
+
+/**
+ * @brief Numbered orders in flight by default
+ */
+#define DEFAULT_WINDOW (8)
+
+/**
+ * @brief Time after which an order never acknowledged leaves the window (ms)
+ */
+#define ACK_TIMEOUT (2000)
+
+/**
+ * @brief Largest frame, order and payload
+ */
+#define MAX_FRAME ((int)sizeof(Data_s) + MAX_PAYLOAD)
 
 /**
- * @brief Convert data to Byte order fot host
+ * @brief Bytes waiting to be written to a server, a few frames at their largest
+ */
+#define OUTBOX_SIZE (4 * MAX_FRAME)
+
+/**
+ * @brief A numbered order waiting for its acknowledgement
+ */
+typedef struct
+{
+    uint32_t sequence;
+    Order_e order;
+    long sentAt;     // µs
+    bool_e answered; // Its answer arrived
+} InFlight_s;
+
+/**
+ * @brief A server and what the client knows of it
+ */
+typedef struct
+{
+    int socket_ecoute;
+    struct sockaddr_in server_address;
+    bool_e connected;
+    bool_e connecting; // Non-blocking connection in progress, see Client_connect()
+    ClockEstimate_s clockEstimate;
+    PingRequest_s lastExchange; // Timestamps of the last answer, sent back with the next ping
+    bool_e exchanged;
+    long lastPing;
+    InFlight_s a_inFlight[MAX_WINDOW]; // From the oldest order
+    int inFlightHead;
+    int inFlightCount;
+    uint32_t nextSequence;
+    AckStats_s ackStats;
+    unsigned char a_inbox[MAX_FRAME]; // The frame being received, as it came
+    int inboxSize;
+    uint32_t lastArrival;              // Of the last bytes received
+    unsigned char a_outbox[OUTBOX_SIZE]; // The frames not written yet, in order
+    int outboxSize;
+} Connection_s;
+
+static Connection_s a_connections[MAX_SERVERS];
+static int connectionCount = 0;
+static Connection_s *p_current = &a_connections[0]; // Used by all the functions but Client_add()
+static bool_e quiet = FALSE;
+static int32_t a_payload[MAX_PAYLOAD / sizeof(int32_t)]; // Payload of the last answer, host byte order
+static int payloadSize = 0;
+static int window = DEFAULT_WINDOW;
+
+/**
+ * @brief Starts the exchanges on a connection just established
+ */
+static void established();
+
+/**
+ * @brief Sends a ping with the timestamps of the previous exchange
+ */
+static void sendPing();
+
+/**
+ * @brief Takes the timestamps of a frame into account
  *
- * @param order The type of order
- * @param direction The direction in which the robot should go.
- * @param speed The speed
- * @param collision Collision sensor status
- * @param luminosity The luminosity measured
+ * @param order The order of the frame
+ * @param arrival Arrival of the frame
+ */
+static void stamp(Order_e order, uint32_t arrival);
+
+/**
+ * @brief Takes the number and the acknowledgement of a frame into account
+ *
+ * @param data The frame
+ */
+static void track(const Data_s *data);
+
+/**
+ * @brief Takes the orders never acknowledged out of the window
+ */
+static void expire();
+
+/**
+ * @brief Gives a monotonic time
  *
- * @return Data_s convert data to Byte order
+ * @return long Time in microseconds
  */
-static Data_s convertDataReception(const Order_e order, const Direction_e direction, const int speed, const bool_e collision, const int luminosity);
+static long nowMicro();
 
 /**
- * @brief Convert data to Byte order for network
+ * @brief Gives the size of the frame at the start of the inbox, once it is whole
  *
- * @param order The type of order
- * @param direction The direction in which the robot should go.
- * @param speed The speed
- * @param collision Collision sensor status
- * @param luminosity The luminosity measured
+ * @return int Bytes of the frame, 0 while it is not whole, -1 if the stream is not valid
+ */
+static int frameSize();
+
+/**
+ * @brief Reads what the server has sent into the inbox, without waiting
  *
- * @return Data_s convert data to Byte order
+ * @return bool_e TRUE if bytes were read, FALSE if none are there yet, on error or disconnection
  */
-static Data_s convertDataSend(const Order_e order, const Direction_e direction, const int speed, const bool_e collision, const int luminosity);
+static bool_e receive();
 
 extern void Client_new()
 {
-    const struct hostent *host = gethostbyname(IP_SERVER);
+    if (Client_add(IP_SERVER, PORT_SERVER) < 0)
+    {
+        return;
+    }
+    Client_select(connectionCount - 1);
+    TRACE("The client is created\n");
+}
 
+extern int Client_add(const char *hostName, int port)
+{
+    const struct hostent *host = gethostbyname(hostName);
+    Connection_s *p_connection = &a_connections[connectionCount];
+
+    if (connectionCount == MAX_SERVERS)
+    {
+        printf("%sTrop de serveurs (%d au plus)%s\n", "\033[41m", MAX_SERVERS, "\033[0m");
+        return -1;
+    }
     if (host == NULL)
     {
-        printf("%sHôte inconnu%s\n", "\033[41m", "\033[0m");
-        Client_stop();
-        return;
+        printf("%sHôte inconnu : %s%s\n", "\033[41m", hostName, "\033[0m");
+        return -1;
     }
-    server_address.sin_port = htons(PORT_SERVER);
-    server_address.sin_family = AF_INET;
-    server_address.sin_addr = *((struct in_addr *)host->h_addr_list[0]);
+    memset(p_connection, 0, sizeof(*p_connection));
+    p_connection->server_address.sin_port = htons(port);
+    p_connection->server_address.sin_family = AF_INET;
+    p_connection->server_address.sin_addr = *((struct in_addr *)host->h_addr_list[0]);
+    p_connection->nextSequence = 1;
 
-    socket_ecoute = socket(AF_INET, SOCK_STREAM, 0);
-    if (socket_ecoute < 0)
+    p_connection->socket_ecoute = socket(AF_INET, SOCK_STREAM, 0);
+    if (p_connection->socket_ecoute < 0)
     {
         printf("%sErreur dans le socket%s\n", "\033[41m", "\033[0m");
+        return -1;
+    }
+    return connectionCount++;
+}
+
+extern void Client_select(int index)
+{
+    if (index >= 0 && index < connectionCount)
+    {
+        p_current = &a_connections[index];
+    }
+}
+
+extern int Client_getCount()
+{
+    return connectionCount;
+}
+
+extern int Client_getSocket()
+{
+    return p_current->socket_ecoute;
+}
+
+extern bool_e Client_connect()
+{
+    if (p_current->connected == TRUE || p_current->connecting == TRUE)
+    {
+        return TRUE;
+    }
+    if (p_current->socket_ecoute < 0)
+    {
+        p_current->socket_ecoute = socket(AF_INET, SOCK_STREAM, 0); // Closed after a failure
+        if (p_current->socket_ecoute < 0)
+        {
+            return FALSE;
+        }
+    }
+    fcntl(p_current->socket_ecoute, F_SETFL, fcntl(p_current->socket_ecoute, F_GETFL) | O_NONBLOCK);
+    if (connect(p_current->socket_ecoute, (struct sockaddr *)&p_current->server_address, sizeof(p_current->server_address)) == 0)
+    {
+        established();
+        return TRUE;
+    }
+    if (errno == EINPROGRESS)
+    {
+        p_current->connecting = TRUE;
+        return TRUE;
+    }
+    Client_stop();
+    return FALSE;
+}
+
+extern bool_e Client_isConnecting()
+{
+    return p_current->connecting;
+}
+
+extern bool_e Client_finishConnect()
+{
+    int error = 0;
+    socklen_t length = sizeof(error);
+
+    p_current->connecting = FALSE;
+    if (getsockopt(p_current->socket_ecoute, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0)
+    {
         Client_stop();
-        return;
+        return FALSE;
     }
-    TRACE("The client is created\n");
+    established();
+    return TRUE;
+}
+
+extern void Client_setQuiet(bool_e isQuiet)
+{
+    quiet = isQuiet;
+}
+
+extern bool_e Client_isConnected()
+{
+    return p_current->connected;
 }
 
 extern int *Client_start()
 {
     int timeoutCounter = 0;
 
-    printf("%sTentative de connexion au serveur%s\n\n", "\033[34m", "\033[0m");
+    if (quiet == FALSE)
+    {
+        printf("%sTentative de connexion au serveur%s\n\n", "\033[34m", "\033[0m");
+    }
 
     while (timeoutCounter < MAX_CONNECTION_ATTEMPT)
     {
         timeoutCounter++;
-        if (connect(socket_ecoute, (struct sockaddr *)&server_address, sizeof(server_address)) < 0)
+        if (connect(p_current->socket_ecoute, (struct sockaddr *)&p_current->server_address, sizeof(p_current->server_address)) < 0)
         {
-            printf("%s%s%sÉchec de la connexion, tentative n°%d / %d%s\n", "\033[1A", "\033[K", "\033[33m", timeoutCounter, MAX_CONNECTION_ATTEMPT, "\033[0m");
-            sleep(1); // Sleep and retry after
+            if (quiet == FALSE)
+            {
+                printf("%s%s%sÉchec de la connexion, tentative n°%d / %d%s\n", "\033[1A", "\033[K", "\033[33m", timeoutCounter, MAX_CONNECTION_ATTEMPT, "\033[0m");
+            }
+            Clock_sleep(1000); // Sleep and retry after
         }
         else
         {
-            printf("%s%s%sConnexion réussite%s\n", "\033[1A", "\033[K", "\033[33m", "\033[0m");
+            if (quiet == FALSE)
+            {
+                printf("%s%s%sConnexion réussite%s\n", "\033[1A", "\033[K", "\033[33m", "\033[0m");
+            }
+
+            // Nothing else is expected yet, the answers are waited for one by one
+            established();
+            for (int i = 0; i < PING_BURST && p_current->connected == TRUE; i++)
+            {
+                fd_set readFd;
+                struct timeval delay = {1, 0};
+                Data_s data;
+
+                if (i > 0)
+                {
+                    sendPing();
+                }
+                FD_ZERO(&readFd);
+                FD_SET(p_current->socket_ecoute, &readFd);
+                if (select(p_current->socket_ecoute + 1, &readFd, NULL, NULL, &delay) <= 0)
+                {
+                    break; // No answer, the next pings will do
+                }
+                while (Client_readMsg(&data) == TRUE)
+                {
+                }
+            }
             break;
         }
     }
-    return &socket_ecoute;
+    return &p_current->socket_ecoute;
 }
 
 extern void Client_stop()
 {
     TRACE("The client is OFF\n");
-    close(socket_ecoute);
+    if (p_current->socket_ecoute >= 0)
+    {
+        close(p_current->socket_ecoute);
+    }
+    p_current->socket_ecoute = -1;
+    p_current->connected = FALSE;
+    p_current->connecting = FALSE;
+    p_current->inboxSize = 0;
+    p_current->outboxSize = 0; // Not for the next connection
 }
 
-extern void Client_sendMsg(Data_s data)
+extern void Client_setWindow(int size)
 {
-    data = convertDataSend(data.order, data.direction, data.speed, data.collision, data.luminosity);
+    window = (size < 1) ? 1 : (size > MAX_WINDOW) ? MAX_WINDOW : size;
+}
 
-    int quantityWritten = 0;
-    int quantityToWrite = sizeof(data);
+extern bool_e Client_canSend()
+{
+    expire();
+    return (p_current->inFlightCount < window) ? TRUE : FALSE;
+}
+
+extern uint32_t Client_sendMsg(Data_s data)
+{
+    return Client_sendPayload(data, NULL, 0);
+}
+
+extern uint32_t Client_sendPayload(Data_s data, const void *payload, int size)
+{
+    int32_t a_words[MAX_PAYLOAD / sizeof(int32_t)];
+
+    if (size < 0 || size > MAX_PAYLOAD || size % sizeof(int32_t) != 0)
+    {
+        printf("%sCharge utile invalide (%d octets)%s\n", "\033[41m", size, "\033[0m");
+        return 0;
+    }
+    if (p_current->outboxSize + (int)sizeof(data) + size > OUTBOX_SIZE && (Client_flush() == FALSE || p_current->outboxSize + (int)sizeof(data) + size > OUTBOX_SIZE))
+    {
+        printf("%sLe serveur ne lit plus, message abandonné%s\n", "\033[41m", "\033[0m");
+        return 0;
+    }
+    data.size = size;
+    data.sequence = 0;
+    data.ack = 0;
+    if (data.order != O_PING)
+    {
+        if (Client_canSend() == FALSE)
+        {
+            p_current->ackStats.refused++; // An order out of the window could be neither tracked nor acknowledged
+            return 0;
+        }
+        data.sequence = p_current->nextSequence;
+    }
+    const uint32_t sequence = data.sequence;
+    const Order_e order = data.order;
+    Codec_encodeFrames(&data, &data, 1);
+    Codec_encodeWords(a_words, (const int32_t *)payload, size / sizeof(int32_t));
 
-    quantityWritten = write(socket_ecoute, &data + quantityWritten, quantityToWrite);
+    memcpy(p_current->a_outbox + p_current->outboxSize, &data, sizeof(data));
+    memcpy(p_current->a_outbox + p_current->outboxSize + sizeof(data), a_words, size);
+    p_current->outboxSize += sizeof(data) + size;
 
-    if (quantityWritten < 0)
+    if (Client_flush() == FALSE)
     {
-        printf("%sErreur lors de l'envoi du message%s\n", "\033[41m", "\033[0m");
+        return 0; // Dropped with the outbox, no acknowledgement will come
     }
+    if (sequence != 0)
+    {
+        InFlight_s *p_entry = &p_current->a_inFlight[(p_current->inFlightHead + p_current->inFlightCount) % MAX_WINDOW];
+
+        p_entry->sequence = sequence;
+        p_entry->order = order;
+        p_entry->answered = FALSE;
+        p_entry->sentAt = nowMicro();
+        p_current->inFlightCount++;
+        p_current->nextSequence = (sequence == UINT32_MAX) ? 1 : sequence + 1; // 0 means not numbered
+    }
+    return sequence;
 }
 
-extern Data_s Client_readMsg()
+extern bool_e Client_flush()
 {
-    Data_s data = {0, 0, 0, 0, 0};
-    int quantityToRead = sizeof(Data_s);
-    int quantityReaddean = 0;
+    int written = 0;
 
-    while (quantityToRead > 0)
+    while (written < p_current->outboxSize)
     {
-        quantityReaddean = read(socket_ecoute, &data + quantityReaddean, quantityToRead);
+        const ssize_t count = write(p_current->socket_ecoute, p_current->a_outbox + written, p_current->outboxSize - written);
 
-        if (quantityReaddean < 0)
+        if (count < 0 && errno == EINTR)
         {
-            printf("%sErreur lors de la réception du message%s\n", "\033[41m", "\033[0m");
-            break;
+            continue;
         }
-        else
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break; // The rest goes once the socket is writable
+        }
+        if (count < 0)
+        {
+            printf("%sErreur lors de l'envoi du message%s\n", "\033[41m", "\033[0m");
+            p_current->outboxSize = 0;
+            return FALSE;
+        }
+        written += count;
+    }
+    memmove(p_current->a_outbox, p_current->a_outbox + written, p_current->outboxSize - written);
+    p_current->outboxSize -= written;
+    return TRUE;
+}
+
+extern bool_e Client_hasPending()
+{
+    return (p_current->outboxSize > 0) ? TRUE : FALSE;
+}
+
+extern bool_e Client_readMsg(Data_s *p_data)
+{
+    int size = frameSize();
+
+    payloadSize = 0;
+    while (size == 0 && receive() == TRUE)
+    {
+        size = frameSize();
+    }
+    if (size < 0)
+    {
+        printf("%sRéponse invalide du serveur%s\n", "\033[41m", "\033[0m");
+        p_current->connected = FALSE; // The stream can not be followed anymore
+        return FALSE;
+    }
+    if (size == 0)
+    {
+        return FALSE; // The rest of the frame has not come yet
+    }
+    memcpy(p_data, p_current->a_inbox, sizeof(Data_s));
+    Codec_decodeFrames(p_data, p_data, 1);
+    TRACE("Receive data:\tDirection: %d - Event: %d - Speed: %d - Collision: %d - Luminosity: %d\n\n", p_data->direction, p_data->order, p_data->speed, p_data->collision, p_data->luminosity);
+
+    if (p_data->size > 0)
+    {
+        memcpy(a_payload, p_current->a_inbox + sizeof(Data_s), p_data->size);
+        Codec_decodeWords(a_payload, a_payload, p_data->size / sizeof(int32_t));
+        payloadSize = p_data->size;
+        stamp(p_data->order, p_current->lastArrival);
+    }
+    memmove(p_current->a_inbox, p_current->a_inbox + size, p_current->inboxSize - size);
+    p_current->inboxSize -= size;
+    track(p_data);
+
+    return TRUE;
+}
+
+extern const void *Client_getPayload(int *size)
+{
+    *size = payloadSize;
+    return a_payload;
+}
+
+extern void Client_ping()
+{
+    if (p_current->connected == TRUE && Clock_milliseconds() - p_current->lastPing >= PING_PERIOD)
+    {
+        sendPing();
+    }
+}
+
+extern const ClockEstimate_s *Client_getClock()
+{
+    return &p_current->clockEstimate;
+}
+
+extern const AckStats_s *Client_getAckStats()
+{
+    return &p_current->ackStats;
+}
+
+static void established()
+{
+    // Never blocking, the frames are put back together in the inbox and the writes wait in the outbox
+    fcntl(p_current->socket_ecoute, F_SETFL, fcntl(p_current->socket_ecoute, F_GETFL) | O_NONBLOCK);
+    p_current->inboxSize = 0;
+    p_current->outboxSize = 0;
+    p_current->connected = TRUE;
+    p_current->connecting = FALSE;
+    Clock_reset(&p_current->clockEstimate);
+    p_current->exchanged = FALSE;
+    p_current->inFlightHead = 0;
+    p_current->inFlightCount = 0; // The orders of a previous connection are lost
+    sendPing();
+}
+
+static void sendPing()
+{
+    const Data_s data = {O_PING, D_STOP, 0, 0, 0, 0};
+    PingRequest_s *p_exchange = &p_current->lastExchange;
+
+    p_current->lastPing = Clock_milliseconds();
+    p_exchange->origin = Clock_now();
+    Client_sendPayload(data, p_exchange, p_current->exchanged ? sizeof(*p_exchange) : sizeof(p_exchange->origin));
+}
+
+static void stamp(Order_e order, uint32_t arrival)
+{
+    if (order == O_PING && payloadSize == sizeof(PingReply_s))
+    {
+        const PingReply_s *p_reply = (const PingReply_s *)a_payload;
+
+        p_current->lastExchange.previousOrigin = p_reply->origin;
+        p_current->lastExchange.previousReceive = p_reply->receive;
+        p_current->lastExchange.previousTransmit = p_reply->transmit;
+        p_current->lastExchange.previousArrival = arrival;
+        p_current->exchanged = TRUE;
+        Clock_sample(&p_current->clockEstimate, p_reply->origin, p_reply->receive, p_reply->transmit, arrival);
+    }
+    else if (order == O_ASK_LOG && payloadSize == sizeof(StateStamp_s) && p_current->clockEstimate.count > 0)
+    {
+        Clock_noteDownlink(&p_current->clockEstimate, ((const StateStamp_s *)a_payload)->transmit, arrival);
+    }
+}
+
+static void track(const Data_s *data)
+{
+    const long time = nowMicro();
+    InFlight_s *a_inFlight = p_current->a_inFlight;
+    AckStats_s *p_stats = &p_current->ackStats;
+
+    if (data->sequence != 0)
+    {
+        for (int i = 0; i < p_current->inFlightCount; i++)
+        {
+            InFlight_s *p_entry = &a_inFlight[(p_current->inFlightHead + i) % MAX_WINDOW];
+
+            if (p_entry->sequence == data->sequence)
+            {
+                p_entry->answered = TRUE;
+                break;
+            }
+        }
+    }
+    // The acknowledgement is cumulative, modulo 2^32
+    while (data->ack != 0 && p_current->inFlightCount > 0 && (int32_t)(a_inFlight[p_current->inFlightHead].sequence - data->ack) <= 0)
+    {
+        const InFlight_s *p_entry = &a_inFlight[p_current->inFlightHead];
+        const int latency = (int)(time - p_entry->sentAt);
+        const bool_e request = (p_entry->order == O_ASK_LOG || p_entry->order == O_POSE || p_entry->order == O_MAP || p_entry->order == O_HISTORY || p_entry->order == O_PROFILE);
+
+        if (request == TRUE && p_entry->answered == FALSE)
         {
-            quantityToRead -= quantityReaddean;
+            p_stats->unanswered++;
         }
+        p_stats->acknowledged++;
+        p_stats->lastLatency = latency;
+        p_stats->maxLatency = (latency > p_stats->maxLatency) ? latency : p_stats->maxLatency;
+        p_stats->meanLatency += (latency - p_stats->meanLatency) / p_stats->acknowledged;
+        p_current->inFlightHead = (p_current->inFlightHead + 1) % MAX_WINDOW;
+        p_current->inFlightCount--;
     }
+}
 
-    if (quantityToRead == 0)
+static void expire()
+{
+    const long time = nowMicro();
+
+    while (p_current->inFlightCount > 0 && time - p_current->a_inFlight[p_current->inFlightHead].sentAt >= ACK_TIMEOUT * 1000L)
     {
-        data = convertDataReception(data.order, data.direction, data.speed, data.collision, data.luminosity);
-        TRACE("Receive data:\tDirection: %d - Event: %d - Speed: %d - Collision: %d - Luminosity: %d\n\n", data.direction, data.order, data.speed, data.collision, data.luminosity);
+        p_current->ackStats.expired++;
+        p_current->inFlightHead = (p_current->inFlightHead + 1) % MAX_WINDOW;
+        p_current->inFlightCount--;
     }
+}
 
-    return data;
+static long nowMicro()
+{
+    return (long)Clock_monotonic();
 }
 
-static Data_s convertDataReception(const Order_e order, const Direction_e direction, const int speed, const bool_e collision, const int luminosity)
+static int frameSize()
 {
-    Data_s data;
-    data.direction = ntohl(direction);
-    data.order = ntohl(order);
-    data.collision = ntohl(collision);
-    data.luminosity = ntohl(luminosity);
-    data.speed = ntohl(speed);
-    return data;
+    Data_s header;
+
+    if (p_current->inboxSize < (int)sizeof(Data_s))
+    {
+        return 0;
+    }
+    memcpy(&header, p_current->a_inbox, sizeof(header));
+    Codec_decodeFrames(&header, &header, 1);
+    if (header.size < 0 || header.size > MAX_PAYLOAD || header.size % sizeof(int32_t) != 0)
+    {
+        return -1;
+    }
+    return (p_current->inboxSize >= (int)sizeof(Data_s) + header.size) ? (int)sizeof(Data_s) + header.size : 0;
 }
 
-static Data_s convertDataSend(const Order_e order, const Direction_e direction, const int speed, const bool_e collision, const int luminosity)
+static bool_e receive()
 {
-    Data_s data;
-    data.direction = htonl(direction);
-    data.order = htonl(order);
-    data.collision = htonl(collision);
-    data.luminosity = htonl(luminosity);
-    data.speed = htonl(speed);
-    return data;
-}
\ No newline at end of file
+    ssize_t count;
+
+    do
+    {
+        count = read(p_current->socket_ecoute, p_current->a_inbox + p_current->inboxSize, MAX_FRAME - p_current->inboxSize);
+    } while (count < 0 && errno == EINTR);
+
+    if (count < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            printf("%sErreur lors de la réception du message%s\n", "\033[41m", "\033[0m");
+            p_current->connected = FALSE;
+        }
+        return FALSE;
+    }
+    else if (count == 0)
+    {
+        p_current->connected = FALSE; // The server closed the connection
+        return FALSE;
+    }
+    p_current->lastArrival = Clock_now();
+    p_current->inboxSize += count;
+    return TRUE;
+}
@@ -33,39 +33,213 @@
  */
 
 #include "../../common.h"
+#include "../../clock/clock.h"
 
 #ifndef _CLIENT_
 #define _CLIENT_
 
 /**
- * @brief Initializes the client and the connection
+ * @brief Largest number of numbered orders in flight
+ */
+#define MAX_WINDOW (64)
+
+/**
+ * @brief Largest number of servers the client can be connected to
+ */
+#define MAX_SERVERS (16)
+
+/**
+ * @brief The acknowledgements of the numbered orders
+ */
+typedef struct
+{
+    unsigned long acknowledged; // Orders acknowledged by commando
+    unsigned long unanswered;   // Requests acknowledged without their answer (shed by commando)
+    unsigned long expired;      // Orders never acknowledged, taken out of the window
+    unsigned long refused;      // Orders not sent, the window being full
+    int lastLatency;            // From the sending of the last order acknowledged to its acknowledgement (µs)
+    int maxLatency;             // µs
+    double meanLatency;         // µs
+} AckStats_s;
+
+/**
+ * @brief Initializes the client and the connection to the default server, which becomes the current one
  */
 extern void Client_new();
 
+/**
+ * @brief Adds a server, without connecting to it
+ *
+ * All the other functions work on the current server, see Client_select().
+ *
+ * @param host Name or address of the server
+ * @param port Port of the server
+ * @return int Index of the server, -1 on error
+ */
+extern int Client_add(const char *host, int port);
+
+/**
+ * @brief Chooses the server the other functions work on
+ *
+ * @param index Index given by Client_add(), the first server is 0
+ */
+extern void Client_select(int index);
+
+/**
+ * @brief Gives the number of servers added
+ *
+ * @return int The number of servers
+ */
+extern int Client_getCount();
+
+/**
+ * @brief Gives the socket of the current server
+ *
+ * @return int The socket, -1 after a failed connection until the next attempt
+ */
+extern int Client_getSocket();
+
+/**
+ * @brief Starts connecting to the current server without waiting, instead of Client_start()
+ *
+ * If the connection is in progress, the socket becomes writable once it is
+ * decided, then Client_finishConnect() must be called.
+ *
+ * @return bool_e FALSE if the connection failed at once
+ */
+extern bool_e Client_connect();
+
+/**
+ * @brief Tells whether a connection started by Client_connect() is in progress
+ *
+ * @return bool_e TRUE until Client_finishConnect()
+ */
+extern bool_e Client_isConnecting();
+
+/**
+ * @brief Ends a connection started by Client_connect(), once its socket is writable
+ *
+ * @return bool_e TRUE if connected, FALSE if it failed (the socket is closed)
+ */
+extern bool_e Client_finishConnect();
+
 /**
  * @brief Starts the client
  *
+ * Once connected, a few pings give a first estimate of the clock of the server.
+ *
  * @return int* socket for connexion
  */
 extern int *Client_start();
 
 /**
- * @brief Stopping client
+ * @brief Hides the connection progress messages (headless use)
+ *
+ * @param isQuiet TRUE to hide them
+ */
+extern void Client_setQuiet(bool_e isQuiet);
+
+/**
+ * @brief Tells whether the connection with the server is up
+ *
+ * @return TRUE once connected, FALSE before or after the server closed it
+ */
+extern bool_e Client_isConnected();
+
+/**
+ * @brief Stopping client: closes the connection to the current server
  */
 extern void Client_stop();
 
+/**
+ * @brief Chooses the number of numbered orders in flight, to be called before Client_start()
+ *
+ * @param size Between 1 and MAX_WINDOW
+ */
+extern void Client_setWindow(int size);
+
+/**
+ * @brief Tells whether the next order will be sent
+ *
+ * The orders never acknowledged leave the window after a while.
+ *
+ * @return FALSE while the window is full
+ */
+extern bool_e Client_canSend();
+
 /**
  * @brief Send the data for the pilot
  *
  * @param data Data to be sent
+ * @return uint32_t Number of the order, 0 if it was not sent
+ */
+extern uint32_t Client_sendMsg(Data_s data);
+
+/**
+ * @brief Send an order followed by a payload
+ *
+ * Every order is numbered: with the window full, it is refused and counted in AckStats_s.refused,
+ * Client_canSend() telling beforehand.
+ *
+ * @param data Order to be sent
+ * @param payload 32-bit integers in host byte order
+ * @param size Bytes of payload, multiple of 4 and at most MAX_PAYLOAD
+ * @return uint32_t Number of the order, 0 if it was refused (window full) or not sent
+ */
+extern uint32_t Client_sendPayload(Data_s data, const void *payload, int size);
+
+/**
+ * @brief Writes the frames the socket could not take yet, to be called once it is writable
+ *
+ * @return bool_e FALSE on error, the frames waiting are then lost
+ */
+extern bool_e Client_flush();
+
+/**
+ * @brief Tells whether frames wait for the socket to be writable
+ *
+ * @return bool_e TRUE if Client_flush() has something to write
+ */
+extern bool_e Client_hasPending();
+
+/**
+ * @brief Read a message received from the server, without waiting
+ *
+ * The bytes are gathered until a frame is whole: once the socket is readable, to be called
+ * until it returns FALSE. Client_isConnected() then tells whether the server left.
+ *
+ * @param p_data Where to write the message
+ * @return bool_e TRUE if a whole message was read
+ */
+extern bool_e Client_readMsg(Data_s *p_data);
+
+/**
+ * @brief Gives the payload of the last message read
+ *
+ * @param size Where to write the number of bytes (0 without payload)
+ * @return const void* 32-bit integers in host byte order, valid until the next Client_readMsg()
+ */
+extern const void *Client_getPayload(int *size);
+
+/**
+ * @brief Sends a ping if the last one is old enough, to be called regularly
+ *
+ * The answer is handled by Client_readMsg(), which returns it as O_PING.
+ */
+extern void Client_ping();
+
+/**
+ * @brief Gives the estimate of the clock of the server and the last latencies
+ *
+ * @return const ClockEstimate_s* The estimate, updated by Client_readMsg()
  */
-extern void Client_sendMsg(Data_s data);
+extern const ClockEstimate_s *Client_getClock();
 
 /**
- * @brief Read messages received from the server
+ * @brief Gives the acknowledgements received so far
  *
- * @return Data_s Data sent
+ * @return const AckStats_s* The counters, updated by Client_readMsg()
  */
-extern Data_s Client_readMsg();
+extern const AckStats_s *Client_getAckStats();
 
 #endif // _CLIENT_
@@ -0,0 +1,527 @@
+/**
+ * @file dashboard.c
+ *
+ * @see dashboard.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <math.h>
+#include <signal.h>
+#include <sys/select.h>
+
+#include "../../common.h"
+#include "../client/client.h"
+#include "../screen/screen.h"
+#include "../input/input.h"
+#include "../fleet/fleet.h"
+#include "../../clock/clock.h"
+#include "dashboard.h"
+
+/**
+ * @brief The keys driving the chosen robot, as in the remote control
+ */
+#define LEFT_KEY 'q'
+#define RIGHT_KEY 'd'
+#define FORWARD_KEY 'z'
+#define BACK_KEY 's'
+#define STOP_KEY ' '
+
+/**
+ * @brief The key choosing the next robot, the digits choose one directly
+ */
+#define NEXT_KEY '\t'
+
+/**
+ * @brief The key switching the hold-to-drive mode
+ */
+#define HOLD_KEY 'h'
+
+/**
+ * @brief The exit key
+ */
+#define QUIT_KEY 'a'
+
+/**
+ * @brief Period of the state requests to each robot (ms)
+ */
+#define REFRESH_PERIOD (250)
+
+/**
+ * @brief Time between two connection attempts to an unreachable robot (ms)
+ */
+#define RECONNECT_PERIOD (2000)
+
+/**
+ * @brief Age after which a state is shown as old (ms)
+ */
+#define STALE_STATE (1000)
+
+/**
+ * @brief Step of the power allowed by the fleet, finer changes are not sent (%)
+ */
+#define LIMIT_STEP (10)
+
+/**
+ * @brief Columns of the table
+ */
+#define TABLE_COLUMNS (112)
+
+/**
+ * @brief A robot of the table
+ */
+typedef struct
+{
+    char a_name[80];     // "host:port"
+    PilotState_s state;  // Last state received
+    bool_e hasState;
+    long lastState;      // ms
+    long lastRequest;    // ms
+    long lastAttempt;    // ms, connection
+    PoseReport_s origin; // Start of the robot in the frame of the fleet
+    Direction_e direction; // Asked for by the operator
+    int limit;           // Power allowed by the fleet when the direction was last sent, -1: to send
+} Row_s;
+
+/**
+ * @brief Asks for the states, connects the robots not connected yet
+ *
+ * @param time Current time (ms)
+ */
+static void refresh(long time);
+
+/**
+ * @brief Handles what happened on the connection of a robot
+ *
+ * @param index The robot
+ * @param readFd The sockets ready to be read
+ * @param writeFd The sockets ready to be written
+ * @param time Current time (ms)
+ */
+static void serve(int index, fd_set *readFd, fd_set *writeFd, long time);
+
+/**
+ * @brief Sends the direction of a robot again when the power its neighbours allow changes
+ *
+ * @param index The robot
+ */
+static void steer(int index);
+
+/**
+ * @brief Handles a key of the operator
+ *
+ * @param key The key
+ */
+static void capture(char key);
+
+/**
+ * @brief Stops the driven robot when the key driving it is released, in hold-to-drive mode
+ *
+ * @param key The key released
+ */
+static void release(char key);
+
+/**
+ * @brief Sends a direction to the driven robot
+ *
+ * @param direction The direction
+ */
+static void drive(Direction_e direction);
+
+/**
+ * @brief Draws the table into the next frame
+ *
+ * @param time Current time (ms)
+ */
+static void render(long time);
+
+/**
+ * @brief Asks the loop to stop
+ *
+ * @param signal The signal received
+ */
+static void onSignal(int signal);
+
+static Row_s a_rows[MAX_SERVERS];
+static int rowCount = 0;
+static int driven = 0; // Index of the robot driven by the keys
+static volatile sig_atomic_t work;
+static bool_e holdToDrive = FALSE; // The robot only moves while a key is held
+
+extern void Dashboard_new(const char *const a_servers[], int count)
+{
+    for (int i = 0; i < count && rowCount < MAX_SERVERS; i++)
+    {
+        char a_address[80];
+        char a_host[64];
+        const char *p_at = strchr(a_servers[i], '@');
+        int x = 0;
+        int y = 0;
+        int heading = 0;
+
+        // "host[:port][@x,y[,heading]]", the start is in mm and degrees
+        snprintf(a_address, sizeof(a_address), "%.*s", (p_at != NULL) ? (int)(p_at - a_servers[i]) : (int)strlen(a_servers[i]), a_servers[i]);
+        if (p_at != NULL)
+        {
+            sscanf(p_at + 1, "%d,%d,%d", &x, &y, &heading);
+        }
+
+        const char *p_colon = strrchr(a_address, ':');
+        const size_t length = (p_colon != NULL) ? (size_t)(p_colon - a_address) : strlen(a_address);
+        const int port = (p_colon != NULL) ? atoi(p_colon + 1) : PORT_SERVER;
+
+        snprintf(a_host, sizeof(a_host), "%.*s", (int)length, a_address);
+        if (Client_add(a_host, port) < 0)
+        {
+            exit(EXIT_FAILURE);
+        }
+        memset(&a_rows[rowCount], 0, sizeof(Row_s));
+        snprintf(a_rows[rowCount].a_name, sizeof(a_rows[rowCount].a_name), "%s:%d", a_host, port);
+        a_rows[rowCount].lastAttempt = -RECONNECT_PERIOD; // At once
+        a_rows[rowCount].origin.x = x;
+        a_rows[rowCount].origin.y = y;
+        a_rows[rowCount].origin.heading = (int)lround(heading * M_PI / 180.0 * 1000.0);
+        a_rows[rowCount].direction = D_STOP;
+        a_rows[rowCount].limit = 100;
+        rowCount++;
+    }
+}
+
+extern void Dashboard_start()
+{
+    InputEvent_s a_events[MAX_INPUT_EVENTS];
+    struct sigaction action;
+
+    // Without SA_RESTART, select() is interrupted and the loop ends
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &onSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    // Set after the handlers above, which it restores the terminal before
+    Input_new(DEFAULT_HOLD_TIMEOUT);
+
+    Screen_new(3 + rowCount, TABLE_COLUMNS);
+    Fleet_new(rowCount);
+    work = TRUE;
+    while (work == TRUE)
+    {
+        fd_set readFd;
+        fd_set writeFd;
+        long time = Clock_milliseconds();
+
+        refresh(time);
+
+        // The neighbours of each robot are checked at each turn, with the last poses
+        Fleet_index();
+        for (int i = 0; i < rowCount; i++)
+        {
+            steer(i);
+        }
+        render(time);
+
+        // The frame rate may hold the drawing back
+        const int frameDelay = Screen_flush();
+        const int holdDelay = Input_getTimeout();
+        long timeout = (frameDelay > 0 && frameDelay < REFRESH_PERIOD / 2) ? frameDelay : REFRESH_PERIOD / 2;
+        if (holdDelay >= 0 && holdDelay < timeout)
+        {
+            timeout = holdDelay;
+        }
+        struct timeval delay = {0, timeout * 1000};
+
+        FD_ZERO(&readFd);
+        FD_ZERO(&writeFd);
+        FD_SET(STDIN_FILENO, &readFd);
+        for (int i = 0; i < rowCount; i++)
+        {
+            Client_select(i);
+            if (Client_isConnecting() == TRUE)
+            {
+                FD_SET(Client_getSocket(), &writeFd); // Writable once the connection is decided
+            }
+            else if (Client_isConnected() == TRUE)
+            {
+                FD_SET(Client_getSocket(), &readFd);
+                if (Client_hasPending() == TRUE)
+                {
+                    FD_SET(Client_getSocket(), &writeFd); // The orders the socket could not take yet
+                }
+            }
+        }
+        const int ready = select(FD_SETSIZE, &readFd, &writeFd, NULL, &delay);
+        if (ready < 0)
+        {
+            continue; // Signal
+        }
+
+        // Polled on a timeout too, a held key may have been released
+        time = Clock_milliseconds();
+        const int eventCount = Input_poll(a_events, MAX_INPUT_EVENTS, (ready > 0 && FD_ISSET(STDIN_FILENO, &readFd)) ? TRUE : FALSE);
+        for (int i = 0; i < eventCount; i++)
+        {
+            if (a_events[i].kind == IN_PRESS)
+            {
+                capture(a_events[i].key);
+            }
+            else
+            {
+                release(a_events[i].key);
+            }
+        }
+        if (ready == 0)
+        {
+            continue;
+        }
+        for (int i = 0; i < rowCount; i++)
+        {
+            serve(i, &readFd, &writeFd, time);
+        }
+    }
+    Input_free();
+}
+
+extern void Dashboard_stop()
+{
+    drive(D_STOP); // Only the driven robot moves by the keys, the others keep their orders
+    for (int i = 0; i < rowCount; i++)
+    {
+        Client_select(i);
+        Client_stop();
+    }
+    Screen_free();
+    Fleet_free();
+    printf("\n%sStop%s\n", "\033[31m", "\033[0m");
+}
+
+static void refresh(long time)
+{
+    const Data_s request = {O_ASK_LOG, D_STOP, 0, 0, 0, 0};
+    const Data_s poseRequest = {O_POSE, D_STOP, 0, 0, 0, 0};
+
+    for (int i = 0; i < rowCount; i++)
+    {
+        Row_s *p_row = &a_rows[i];
+
+        Client_select(i);
+        if (Client_isConnected() == TRUE)
+        {
+            Client_ping();
+            if (time - p_row->lastRequest >= REFRESH_PERIOD)
+            {
+                Client_sendMsg(request);
+                Client_sendMsg(poseRequest);
+                p_row->lastRequest = time;
+            }
+        }
+        else if (Client_isConnecting() == FALSE && time - p_row->lastAttempt >= RECONNECT_PERIOD)
+        {
+            p_row->lastAttempt = time;
+            Client_connect();
+        }
+    }
+}
+
+static void serve(int index, fd_set *readFd, fd_set *writeFd, long time)
+{
+    Row_s *p_row = &a_rows[index];
+    Data_s data;
+
+    Client_select(index);
+    if (Client_getSocket() < 0)
+    {
+        return;
+    }
+    if (Client_isConnecting() == TRUE)
+    {
+        if (FD_ISSET(Client_getSocket(), writeFd))
+        {
+            Client_finishConnect();
+        }
+        return;
+    }
+    if (Client_isConnected() == TRUE && FD_ISSET(Client_getSocket(), writeFd))
+    {
+        Client_flush();
+    }
+    if (Client_isConnected() == FALSE || FD_ISSET(Client_getSocket(), readFd) == 0)
+    {
+        return;
+    }
+    while (Client_readMsg(&data) == TRUE)
+    {
+        if (data.order == O_ASK_LOG)
+        {
+            p_row->state.speed = data.speed;
+            p_row->state.collision = data.collision;
+            p_row->state.luminosity = data.luminosity;
+            p_row->hasState = TRUE;
+            p_row->lastState = time;
+        }
+        else if (data.order == O_POSE)
+        {
+            int size;
+            const PoseReport_s *p_pose = (const PoseReport_s *)Client_getPayload(&size);
+
+            if (p_pose != NULL && size == sizeof(PoseReport_s))
+            {
+                // From the frame of the robot, starting at (0, 0), to the frame of the fleet
+                const double angle = p_row->origin.heading / 1000.0;
+                const PoseReport_s pose = {p_row->origin.x + (int)lround(p_pose->x * cos(angle) - p_pose->y * sin(angle)),
+                                           p_row->origin.y + (int)lround(p_pose->x * sin(angle) + p_pose->y * cos(angle)),
+                                           p_row->origin.heading + p_pose->heading};
+
+                Fleet_setPose(index, pose);
+            }
+        }
+    }
+    if (Client_isConnected() == FALSE)
+    {
+        Client_stop(); // Tried again later
+        p_row->lastAttempt = time;
+        p_row->direction = D_STOP;
+        p_row->limit = 100;
+        Fleet_forget(index);
+    }
+}
+
+static void capture(char key)
+{
+    switch (key)
+    {
+    case LEFT_KEY:
+        drive(D_LEFT);
+        break;
+    case RIGHT_KEY:
+        drive(D_RIGHT);
+        break;
+    case FORWARD_KEY:
+        drive(D_FORWARD);
+        break;
+    case BACK_KEY:
+        drive(D_BACKWARD);
+        break;
+    case STOP_KEY:
+        drive(D_STOP);
+        break;
+    case HOLD_KEY:
+        holdToDrive = !holdToDrive;
+        break;
+    case NEXT_KEY:
+        driven = (driven + 1) % rowCount;
+        break;
+    case QUIT_KEY:
+        work = FALSE;
+        break;
+    default:
+        if (key >= '1' && key <= '9' && key - '1' < rowCount)
+        {
+            driven = key - '1';
+        }
+        break;
+    }
+}
+
+static void release(char key)
+{
+    if (holdToDrive == TRUE && (key == LEFT_KEY || key == RIGHT_KEY || key == FORWARD_KEY || key == BACK_KEY))
+    {
+        drive(D_STOP);
+    }
+}
+
+static void drive(Direction_e direction)
+{
+    a_rows[driven].direction = direction;
+    a_rows[driven].limit = -1; // Sent even if the power allowed did not change
+    steer(driven);
+}
+
+static void steer(int index)
+{
+    Row_s *p_row = &a_rows[index];
+    const int allowed = Fleet_limit(index, p_row->direction);
+    const int limit = (allowed == 100) ? allowed : allowed - allowed % LIMIT_STEP;
+
+    Client_select(index);
+    if (Client_isConnected() == FALSE || limit == p_row->limit)
+    {
+        return;
+    }
+    p_row->limit = limit;
+    if (limit == 100)
+    {
+        Data_s data = {O_CHANGE_MVT, D_STOP, 0, 0, 0, 0};
+
+        data.direction = p_row->direction;
+        Client_sendMsg(data);
+    }
+    else
+    {
+        // Slowed down or held, the direction asked for is kept for when the way is clear
+        const Setpoint_s setpoint = {SP_TWIST, (p_row->direction == D_FORWARD) ? limit : -limit, 0};
+        const Data_s data = {O_SETPOINT, D_STOP, 0, 0, 0, 0};
+
+        Client_sendPayload(data, &setpoint, sizeof(setpoint));
+    }
+}
+
+static void render(long time)
+{
+    Screen_clear();
+    const int quit = Screen_print(0, 0, SC_DEFAULT, "Robots : %d    %c%c%c%c espace : conduire    %c : maintenue (%s)    1-9 tab : choisir    %c : ",
+                                  rowCount, FORWARD_KEY, LEFT_KEY, BACK_KEY, RIGHT_KEY, HOLD_KEY, holdToDrive ? "oui" : "non", QUIT_KEY);
+    Screen_print(0, quit, SC_RED, "Quitter");
+    Screen_print(2, 0, SC_DEFAULT, "    #  %-24s %-10s %8s  %-9s %9s %10s          %s", "Serveur", "Liaison", "Vitesse", "Collision", "Lumière", "Ordres", "Flotte");
+    for (int i = 0; i < rowCount; i++)
+    {
+        const Row_s *p_row = &a_rows[i];
+        const int row = 3 + i;
+
+        Client_select(i);
+        Screen_print(row, 0, SC_DEFAULT, "%s %2d  %s", (i == driven) ? " >" : "  ", i + 1, p_row->a_name);
+        if (Client_isConnected() == TRUE)
+        {
+            // Saturated, the orders are refused until the robot acknowledges
+            Screen_print(row, 32, Client_canSend() ? SC_GREEN : SC_RED, Client_canSend() ? "connecté" : "saturée");
+        }
+        else
+        {
+            Screen_print(row, 32, Client_isConnecting() ? SC_YELLOW : SC_RED, Client_isConnecting() ? "connexion" : "absent");
+        }
+        if (Client_isConnected() == TRUE && p_row->hasState == TRUE)
+        {
+            const AckStats_s *p_acks = Client_getAckStats();
+
+            Screen_print(row, 43, SC_DEFAULT, "%8d", p_row->state.speed);
+            Screen_print(row, 53, p_row->state.collision ? SC_RED : SC_GREEN, p_row->state.collision ? "Oui" : "Non");
+            Screen_print(row, 63, SC_DEFAULT, "%8d %7.1f ms", p_row->state.luminosity, p_acks->lastLatency / 1000.0);
+            if (time - p_row->lastState >= STALE_STATE)
+            {
+                Screen_print(row, 83, SC_YELLOW, "(ancien)");
+            }
+            if (p_row->limit == 0)
+            {
+                Screen_print(row, 93, SC_RED, "bloqué");
+            }
+            else if (p_row->limit > 0 && p_row->limit < 100)
+            {
+                Screen_print(row, 93, SC_YELLOW, "ralenti %d %%", p_row->limit);
+            }
+        }
+        else
+        {
+            Screen_print(row, 43, SC_DEFAULT, "%8s  %-9s %8s %10s", "-", "-", "-", "-");
+        }
+    }
+}
+
+static void onSignal(int signal)
+{
+    work = FALSE;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file  dashboard.h
+ *
+ * @brief  Live table of several robots, one of them driven from the keyboard
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _DASHBOARD_
+#define _DASHBOARD_
+
+#include "../../common.h"
+
+/**
+ * @brief Adds the servers of the robots to the client
+ *
+ * @param a_servers "host" or "host:port" of each server (port PORT_SERVER by default)
+ * @param count Number of servers, at most MAX_SERVERS
+ */
+extern void Dashboard_new(const char *const a_servers[], int count);
+
+/**
+ * @brief Shows the state of every robot and drives the chosen one until the operator quits
+ *
+ * One event loop serves the keyboard and all the connections. A robot that
+ * can not be reached or leaves is tried again regularly.
+ */
+extern void Dashboard_start();
+
+/**
+ * @brief Stops the driven robot and closes the connections
+ */
+extern void Dashboard_stop();
+
+#endif // _DASHBOARD_
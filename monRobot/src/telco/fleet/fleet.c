@@ -0,0 +1,173 @@
+/**
+ * @file fleet.c
+ *
+ * @see fleet.h
+ *
+ * The plane is cut into square cells as wide as the slowdown radius, and the
+ * cells are hashed into buckets chaining the robots placed in them. A robot
+ * only compares itself with the robots of the 3 x 3 cells around its own:
+ * indexing the fleet and checking every robot costs O(N), not O(N²).
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../../common.h"
+#include "fleet.h"
+
+/**
+ * @brief Side of a cell of the spatial hash (mm), a neighbour to consider is in an adjacent cell
+ */
+#define CELL_SIZE (SLOWDOWN_RADIUS)
+
+/**
+ * @brief A robot of the fleet
+ */
+typedef struct
+{
+    PoseReport_s pose;
+    bool_e known;
+    int column; // Cell of the robot
+    int row;
+    int next;   // Next robot of the same bucket, -1: none
+} Member_s;
+
+/**
+ * @brief Gives the bucket of a cell
+ *
+ * @param column Column of the cell
+ * @param row Row of the cell
+ * @return int The bucket
+ */
+static int bucketOf(int column, int row);
+
+/**
+ * @brief Gives the cell of a coordinate
+ *
+ * @param coordinate The coordinate (mm)
+ * @return int The cell, rounded down for the negative coordinates too
+ */
+static int cellOf(int coordinate);
+
+static Member_s *a_members = NULL;
+static int *a_buckets = NULL; // First robot of each bucket, -1: none
+static int memberCount = 0;
+static int bucketMask = 0;    // Number of buckets - 1
+
+extern void Fleet_new(int capacity)
+{
+    int bucketCount = 2;
+
+    while (bucketCount < 2 * capacity)
+    {
+        bucketCount <<= 1; // Few collisions, the buckets are masked
+    }
+    a_members = (Member_s *)calloc(capacity, sizeof(Member_s));
+    a_buckets = (int *)malloc(bucketCount * sizeof(int));
+    if (a_members == NULL || a_buckets == NULL)
+    {
+        perror("Erreur lors de la création de la flotte");
+        exit(EXIT_FAILURE);
+    }
+    memberCount = capacity;
+    bucketMask = bucketCount - 1;
+    memset(a_buckets, -1, bucketCount * sizeof(int));
+}
+
+extern void Fleet_free()
+{
+    free(a_members);
+    free(a_buckets);
+    a_members = NULL;
+    a_buckets = NULL;
+    memberCount = 0;
+}
+
+extern void Fleet_setPose(int index, PoseReport_s pose)
+{
+    a_members[index].pose = pose;
+    a_members[index].known = TRUE;
+}
+
+extern void Fleet_forget(int index)
+{
+    a_members[index].known = FALSE;
+}
+
+extern void Fleet_index()
+{
+    memset(a_buckets, -1, (bucketMask + 1) * sizeof(int));
+    for (int i = 0; i < memberCount; i++)
+    {
+        Member_s *p_member = &a_members[i];
+
+        if (p_member->known == FALSE)
+        {
+            continue;
+        }
+        p_member->column = cellOf(p_member->pose.x);
+        p_member->row = cellOf(p_member->pose.y);
+
+        const int bucket = bucketOf(p_member->column, p_member->row);
+        p_member->next = a_buckets[bucket];
+        a_buckets[bucket] = i;
+    }
+}
+
+extern int Fleet_limit(int index, Direction_e direction)
+{
+    const Member_s *p_self = &a_members[index];
+    int limit = 100;
+
+    if (p_self->known == FALSE || (direction != D_FORWARD && direction != D_BACKWARD))
+    {
+        return limit;
+    }
+
+    // Unit vector of the motion
+    const double sign = (direction == D_FORWARD) ? 1.0 : -1.0;
+    const double motionX = sign * cos(p_self->pose.heading / 1000.0);
+    const double motionY = sign * sin(p_self->pose.heading / 1000.0);
+
+    for (int column = p_self->column - 1; column <= p_self->column + 1; column++)
+    {
+        for (int row = p_self->row - 1; row <= p_self->row + 1; row++)
+        {
+            for (int i = a_buckets[bucketOf(column, row)]; i >= 0; i = a_members[i].next)
+            {
+                const Member_s *p_other = &a_members[i];
+                const double dx = p_other->pose.x - p_self->pose.x;
+                const double dy = p_other->pose.y - p_self->pose.y;
+                const double distance = sqrt(dx * dx + dy * dy);
+
+                // Another cell may share the bucket, the distance sorts them out
+                if (i == index || p_other->column != column || p_other->row != row || distance >= SLOWDOWN_RADIUS)
+                {
+                    continue;
+                }
+                if (dx * motionX + dy * motionY <= 0)
+                {
+                    continue; // Moving away from it
+                }
+
+                const int allowed = (distance <= SAFETY_RADIUS) ? 0 : (int)(100 * (distance - SAFETY_RADIUS) / (SLOWDOWN_RADIUS - SAFETY_RADIUS));
+                limit = (allowed < limit) ? allowed : limit;
+            }
+        }
+    }
+    return limit;
+}
+
+static int bucketOf(int column, int row)
+{
+    return (int)(((unsigned)column * 73856093u) ^ ((unsigned)row * 19349663u)) & bucketMask;
+}
+
+static int cellOf(int coordinate)
+{
+    return (coordinate >= 0) ? coordinate / CELL_SIZE : -((-coordinate + CELL_SIZE - 1) / CELL_SIZE);
+}
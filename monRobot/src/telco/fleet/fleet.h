@@ -0,0 +1,96 @@
+/**
+ * @file  fleet.h
+ *
+ * @brief  Keeps the robots of the dashboard apart from each other
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _FLEET_
+#define _FLEET_
+
+#include "../../common.h"
+
+/**
+ * @brief Distance between two robots under which none of them may come closer (mm)
+ */
+#define SAFETY_RADIUS (400)
+
+/**
+ * @brief Distance between two robots under which the one coming closer is slowed down (mm)
+ */
+#define SLOWDOWN_RADIUS (1000)
+
+/**
+ * @brief Allocates the poses and the spatial hash
+ *
+ * @param capacity Number of robots, indexed from 0
+ */
+extern void Fleet_new(int capacity);
+
+/**
+ * @brief Frees the poses and the spatial hash
+ */
+extern void Fleet_free();
+
+/**
+ * @brief Sets the pose of a robot, taken into account at the next Fleet_index()
+ *
+ * @param index The robot
+ * @param pose Its pose in the frame shared by the fleet
+ */
+extern void Fleet_setPose(int index, PoseReport_s pose);
+
+/**
+ * @brief Forgets the pose of a robot, which is no longer an obstacle
+ *
+ * @param index The robot
+ */
+extern void Fleet_forget(int index);
+
+/**
+ * @brief Places the robots with a known pose in the spatial hash
+ */
+extern void Fleet_index();
+
+/**
+ * @brief Gives how fast a robot may go in a direction, given its neighbours
+ *
+ * Only the neighbours it would come closer to count: a robot may always
+ * turn on the spot, stop or move away. A robot with no known pose is not
+ * limited.
+ *
+ * @param index The robot
+ * @param direction The direction asked for
+ * @return int The power allowed, between 0 (vetoed) and 100 (free)
+ */
+extern int Fleet_limit(int index, Direction_e direction);
+
+#endif // _FLEET_
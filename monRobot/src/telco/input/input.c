@@ -0,0 +1,155 @@
+/**
+ * @file input.c
+ *
+ * @see input.h
+ *
+ * A terminal gives no key release: a held key is only seen through its
+ * repeats. The first byte of a key is a press, its repeats are swallowed,
+ * and the key is released when another one comes or when the repeats stop
+ * for longer than the hold timeout.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "../../common.h"
+#include "../../clock/clock.h"
+#include "input.h"
+
+/**
+ * @brief Signals after which the terminal is restored
+ */
+static const int a_signals[] = {SIGINT, SIGTERM, SIGHUP};
+
+#define SIGNAL_COUNT ((int)(sizeof(a_signals) / sizeof(a_signals[0])))
+
+/**
+ * @brief Restores the terminal, then hands the signal over
+ *
+ * @param signal The signal received
+ */
+static void onSignal(int signal);
+
+static struct termios savedTerminal;
+static volatile sig_atomic_t raw = FALSE;
+static struct sigaction a_previous[SIGNAL_COUNT];
+static int holdTimeout = DEFAULT_HOLD_TIMEOUT;
+static char heldKey = '\0'; // '\0': none
+static long lastSeen = 0;   // Last press or repeat of the held key (ms)
+
+extern void Input_new(int timeout)
+{
+    struct termios terminal;
+    struct sigaction action;
+
+    holdTimeout = (timeout > 0) ? timeout : DEFAULT_HOLD_TIMEOUT;
+    heldKey = '\0';
+    if (tcgetattr(STDIN_FILENO, &savedTerminal) != 0)
+    {
+        return; // Not a terminal, the keys come as they are
+    }
+    terminal = savedTerminal;
+    terminal.c_lflag &= ~(ICANON | ECHO);
+    terminal.c_cc[VMIN] = 1;
+    terminal.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &terminal);
+    raw = TRUE;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &onSignal;
+    for (int i = 0; i < SIGNAL_COUNT; i++)
+    {
+        sigaction(a_signals[i], &action, &a_previous[i]);
+    }
+    atexit(&Input_free);
+}
+
+extern void Input_free()
+{
+    if (raw == TRUE)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &savedTerminal);
+        raw = FALSE;
+    }
+}
+
+extern int Input_poll(InputEvent_s a_events[], int size, bool_e readable)
+{
+    char a_keys[INPUT_BATCH];
+    const long time = Clock_milliseconds();
+    ssize_t keyCount = 0;
+    int count = 0;
+
+    if (heldKey != '\0' && time - lastSeen >= holdTimeout && count < size)
+    {
+        a_events[count].kind = IN_RELEASE; // The repeats stopped
+        a_events[count].key = heldKey;
+        count++;
+        heldKey = '\0';
+    }
+    if (readable == TRUE)
+    {
+        // A key gives at most a release and a press
+        const int room = (size - count) / 2;
+
+        keyCount = read(STDIN_FILENO, a_keys, (room < INPUT_BATCH) ? room : INPUT_BATCH);
+    }
+    for (ssize_t i = 0; i < keyCount; i++)
+    {
+        if (a_keys[i] == heldKey)
+        {
+            lastSeen = time; // A repeat
+            continue;
+        }
+        if (heldKey != '\0')
+        {
+            a_events[count].kind = IN_RELEASE;
+            a_events[count].key = heldKey;
+            count++;
+        }
+        a_events[count].kind = IN_PRESS;
+        a_events[count].key = a_keys[i];
+        count++;
+        heldKey = a_keys[i];
+        lastSeen = time;
+    }
+    return count;
+}
+
+extern int Input_getTimeout()
+{
+    if (heldKey == '\0')
+    {
+        return -1;
+    }
+
+    const long left = lastSeen + holdTimeout - Clock_milliseconds();
+    return (left > 0) ? (int)left : 0;
+}
+
+static void onSignal(int signal)
+{
+    Input_free();
+    for (int i = 0; i < SIGNAL_COUNT; i++)
+    {
+        if (a_signals[i] != signal)
+        {
+            continue;
+        }
+        if (a_previous[i].sa_handler != SIG_DFL && a_previous[i].sa_handler != SIG_IGN)
+        {
+            a_previous[i].sa_handler(signal); // The program ends on its own
+        }
+        else if (a_previous[i].sa_handler == SIG_DFL)
+        {
+            sigaction(signal, &a_previous[i], NULL);
+            raise(signal);
+        }
+    }
+}
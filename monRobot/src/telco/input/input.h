@@ -0,0 +1,108 @@
+/**
+ * @file  input.h
+ *
+ * @brief  Keyboard in raw mode, key repeats coalesced into presses and releases
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _INPUT_
+#define _INPUT_
+
+#include "../../common.h"
+
+/**
+ * @brief Longest time between two repeats of a held key, above it the key is released (ms)
+ *
+ * Longer than the delay before the first repeat of most terminals.
+ */
+#define DEFAULT_HOLD_TIMEOUT (600)
+
+/**
+ * @brief Largest number of keys read at once
+ */
+#define INPUT_BATCH (64)
+
+/**
+ * @brief Events given at most by Input_poll(): a release and a press per key, and the release of a timeout
+ */
+#define MAX_INPUT_EVENTS (2 * INPUT_BATCH + 1)
+
+typedef enum
+{
+    IN_PRESS = 0, // A key pressed, its repeats are not reported
+    IN_RELEASE    // The key pressed before: another key came or its repeats stopped
+} InputKind_e;
+
+/**
+ * @brief What happened on the keyboard
+ */
+typedef struct
+{
+    InputKind_e kind;
+    char key;
+} InputEvent_s;
+
+/**
+ * @brief Puts the terminal in raw mode until Input_free(), the exit or a fatal signal
+ *
+ * A handler installed before for SIGINT, SIGTERM or SIGHUP is still called,
+ * after the terminal was restored.
+ *
+ * @param holdTimeout Longest time between two repeats of a key (ms), DEFAULT_HOLD_TIMEOUT if not positive
+ */
+extern void Input_new(int holdTimeout);
+
+/**
+ * @brief Restores the terminal
+ */
+extern void Input_free();
+
+/**
+ * @brief Reads the keys waiting, with one read(), and gives what happened
+ *
+ * Also releases the held key if its repeats stopped, to be called after a select() on
+ * the standard input, ready or not.
+ *
+ * @param a_events Where to write the events
+ * @param size Maximum number of events
+ * @param readable TRUE if the standard input is ready to be read
+ * @return int Number of events
+ */
+extern int Input_poll(InputEvent_s a_events[], int size, bool_e readable);
+
+/**
+ * @brief Gives the time before the held key is released if it is not repeated
+ *
+ * @return int Time (ms), -1 if no key is held
+ */
+extern int Input_getTimeout();
+
+#endif // _INPUT_
@@ -0,0 +1,148 @@
+/**
+ * @file recorder.c
+ *
+ * @see recorder.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/select.h>
+
+#include "../../common.h"
+#include "../client/client.h"
+#include "recorder.h"
+
+/**
+ * @brief Longest wait for a state before checking the signals (s)
+ */
+#define READ_TIMEOUT (1)
+
+/**
+ * @brief Asks the recording to stop
+ *
+ * @param signal The signal received
+ */
+static void onSignal(int signal);
+
+/**
+ * @brief Gives the time of the wall clock
+ *
+ * @return int64_t ms since the epoch
+ */
+static int64_t wallClock();
+
+static int recordFd = -1;
+static volatile sig_atomic_t work;
+
+extern void Recorder_new(const char *path)
+{
+    recordFd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (recordFd < 0)
+    {
+        fprintf(stderr, "Impossible d'ouvrir %s : %s\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    Client_setQuiet(TRUE);
+    Client_new();
+}
+
+extern void Recorder_start()
+{
+    const Data_s observe = {O_OBSERVE, D_STOP, 0, 0, 0, 0};
+    struct sigaction action;
+    long recordCount = 0;
+    int socket_donnees;
+
+    socket_donnees = *Client_start();
+    if (Client_isConnected() == FALSE)
+    {
+        fprintf(stderr, "Serveur injoignable\n");
+        return;
+    }
+    Client_sendMsg(observe);
+
+    // Without SA_RESTART, select() is interrupted and the loop ends
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = &onSignal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    work = TRUE;
+    while (work == TRUE)
+    {
+        fd_set readFd;
+        fd_set writeFd;
+        struct timeval delay = {READ_TIMEOUT, 0};
+        Data_s state;
+
+        Client_ping();
+        FD_ZERO(&readFd);
+        FD_ZERO(&writeFd);
+        FD_SET(socket_donnees, &readFd);
+        if (Client_hasPending() == TRUE)
+        {
+            FD_SET(socket_donnees, &writeFd);
+        }
+        if (select(socket_donnees + 1, &readFd, &writeFd, NULL, &delay) <= 0)
+        {
+            continue; // Timeout or signal
+        }
+        if (FD_ISSET(socket_donnees, &writeFd))
+        {
+            Client_flush();
+        }
+
+        while (work == TRUE && Client_readMsg(&state) == TRUE)
+        {
+            if (state.order != O_ASK_LOG)
+            {
+                continue;
+            }
+
+            const TelemetryRecord_s record = {wallClock(), state.speed, state.collision, state.luminosity, 0};
+            if (write(recordFd, &record, sizeof(record)) != sizeof(record))
+            {
+                fprintf(stderr, "Erreur lors de l'écriture : %s\n", strerror(errno));
+                work = FALSE;
+                break;
+            }
+            recordCount++;
+        }
+        if (Client_isConnected() == FALSE)
+        {
+            break;
+        }
+    }
+    fprintf(stderr, "%ld états enregistrés\n", recordCount);
+}
+
+extern void Recorder_stop()
+{
+    if (recordFd >= 0)
+    {
+        close(recordFd);
+        recordFd = -1;
+    }
+    Client_stop();
+}
+
+static void onSignal(int signal)
+{
+    work = FALSE;
+}
+
+static int64_t wallClock()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_REALTIME, &time);
+    return (int64_t)time.tv_sec * 1000 + time.tv_nsec / 1000000;
+}
@@ -15,9 +15,14 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
 
 #include "../../common.h"
 #include "../client/client.h"
+#include "../screen/screen.h"
+#include "../input/input.h"
+#include "../../clock/clock.h"
 #include "remoteUI.h"
 
 /**
@@ -55,13 +60,39 @@
  */
 #define DISPLAY_STATE_KEY 'r'
 
+/**
+ * @brief The key switching the hold-to-drive mode
+ */
+#define HOLD_KEY 'h'
+
 /**
  * @brief The exit key
  */
 #define QUIT_KEY 'a'
 
 /**
- * @brief Displays the keys of the remote control
+ * @brief Period of the state requests, each state adds a bar to the graphs (ms)
+ */
+#define STATE_PERIOD (200)
+
+/**
+ * @brief Number of states kept for the graphs
+ */
+#define HISTORY_LENGTH (40)
+
+/**
+ * @brief Size of the drawing, cut to the terminal
+ */
+#define SCREEN_ROWS (17)
+#define SCREEN_COLUMNS (110)
+
+/**
+ * @brief Column of the graphs
+ */
+#define GRAPH_COLUMN (32)
+
+/**
+ * @brief Draws the keys of the remote control and the state of the robot into the next frame
  */
 static void display();
 
@@ -70,6 +101,13 @@ static void display();
  */
 static void capturechoise(char carractere);
 
+/**
+ * @brief Stops the robot when the key driving it is released, in hold-to-drive mode
+ *
+ * @param carractere The key released
+ */
+static void release(char carractere);
+
 /**
  * @brief Launch the application
  */
@@ -83,17 +121,31 @@ static void run();
 static void askMvt(Direction_e p_dir);
 
 /**
- * @brief Displays the status of the robot
+ * @brief Asks for the status of the robot
  */
 static void ask4Log();
 
 /**
- * @brief Clears text from terminal
+ * @brief Forgets the graphs and draws the whole terminal again
  */
 static void askClearLog();
 
+/**
+ * @brief Keeps a state received for the display
+ *
+ * @param state The state
+ */
+static void keep(const Data_s *state);
+
 static bool_e work;
 static int socket_donnees;
+static Data_s lastState;
+static bool_e hasState = FALSE;
+static int a_speeds[HISTORY_LENGTH]; // From the oldest
+static int a_luminosities[HISTORY_LENGTH];
+static int historyCount = 0;
+static long lastRequest = 0;
+static bool_e holdToDrive = FALSE; // The robot only moves while a key is held
 
 extern void RemoteUI_new()
 {
@@ -102,15 +154,26 @@ extern void RemoteUI_new()
 
 extern void RemoteUI_start()
 {
+    struct winsize size;
+    int rows = SCREEN_ROWS;
+    int columns = SCREEN_COLUMNS;
+
     socket_donnees = *Client_start();
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0)
+    {
+        rows = (size.ws_row - 1 < rows) ? size.ws_row - 1 : rows; // The last row stays for the cursor
+        columns = (size.ws_col < columns) ? size.ws_col : columns;
+    }
+    Screen_new(rows, columns);
     work = TRUE;
     run();
 }
 
 extern void RemoteUI_stop()
 {
+    Screen_free();
     printf("\n%sStop%s\n", "\033[31m", "\033[0m");
-    Data_s data = {0, 0, 0, 0, 0};
+    Data_s data = {0, 0, 0, 0, 0, 0};
 
     data.order = O_STOP;
     Client_sendMsg(data);
@@ -121,7 +184,7 @@ static void askMvt(Direction_e p_dir)
 {
     TRACE("Some Moves - Direction is %d\n", p_dir);
 
-    Data_s data = {0, 0, 0, 0, 0};
+    Data_s data = {0, 0, 0, 0, 0, 0};
     data.direction = p_dir;
     data.order = O_CHANGE_MVT;
     Client_sendMsg(data);
@@ -129,30 +192,71 @@ static void askMvt(Direction_e p_dir)
 
 static void ask4Log()
 {
-    askClearLog();
-
-    Data_s data = {0, 0, 0, 0, 0};
+    Data_s data = {0, 0, 0, 0, 0, 0};
     data.order = O_ASK_LOG;
     Client_sendMsg(data);
+    lastRequest = Clock_milliseconds();
 }
 
 static void askClearLog()
 {
-    printf("\033c");
-    display();
+    historyCount = 0;
+    Screen_invalidate();
 }
 
 static void display()
 {
-    printf("Vous pouvez faire les actions suivantes :\n");
-    printf("%c : Gauche\n", LEFT_KEY);
-    printf("%c : Droite\n", RIGHT_KEY);
-    printf("%c : Avancer\n", FORWARD_KEY);
-    printf("%c : Reculer\n", BACK_KEY);
-    printf("%c : Stopper\n", STOP_KEY);
-    printf("%c : Effacer\n", ERASE_LOG_KEY);
-    printf("%c : Afficher l'état du robot\n\n", DISPLAY_STATE_KEY);
-    printf("%c : \033[31mQuitter\033[00m\n\n", QUIT_KEY);
+    Screen_clear();
+    Screen_print(0, 0, SC_DEFAULT, "Vous pouvez faire les actions suivantes :");
+    Screen_print(1, 0, SC_DEFAULT, "%c : Gauche", LEFT_KEY);
+    Screen_print(2, 0, SC_DEFAULT, "%c : Droite", RIGHT_KEY);
+    Screen_print(3, 0, SC_DEFAULT, "%c : Avancer", FORWARD_KEY);
+    Screen_print(4, 0, SC_DEFAULT, "%c : Reculer", BACK_KEY);
+    Screen_print(5, 0, SC_DEFAULT, "%c : Stopper", STOP_KEY);
+    Screen_print(6, 0, SC_DEFAULT, "%c : Effacer", ERASE_LOG_KEY);
+    Screen_print(7, 0, SC_DEFAULT, "%c : Afficher l'état du robot", DISPLAY_STATE_KEY);
+    Screen_print(8, 0, SC_DEFAULT, "%c : Conduite maintenue (%s)", HOLD_KEY, holdToDrive ? "oui" : "non");
+    Screen_print(9, Screen_print(9, 0, SC_DEFAULT, "%c : ", QUIT_KEY), SC_RED, "Quitter");
+
+    if (hasState == FALSE)
+    {
+        return;
+    }
+    Screen_print(11, 0, SC_DEFAULT, "Vitesse du robot : %d cm/s", lastState.speed);
+    Screen_sparkline(11, GRAPH_COLUMN, SC_BLUE, a_speeds, historyCount, -100, 100);
+    Screen_print(12, Screen_print(12, 0, SC_DEFAULT, "Collision : "), lastState.collision ? SC_RED : SC_GREEN, lastState.collision ? "Oui" : "Non");
+    Screen_print(13, 0, SC_DEFAULT, "Lumière : %d mV", lastState.luminosity);
+    if (historyCount > 0)
+    {
+        int min = a_luminosities[0];
+        int max = a_luminosities[0];
+
+        for (int i = 1; i < historyCount; i++)
+        {
+            min = (a_luminosities[i] < min) ? a_luminosities[i] : min;
+            max = (a_luminosities[i] > max) ? a_luminosities[i] : max;
+        }
+        Screen_sparkline(13, GRAPH_COLUMN, SC_YELLOW, a_luminosities, historyCount, min, max);
+    }
+
+    const ClockEstimate_s *p_clock = Client_getClock();
+    if (p_clock->count > 0)
+    {
+        Screen_print(14, 0, SC_DEFAULT, "Latence : ordres %.1f ms, état %.1f ms (horloge du robot %+.1f ms, dérive %+.1f ppm)",
+                     p_clock->uplink / 1000.0, p_clock->downlink / 1000.0, p_clock->best.offset / 1000.0, p_clock->drift);
+    }
+
+    const AckStats_s *p_acks = Client_getAckStats();
+    if (p_acks->acknowledged > 0)
+    {
+        Screen_print(15, 0, SC_DEFAULT, "Ordres appliqués : %lu, le dernier en %.1f ms (moyenne %.1f ms)",
+                     p_acks->acknowledged, p_acks->lastLatency / 1000.0, p_acks->meanLatency / 1000.0);
+    }
+    if (p_acks->refused > 0)
+    {
+        // Red while the robot still does not acknowledge, the keys pressed meanwhile are lost
+        Screen_print(16, 0, (Client_canSend() == TRUE) ? SC_YELLOW : SC_RED, "Ordres refusés : %lu, fenêtre pleine faute d'acquittements du robot", p_acks->refused);
+    }
 }
 
 static void capturechoise(char carractere)
@@ -180,6 +284,9 @@ static void capturechoise(char carractere)
     case DISPLAY_STATE_KEY:
         ask4Log();
         break;
+    case HOLD_KEY:
+        holdToDrive = !holdToDrive;
+        break;
     case QUIT_KEY:
         work = FALSE;
         break;
@@ -188,59 +295,109 @@ static void capturechoise(char carractere)
     }
 }
 
-static void run()
+static void release(char carractere)
 {
-
-    if (work == TRUE)
+    if (holdToDrive == TRUE && (carractere == LEFT_KEY || carractere == RIGHT_KEY || carractere == FORWARD_KEY || carractere == BACK_KEY))
     {
-        askClearLog();
+        askMvt(D_STOP);
     }
+}
 
-    fd_set writeFd;
-    FD_ZERO(&writeFd); // Initialization of the file descriptor
+static void run()
+{
+    InputEvent_s a_events[MAX_INPUT_EVENTS];
 
+    Input_new(DEFAULT_HOLD_TIMEOUT);
     while (work == TRUE)
     {
-        struct termios oldt, newt;
-        FD_SET(socket_donnees, &writeFd); // Client Socket
-        FD_SET(STDIN_FILENO, &writeFd);   // The terminal
+        fd_set readFd;
+        fd_set writeFd;
 
-        // Write stdin parameters to old
-        tcgetattr(STDIN_FILENO, &oldt);
-        newt = oldt;
-        newt.c_lflag &= ~(ICANON | ECHO); // Makes the flags of new compared to ICANON and ECHO
-
-        // Change the attributes immediately
-        tcsetattr(STDIN_FILENO, TCSANOW, &newt);
+        if (Clock_milliseconds() - lastRequest >= STATE_PERIOD)
+        {
+            ask4Log();
+        }
+        display();
 
-        if (select(FD_SETSIZE, &writeFd, NULL, NULL, NULL) == -1)
+        // Until the next request, the end of the period of the frame rate or the release of a key
+        const int frameDelay = Screen_flush();
+        const int holdDelay = Input_getTimeout();
+        long timeout = lastRequest + STATE_PERIOD - Clock_milliseconds();
+        if (frameDelay > 0 && frameDelay < timeout)
+        {
+            timeout = frameDelay;
+        }
+        if (holdDelay >= 0 && holdDelay < timeout)
+        {
+            timeout = holdDelay;
+        }
+        timeout = (timeout > 0) ? timeout : 0;
+        struct timeval delay = {timeout / 1000, (timeout % 1000) * 1000};
+
+        FD_ZERO(&readFd);
+        FD_ZERO(&writeFd);
+        FD_SET(socket_donnees, &readFd); // Client Socket
+        FD_SET(STDIN_FILENO, &readFd);   // The terminal
+        if (Client_hasPending() == TRUE)
+        {
+            FD_SET(socket_donnees, &writeFd); // The orders the socket could not take yet
+        }
+        const int ready = select(FD_SETSIZE, &readFd, &writeFd, NULL, &delay);
+        if (ready == -1)
         {
             break; // Error
         }
-        // We put back the old parameters
-        tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
+        Client_ping();
 
-        if (FD_ISSET(STDIN_FILENO, &writeFd))
+        // The keys waiting are read at once, the repeats of a held key are one press
+        const int eventCount = Input_poll(a_events, MAX_INPUT_EVENTS, (ready > 0 && FD_ISSET(STDIN_FILENO, &readFd)) ? TRUE : FALSE);
+        for (int i = 0; i < eventCount; i++)
         {
-            char charInput[2]; // Size 2 for the null character
-
-            if (read(STDIN_FILENO, charInput, sizeof(charInput)) < 0)
+            if (a_events[i].kind == IN_PRESS)
             {
-                printf("%sErreur lors de la lecture%s\n", "\033[41m", "\033[0m");
+                capturechoise(a_events[i].key);
             }
             else
             {
-                capturechoise(charInput[0]);
+                release(a_events[i].key);
             }
         }
-        else if (FD_ISSET(socket_donnees, &writeFd))
+        if (ready > 0 && FD_ISSET(socket_donnees, &writeFd))
+        {
+            Client_flush();
+        }
+        if (ready > 0 && FD_ISSET(socket_donnees, &readFd))
         {
-            const Data_s pilotState = Client_readMsg();
+            Data_s pilotState;
 
-            printf("\033[1A\033[K"); // Position the cursor 1 line above and delete it
-            printf("\nVitesse du robot : %d cm/s\n", pilotState.speed);
-            printf("Collision : %s\033[0m\n", pilotState.collision ? "\033[31mOui" : "\033[32mNon"); // Oui in red and Non in green
-            printf("Lumière : %d mV\n", pilotState.luminosity);
+            while (Client_readMsg(&pilotState) == TRUE)
+            {
+                if (pilotState.order == O_ASK_LOG)
+                {
+                    keep(&pilotState); // Only the states are displayed
+                }
+            }
+            if (Client_isConnected() == FALSE)
+            {
+                work = FALSE; // The server left
+            }
         }
     }
+
+    Input_free();
+}
+
+static void keep(const Data_s *state)
+{
+    lastState = *state;
+    hasState = TRUE;
+    if (historyCount == HISTORY_LENGTH)
+    {
+        memmove(a_speeds, a_speeds + 1, (HISTORY_LENGTH - 1) * sizeof(int));
+        memmove(a_luminosities, a_luminosities + 1, (HISTORY_LENGTH - 1) * sizeof(int));
+        historyCount--;
+    }
+    a_speeds[historyCount] = state->speed;
+    a_luminosities[historyCount] = state->luminosity;
+    historyCount++;
 }
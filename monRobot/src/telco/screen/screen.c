@@ -0,0 +1,283 @@
+/**
+ * @file screen.c
+ *
+ * @see screen.h
+ *
+ * The next frame is drawn into the back buffer, the front buffer holds what
+ * the terminal shows. A flush compares them cell by cell and sends only the
+ * differences, the cursor moves and color changes included, in one write():
+ * a frame where nothing changed costs nothing on a slow link.
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "../../common.h"
+#include "../../clock/clock.h"
+#include "screen.h"
+
+/**
+ * @brief Longest escape sequence written for a cell: cursor move and color
+ */
+#define MAX_ESCAPE (24)
+
+/**
+ * @brief A cell of the screen
+ */
+typedef struct
+{
+    char a_glyph[4]; // A character in UTF-8
+    uint8_t length;  // Bytes of the glyph, 0: unknown, drawn at the next flush
+    uint8_t color;   // ScreenColor_e
+} Cell_s;
+
+/**
+ * @brief Writes a character into a cell of the back buffer
+ *
+ * @param row Row
+ * @param column Column
+ * @param color Color
+ * @param p_glyph The character in UTF-8
+ * @param length Bytes of the character
+ */
+static void put(int row, int column, ScreenColor_e color, const char *p_glyph, int length);
+
+/**
+ * @brief Gives the length of a character in UTF-8 from its first byte
+ *
+ * @param first The first byte
+ * @return int Between 1 and 4
+ */
+static int glyphLength(unsigned char first);
+
+/**
+ * @brief Writes the whole buffer to the terminal
+ *
+ * @param p_buffer The bytes
+ * @param length Number of bytes
+ */
+static void writeAll(const char *p_buffer, size_t length);
+
+static const char *const a_colorCodes[SC_NB_COLOR] = {"\033[0m", "\033[31m", "\033[32m", "\033[33m", "\033[34m"};
+static const char *const a_bars[] = {"▁", "▂", "▃", "▄", "▅", "▆", "▇", "█"};
+static Cell_s *a_front = NULL;
+static Cell_s *a_back = NULL;
+static char *p_output = NULL;
+static int rowCount = 0;
+static int columnCount = 0;
+static int framePeriod = 1000 / DEFAULT_FPS; // ms
+static int64_t lastFrame = 0; // µs
+static bool_e cleared = FALSE; // The terminal was cleared once
+
+extern void Screen_new(int rows, int columns)
+{
+    rowCount = rows;
+    columnCount = columns;
+    a_front = (Cell_s *)calloc(rows * columns, sizeof(Cell_s));
+    a_back = (Cell_s *)calloc(rows * columns, sizeof(Cell_s));
+    p_output = (char *)malloc((size_t)rows * columns * (MAX_ESCAPE + 4) + MAX_ESCAPE);
+    if (a_front == NULL || a_back == NULL || p_output == NULL)
+    {
+        perror("Erreur lors de la création de l'écran");
+        exit(EXIT_FAILURE);
+    }
+    cleared = FALSE;
+    lastFrame = Clock_monotonic() - framePeriod * 1000L;
+    Screen_clear();
+}
+
+extern void Screen_free()
+{
+    char a_end[MAX_ESCAPE];
+    const int length = snprintf(a_end, sizeof(a_end), "\033[0m\033[%d;1H", rowCount + 1);
+
+    writeAll(a_end, length);
+    free(a_front);
+    free(a_back);
+    free(p_output);
+    a_front = NULL;
+    a_back = NULL;
+    p_output = NULL;
+}
+
+extern void Screen_setFps(int fps)
+{
+    framePeriod = 1000 / ((fps > 0) ? fps : DEFAULT_FPS);
+}
+
+extern void Screen_clear()
+{
+    for (int row = 0; row < rowCount; row++)
+    {
+        for (int column = 0; column < columnCount; column++)
+        {
+            put(row, column, SC_DEFAULT, " ", 1);
+        }
+    }
+}
+
+extern void Screen_invalidate()
+{
+    memset(a_front, 0, rowCount * columnCount * sizeof(Cell_s));
+    cleared = FALSE;
+}
+
+extern int Screen_print(int row, int column, ScreenColor_e color, const char *format, ...)
+{
+    char a_text[512];
+    va_list arguments;
+    int written = 0;
+
+    va_start(arguments, format);
+    vsnprintf(a_text, sizeof(a_text), format, arguments);
+    va_end(arguments);
+
+    for (const char *p_char = a_text; *p_char != '\0' && column + written < columnCount;)
+    {
+        const int length = glyphLength((unsigned char)*p_char);
+
+        if ((int)strnlen(p_char, length) < length)
+        {
+            break; // Character cut by the buffer
+        }
+        put(row, column + written, color, p_char, length);
+        p_char += length;
+        written++;
+    }
+    return written;
+}
+
+extern void Screen_sparkline(int row, int column, ScreenColor_e color, const int a_values[], int count, int min, int max)
+{
+    const int levels = sizeof(a_bars) / sizeof(a_bars[0]);
+    const int range = (max > min) ? max - min : 1;
+
+    for (int i = 0; i < count; i++)
+    {
+        int level = (a_values[i] - min) * (levels - 1) / range;
+
+        level = (level < 0) ? 0 : (level >= levels) ? levels - 1 : level;
+        put(row, column + i, color, a_bars[level], strlen(a_bars[level]));
+    }
+}
+
+extern int Screen_flush()
+{
+    const int64_t time = Clock_monotonic();
+    ScreenColor_e color = SC_NB_COLOR; // Unknown on the terminal
+    int cursorRow = -1;
+    int cursorColumn = -1;
+    size_t length = 0;
+
+    if (time - lastFrame < framePeriod * 1000L)
+    {
+        // Waits for the end of the period only if there is something to draw
+        if (memcmp(a_front, a_back, rowCount * columnCount * sizeof(Cell_s)) == 0)
+        {
+            return 0;
+        }
+        return (int)((lastFrame + framePeriod * 1000L - time + 999) / 1000);
+    }
+
+    if (cleared == FALSE)
+    {
+        length += sprintf(p_output + length, "\033[H\033[2J");
+        cleared = TRUE;
+    }
+    for (int row = 0; row < rowCount; row++)
+    {
+        for (int column = 0; column < columnCount; column++)
+        {
+            Cell_s *p_front = &a_front[row * columnCount + column];
+            const Cell_s *p_back = &a_back[row * columnCount + column];
+
+            if (memcmp(p_front, p_back, sizeof(Cell_s)) == 0)
+            {
+                continue;
+            }
+            if (row != cursorRow || column != cursorColumn)
+            {
+                length += sprintf(p_output + length, "\033[%d;%dH", row + 1, column + 1);
+            }
+            if (p_back->color != color)
+            {
+                color = p_back->color;
+                length += sprintf(p_output + length, "%s", a_colorCodes[color]);
+            }
+            memcpy(p_output + length, p_back->a_glyph, p_back->length);
+            length += p_back->length;
+            *p_front = *p_back;
+            cursorRow = row;
+            cursorColumn = column + 1;
+        }
+    }
+    if (length == 0)
+    {
+        return 0; // Nothing changed, the period is not used
+    }
+    if (color != SC_DEFAULT)
+    {
+        length += sprintf(p_output + length, "%s", a_colorCodes[SC_DEFAULT]);
+    }
+    length += sprintf(p_output + length, "\033[%d;1H", rowCount + 1); // Out of the drawing
+    writeAll(p_output, length);
+    lastFrame = time;
+    return 0;
+}
+
+static void put(int row, int column, ScreenColor_e color, const char *p_glyph, int length)
+{
+    Cell_s *p_cell;
+
+    if (row < 0 || row >= rowCount || column < 0 || column >= columnCount)
+    {
+        return;
+    }
+    p_cell = &a_back[row * columnCount + column];
+    memset(p_cell->a_glyph, 0, sizeof(p_cell->a_glyph)); // The cells are compared whole
+    memcpy(p_cell->a_glyph, p_glyph, length);
+    p_cell->length = length;
+    p_cell->color = color;
+}
+
+static int glyphLength(unsigned char first)
+{
+    if (first >= 0xF0)
+    {
+        return 4;
+    }
+    if (first >= 0xE0)
+    {
+        return 3;
+    }
+    if (first >= 0xC0)
+    {
+        return 2;
+    }
+    return 1;
+}
+
+static void writeAll(const char *p_buffer, size_t length)
+{
+    while (length > 0)
+    {
+        const ssize_t written = write(STDOUT_FILENO, p_buffer, length);
+
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return; // The terminal is gone
+        }
+        p_buffer += written;
+        length -= written;
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * @file  screen.h
+ *
+ * @brief  Terminal renderer drawing only the cells changed since the last frame
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _SCREEN_
+#define _SCREEN_
+
+#include "../../common.h"
+
+/**
+ * @brief Frames per second by default
+ */
+#define DEFAULT_FPS (30)
+
+typedef enum
+{
+    SC_DEFAULT = 0,
+    SC_RED,
+    SC_GREEN,
+    SC_YELLOW,
+    SC_BLUE,
+    SC_NB_COLOR
+} ScreenColor_e;
+
+/**
+ * @brief Creates the two buffers of the screen, the terminal is cleared by the first frame
+ *
+ * @param rows Number of rows drawn, from the top of the terminal
+ * @param columns Number of columns
+ */
+extern void Screen_new(int rows, int columns);
+
+/**
+ * @brief Frees the buffers and puts the cursor below the drawing
+ */
+extern void Screen_free();
+
+/**
+ * @brief Limits the frames per second, to be called before Screen_new()
+ *
+ * @param fps Frames per second, DEFAULT_FPS if not positive
+ */
+extern void Screen_setFps(int fps);
+
+/**
+ * @brief Fills the next frame with spaces
+ */
+extern void Screen_clear();
+
+/**
+ * @brief Draws the whole frame again at the next flush (after a change of the terminal)
+ */
+extern void Screen_invalidate();
+
+/**
+ * @brief Writes text in the next frame, cut at the right edge
+ *
+ * @param row Row, 0 at the top
+ * @param column Column, 0 on the left
+ * @param color Color of the text
+ * @param format Format of printf(), UTF-8, one cell per character
+ * @return int Number of cells written
+ */
+extern int Screen_print(int row, int column, ScreenColor_e color, const char *format, ...) __attribute__((format(printf, 4, 5)));
+
+/**
+ * @brief Draws the values as a line of bars, one cell per value
+ *
+ * @param row Row, 0 at the top
+ * @param column Column of the first value
+ * @param color Color of the bars
+ * @param a_values The values, from the oldest
+ * @param count Number of values
+ * @param min Value of the lowest bar
+ * @param max Value of the highest bar
+ */
+extern void Screen_sparkline(int row, int column, ScreenColor_e color, const int a_values[], int count, int min, int max);
+
+/**
+ * @brief Writes the cells changed since the last frame, with a single write()
+ *
+ * Nothing is written before the end of the period of the frame rate.
+ *
+ * @return int 0 if the terminal is up to date, otherwise the time before the frame can be drawn (ms)
+ */
+extern int Screen_flush();
+
+#endif // _SCREEN_
@@ -0,0 +1,325 @@
+/**
+ * @file script.c
+ *
+ * @see script.h
+ *
+ * @author Thorkel-dev
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/select.h>
+
+#include "../../common.h"
+#include "../client/client.h"
+#include "../../clock/clock.h"
+#include "../../grammar/grammar.h"
+#include "script.h"
+
+/**
+ * @brief Maximum length of a line of the script
+ */
+#define MAX_LINE (256)
+
+/**
+ * @brief Time to wait for the last answers once the script is over (ms)
+ */
+#define REPLY_TIMEOUT (2000)
+
+/**
+ * @brief Reads the next complete line of the script, without blocking
+ *
+ * @param line Where to copy the line (MAX_LINE bytes)
+ * @return TRUE if a line was read, FALSE if more bytes are needed or the script is over
+ */
+static bool_e nextLine(char *line);
+
+/**
+ * @brief Executes a line of the script
+ *
+ * @param line The line
+ */
+static void execute(char *line);
+
+/**
+ * @brief Reads the answers of the server and prints them
+ */
+static void readState();
+
+/**
+ * @brief Prints an answer of the server
+ *
+ * @param p_state The answer
+ */
+static void printState(const Data_s *p_state);
+
+/**
+ * @brief Gives the time elapsed since the start of the script
+ *
+ * @return long Time in milliseconds
+ */
+static long elapsed();
+
+static int scriptFd = -1;
+static int socket_donnees;
+static char a_buffer[MAX_LINE];
+static size_t buffered = 0;
+static bool_e endOfScript = FALSE;
+static bool_e work;
+static bool_e fullSpeed;
+static long nextCommandTime = 0; // Time of the next command (ms)
+static long lastOrderTime = 0;   // Time of the last order sent (ms)
+static int pendingReplies = 0;
+static unsigned long unanswered = 0; // Requests shed by commando, already taken off pendingReplies
+static int64_t startTime; // µs
+
+extern void Script_new(const char *path)
+{
+    scriptFd = (strcmp(path, "-") == 0) ? STDIN_FILENO : open(path, O_RDONLY);
+    if (scriptFd < 0)
+    {
+        fprintf(stderr, "Impossible d'ouvrir le script %s : %s\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    Client_setQuiet(TRUE); // The standard output only carries the states
+    Client_new();
+}
+
+extern void Script_start(bool_e isFullSpeed)
+{
+    char line[MAX_LINE];
+    fd_set readFd;
+    fd_set writeFd;
+
+    socket_donnees = *Client_start();
+    if (Client_isConnected() == FALSE)
+    {
+        fprintf(stderr, "Serveur injoignable\n");
+        return;
+    }
+    fullSpeed = isFullSpeed;
+    work = TRUE;
+    startTime = Clock_monotonic();
+
+    while (work == TRUE)
+    {
+        // The commands whose time has come, as long as the window has room for them
+        while (work == TRUE && elapsed() >= nextCommandTime && Client_canSend() == TRUE && nextLine(line))
+        {
+            execute(line);
+        }
+        if (work == FALSE || (endOfScript == TRUE && (pendingReplies == 0 || elapsed() >= lastOrderTime + REPLY_TIMEOUT)))
+        {
+            break;
+        }
+
+        FD_ZERO(&readFd);
+        FD_SET(socket_donnees, &readFd);
+        long timeout = (endOfScript ? lastOrderTime + REPLY_TIMEOUT : nextCommandTime) - elapsed();
+        if (endOfScript == FALSE && timeout <= 0)
+        {
+            if (Client_canSend() == TRUE)
+            {
+                FD_SET(scriptFd, &readFd); // Only needed when a command is due
+            }
+            timeout = REPLY_TIMEOUT; // Or until an acknowledgement makes room
+        }
+        struct timeval delay = {timeout / 1000, (timeout % 1000) * 1000};
+
+        FD_ZERO(&writeFd);
+        if (Client_hasPending() == TRUE)
+        {
+            FD_SET(socket_donnees, &writeFd); // The orders the socket could not take yet
+        }
+        if (select(FD_SETSIZE, &readFd, &writeFd, NULL, &delay) < 0 && errno != EINTR)
+        {
+            break;
+        }
+        if (FD_ISSET(socket_donnees, &writeFd))
+        {
+            Client_flush();
+        }
+        if (FD_ISSET(socket_donnees, &readFd))
+        {
+            readState();
+        }
+        Client_ping();
+    }
+    const AckStats_s *p_acks = Client_getAckStats();
+    if (p_acks->acknowledged > 0)
+    {
+        printf("acks %lu %lu %lu %.0f %d\n", p_acks->acknowledged, p_acks->unanswered, p_acks->expired, p_acks->meanLatency, p_acks->maxLatency);
+    }
+    printf("done %ld %d\n", elapsed(), pendingReplies);
+    fflush(stdout);
+}
+
+extern void Script_stop()
+{
+    if (scriptFd > STDIN_FILENO)
+    {
+        close(scriptFd);
+    }
+    scriptFd = -1;
+    Client_stop();
+}
+
+static bool_e nextLine(char *line)
+{
+    for (;;)
+    {
+        char *p_end = memchr(a_buffer, '\n', buffered);
+
+        if (p_end != NULL || (endOfScript == TRUE && buffered > 0) || buffered == sizeof(a_buffer))
+        {
+            // A complete line, the last one without '\n', or a line too long (cut)
+            const size_t length = (p_end != NULL) ? (size_t)(p_end - a_buffer) : buffered - (buffered == sizeof(a_buffer));
+            const size_t consumed = (p_end != NULL) ? length + 1 : length;
+
+            memcpy(line, a_buffer, length);
+            line[length] = '\0';
+            memmove(a_buffer, a_buffer + consumed, buffered - consumed);
+            buffered -= consumed;
+            return TRUE;
+        }
+        if (endOfScript == TRUE)
+        {
+            return FALSE;
+        }
+
+        // Only reads what is already there, a stream may be slower than the robot
+        fd_set readFd;
+        struct timeval noWait = {0, 0};
+        FD_ZERO(&readFd);
+        FD_SET(scriptFd, &readFd);
+        if (select(scriptFd + 1, &readFd, NULL, NULL, &noWait) <= 0)
+        {
+            return FALSE;
+        }
+
+        const ssize_t quantityReaddean = read(scriptFd, a_buffer + buffered, sizeof(a_buffer) - buffered);
+        if (quantityReaddean <= 0)
+        {
+            endOfScript = TRUE;
+        }
+        else
+        {
+            buffered += quantityReaddean;
+        }
+    }
+}
+
+static void execute(char *line)
+{
+    Statement_s statement;
+
+    Grammar_parse(line, &statement);
+    if (statement.kind == ST_WAIT && fullSpeed == FALSE)
+    {
+        // From the planned time, the delays of the loop do not add up
+        nextCommandTime = ((nextCommandTime > elapsed()) ? nextCommandTime : elapsed()) + statement.wait;
+    }
+    else if (statement.kind == ST_ORDER || statement.kind == ST_QUIT)
+    {
+        const Data_s data = {statement.order, statement.direction, 0, 0, 0, 0};
+
+        if (Client_sendPayload(data, statement.a_payload, statement.size) != 0 && statement.answered == TRUE)
+        {
+            pendingReplies++; // The answer, or the final status
+        }
+        lastOrderTime = elapsed();
+    }
+    else if (statement.kind == ST_OTHER)
+    {
+        Grammar_reject(statement.p_command);
+    }
+    if (statement.kind == ST_QUIT)
+    {
+        endOfScript = TRUE; // The last answers are still awaited
+        buffered = 0;
+    }
+}
+
+static void readState()
+{
+    Data_s pilotState;
+
+    while (Client_readMsg(&pilotState) == TRUE)
+    {
+        printState(&pilotState);
+    }
+    if (Client_isConnected() == FALSE)
+    {
+        fprintf(stderr, "Connexion fermée par le serveur\n");
+        work = FALSE;
+    }
+}
+
+static void printState(const Data_s *p_state)
+{
+    int size;
+    const int32_t *p_words = (const int32_t *)Client_getPayload(&size);
+    const bool_e answer = (p_state->order == O_MISSION || p_state->order == O_GOTO || p_state->order == O_POSE ||
+                           p_state->order == O_MAP || p_state->order == O_HISTORY || p_state->order == O_PROFILE)
+                              ? TRUE
+                              : FALSE;
+    bool_e running = FALSE;
+
+    // An acknowledged request without answer was shed, it is no longer awaited
+    while (unanswered < Client_getAckStats()->unanswered)
+    {
+        unanswered++;
+        if (pendingReplies > 0)
+        {
+            pendingReplies--;
+        }
+    }
+    if (p_state->order == O_PING || p_state->order == O_ACK)
+    {
+        return; // Handled by the client
+    }
+    if (p_state->order == O_MISSION)
+    {
+        if (size != sizeof(MissionProgress_s))
+        {
+            return;
+        }
+        running = (((const MissionProgress_s *)p_words)->status == M_RUNNING) ? TRUE : FALSE;
+    }
+    else if (p_state->order == O_GOTO)
+    {
+        if (size != sizeof(NavigationProgress_s))
+        {
+            return;
+        }
+        running = (((const NavigationProgress_s *)p_words)->status == M_RUNNING) ? TRUE : FALSE;
+    }
+
+    if (running == TRUE)
+    {
+        lastOrderTime = elapsed(); // The mission or the way still goes on, keep waiting for its end
+    }
+    else if (pendingReplies > 0)
+    {
+        pendingReplies--;
+    }
+    if (answer == TRUE)
+    {
+        Grammar_printAnswer(elapsed(), p_state, p_words);
+    }
+    else
+    {
+        Grammar_printState(elapsed(), p_state); // The other frames carry a state
+    }
+    fflush(stdout);
+}
+
+static long elapsed()
+{
+    return (long)((Clock_monotonic() - startTime) / 1000);
+}
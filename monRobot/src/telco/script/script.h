@@ -0,0 +1,92 @@
+/**
+ * @file  script.h
+ *
+ * @brief  Headless mode of telco, drives the robot from a command script
+ *
+ * @author Thorkel-dev
+ * @date 19-10-2026
+ * @version version 1
+ * @section License
+ *
+ *
+ * The MIT License
+ *
+ * Copyright (c) 2022, Thorkel-dev
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ */
+
+#ifndef _SCRIPT_
+#define _SCRIPT_
+
+#include "../../common.h"
+
+/**
+ * @brief Opens the script and initializes the client
+ *
+ * One command per line, '#' starts a comment:
+ *  - forward, backward, left, right, stop : changes the movement
+ *  - wait <ms> : waits before the next command
+ *  - status : asks for the state of the robot
+ *  - twist <linear> <angular>, wheels <left> <right> : continuous setpoint (%)
+ *  - behaviour manual|avoid|light [power] : the robot drives on its own
+ *  - goto <x mm> <y mm> [power] : the server plans the way and drives to the goal
+ *  - history <count> [from ms] [to ms] : asks for the last states kept by the server
+ *  - pose : asks for the estimated pose of the robot
+ *  - profile : asks for the processor counters of commando (started with -P)
+ *  - map <column> <row> <width> <height> : asks for a region of the map
+ *  - step <direction> <power> <ms> : adds a step to the next mission
+ *  - mission : uploads the steps written since the last mission, run by the server
+ *  - abort : aborts the mission in progress
+ *  - quit : stops the robot and the server
+ *
+ * @param path Path of the script, "-" for the standard input
+ */
+extern void Script_new(const char *path);
+
+/**
+ * @brief Runs the script, then waits for the last answers of the server
+ *
+ * Each state received is printed on one line of the standard output:
+ * "state <ms since start> <speed> <collision> <luminosity>".
+ * Each progress of a mission is printed the same way:
+ * "mission <ms since start> <step> <number of steps> <MissionStatus_e>".
+ * Each progress towards a goal is printed as
+ * "goto <ms> <MissionStatus_e> <waypoint> <number of waypoints> <planning µs> <new plans>".
+ * The pose is "pose <ms> <x mm> <y mm> <heading mrad>", a region of the map
+ * "map <ms> <column> <row> <width> <height> <cells>" with one character
+ * per cell, row by row: '?' unknown, '.' free, '#' occupied.
+ * The history is "history <ms> <server ms> <count>" followed by one line
+ * "sample <server ms> <speed> <collision> <luminosity>" per state, oldest first.
+ * The counters are "profile <ms> <count>" followed by one line
+ * "region <ProfileRegion_e> <passes> <ns> <cycles> <instructions> <cache misses> <branch misses>"
+ * per section, means per pass, count 0 if commando does not count.
+ * The last line is "done <ms since start> <answers not received>".
+ *
+ * @param fullSpeed TRUE to ignore the waits (open loop at full speed)
+ */
+extern void Script_start(bool_e fullSpeed);
+
+/**
+ * @brief Closes the script and the client
+ */
+extern void Script_stop();
+
+#endif // _SCRIPT_
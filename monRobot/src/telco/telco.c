@@ -1,17 +1,119 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <unistd.h>
 
 #include "../common.h"
 #include "client/client.h"
 #include "remoteUI/remoteUI.h"
+#include "script/script.h"
+#include "recorder/recorder.h"
+#include "dashboard/dashboard.h"
+#include "bench/bench.h"
+#include "screen/screen.h"
+
+/**
+ * @brief Displays the options of telco
+ *
+ * @param program Name of the program
+ */
+static void usage(const char *program);
 
 int main(int argc, char *argv[])
 {
+    const char *p_script = NULL;
+    const char *p_record = NULL;
+    const char *a_servers[MAX_SERVERS];
+    int serverCount = 0;
+    int benchCount = 0;
+    bool_e fullSpeed = FALSE;
+    int option;
+
+    while ((option = getopt(argc, argv, "s:r:m:w:F:b:fh")) != -1)
+    {
+        switch (option)
+        {
+        case 's':
+            p_script = optarg;
+            break;
+        case 'r':
+            p_record = optarg;
+            break;
+        case 'm':
+            if (serverCount < MAX_SERVERS)
+            {
+                a_servers[serverCount++] = optarg;
+            }
+            break;
+        case 'f':
+            fullSpeed = TRUE;
+            break;
+        case 'F':
+            Screen_setFps(atoi(optarg));
+            break;
+        case 'w':
+            Client_setWindow(atoi(optarg));
+            break;
+        case 'b':
+            benchCount = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return (option == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    if (p_script != NULL)
+    {
+        // Headless, no terminal needed
+        Script_new(p_script);
+        Script_start(fullSpeed);
+        Script_stop();
+        return EXIT_SUCCESS;
+    }
+
+    if (benchCount > 0)
+    {
+        Bench_new(benchCount);
+        Bench_start();
+        Bench_stop();
+        return EXIT_SUCCESS;
+    }
+
+    if (p_record != NULL)
+    {
+        Recorder_new(p_record);
+        Recorder_start();
+        Recorder_stop();
+        return EXIT_SUCCESS;
+    }
+
     printf("\033c");
+    if (serverCount > 0)
+    {
+        Dashboard_new(a_servers, serverCount);
+        Dashboard_start();
+        Dashboard_stop();
+        return EXIT_SUCCESS;
+    }
+
     RemoteUI_new();
     RemoteUI_start();
     RemoteUI_stop();
 
     return EXIT_SUCCESS;
 }
+
+static void usage(const char *program)
+{
+    printf("Usage : %s [options]\n", program);
+    printf("  -s <script>  : mode sans terminal, exécute le script (- : entrée standard)\n");
+    printf("  -f           : avec -s, ignore les attentes du script (pleine vitesse)\n");
+    printf("  -r <fichier> : enregistre la télémétrie dans le fichier (pour logbook), jusqu'à Ctrl-C\n");
+    printf("  -m <hôte[:port][@x,y[,cap]]> : tableau de bord de plusieurs robots, une option par robot (%d au plus),\n", MAX_SERVERS);
+    printf("                 avec la position de départ commune à la flotte (mm, degrés) qui les empêche de se heurter\n");
+    printf("  -F <n>       : images par seconde au plus de l'affichage (%d par défaut)\n", DEFAULT_FPS);
+    printf("  -w <n>       : ordres en vol sans acquittement, de 1 à %d (8 par défaut)\n", MAX_WINDOW);
+    printf("  -b <n>       : charge le serveur avec n connexions qui demandent l'état, puis affiche le débit et les latences\n");
+    printf("  -h           : affiche cette aide\n");
+}